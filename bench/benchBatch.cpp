@@ -0,0 +1,50 @@
+#include <numeric>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "batch.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+// Sums the bytes of a 32 byte input
+constexpr auto sumProgram = std::to_array<uint8_t>({
+    0xa2, 0x00,       // LDX #$00
+    0xa9, 0x00,       // LDA #$00
+    0x18,             // loop: CLC
+    0x7d, 0x00, 0x02, // ADC $0200,X
+    0xe8,             // INX
+    0xe0, 0x20,       // CPX #$20
+    0xd0, 0xf7,       // BNE loop
+    0x8d, 0x00, 0x03, // STA $0300
+    0x02,             // Halt
+});
+
+constexpr auto vectorCount = 4096U;
+constexpr auto vectorLength = uint16_t{32};
+
+void batch(benchmark::State &state) {
+	const auto batch = emu::Batch(sumProgram, 0x600, {0x200, vectorLength},
+				      {0x300, 1}, 10000);
+
+	std::vector<std::vector<uint8_t>> vectors(vectorCount);
+	for (size_t i = 0; i < vectors.size(); i++) {
+		vectors[i].resize(vectorLength);
+		std::iota(vectors[i].begin(), vectors[i].end(), i);
+	}
+	const std::vector<std::span<const uint8_t>> inputs(vectors.begin(),
+							   vectors.end());
+
+	const auto threads = static_cast<unsigned>(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(batch.run(inputs, threads));
+
+	state.counters["vectors"] = benchmark::Counter(
+	    static_cast<double>(state.iterations() * vectorCount),
+	    benchmark::Counter::kIsRate);
+}
+BENCHMARK(batch)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,46 @@
+#include <benchmark/benchmark.h>
+
+#include "cpu.hpp"
+#include "nestest.hpp"
+#include "taint.hpp"
+
+namespace {
+
+auto nestestCPU() -> emu::CPU {
+	auto cpu = emu::CPU();
+	cpu.loadProgram(nestestProgram, 0x8000);
+	cpu.loadProgram(nestestProgram, 0xC000);
+	return cpu;
+}
+
+template <class... Taint>
+void runNestest(benchmark::State &state, Taint &...taint) {
+	const auto initial = nestestCPU();
+	auto cpu = initial;
+	uint64_t instructions = 0;
+
+	for (auto _ : state) {
+		cpu = initial;
+		for (size_t i = 1; i < nestestStates.size(); i++) {
+			if (!cpu.step(taint...))
+				break;
+			instructions++;
+		}
+		benchmark::DoNotOptimize(cpu.accumulator);
+	}
+
+	state.counters["instructions"] = benchmark::Counter(
+	    static_cast<double>(instructions), benchmark::Counter::kIsRate);
+}
+
+void step(benchmark::State &state) { runNestest(state); }
+BENCHMARK(step);
+
+void stepTainted(benchmark::State &state) {
+	auto taint = emu::TaintState();
+	taint.memory.fill(1);
+	runNestest(state, taint);
+}
+BENCHMARK(stepTainted);
+
+} // namespace
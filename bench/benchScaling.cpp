@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "workloads.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Cycles each instance runs for in each iteration
+constexpr auto sliceCycles = uint64_t{50'000};
+
+// Run cpu for about cycles, restarting it from initial whenever its workload
+// stops. Returns the cycles run
+auto runSlice(emu::CPU &cpu, const emu::CPU &initial, uint64_t cycles)
+    -> uint64_t {
+	auto total = uint64_t{0};
+	while (total < cycles) {
+		const auto start = cpu.cycle;
+		const auto finished = !cpu.run(start + cycles - total);
+		total += cpu.cycle - start;
+		if (finished)
+			cpu = initial;
+	}
+
+	return total;
+}
+
+auto seconds(Clock::duration duration) -> double {
+	return std::chrono::duration<double>(duration).count();
+}
+
+// Runs independent CPUs, each with one of the workloads, on a number of
+// threads. The CPUs are either allocated together by one thread, or
+// separately by the thread which runs them, to expose false sharing and
+// allocator contention.
+// Reports the aggregate emulated clock rate, the memory taken by each CPU,
+// and the scaling efficiency: the aggregate rate over the rate of the same
+// CPUs run by one thread, times the number of threads
+void scaling(benchmark::State &state) {
+	const auto instances = static_cast<size_t>(state.range(0));
+	const auto threads = static_cast<size_t>(state.range(1));
+	const auto allocatePerThread = state.range(2) != 0;
+	state.SetLabel(allocatePerThread ? "per thread" : "contiguous");
+
+	std::vector<emu::CPU> initials(workloads.size());
+	for (size_t i = 0; i < workloads.size(); i++)
+		initials[i].loadProgram(workloads.at(i).program);
+	const auto initial = [&](size_t instance) -> const emu::CPU & {
+		return initials[instance % initials.size()];
+	};
+
+	std::vector<emu::CPU> contiguous;
+	std::vector<std::unique_ptr<emu::CPU>> separate(instances);
+	std::vector<emu::CPU *> cpus(instances);
+	if (!allocatePerThread) {
+		contiguous.reserve(instances);
+		for (size_t i = 0; i < instances; i++)
+			cpus[i] = &contiguous.emplace_back(initial(i));
+	}
+
+	// Each thread runs every threads-th CPU, in step with the others
+	std::barrier sync{static_cast<std::ptrdiff_t>(threads + 1)};
+	std::atomic<uint64_t> cycles{0};
+	bool done = false;
+	const auto work = [&](size_t thread) {
+		for (auto i = thread; i < instances; i += threads) {
+			if (allocatePerThread) {
+				separate[i] = std::make_unique<emu::CPU>(
+				    initial(i));
+				cpus[i] = separate[i].get();
+			}
+		}
+		sync.arrive_and_wait();
+
+		while (true) {
+			sync.arrive_and_wait();
+			if (done)
+				break;
+
+			auto ran = uint64_t{0};
+			for (auto i = thread; i < instances; i += threads)
+				ran += runSlice(*cpus[i], initial(i),
+						sliceCycles);
+			cycles += ran;
+			sync.arrive_and_wait();
+		}
+	};
+
+	std::vector<std::jthread> workers;
+	for (size_t thread = 0; thread < threads; thread++)
+		workers.emplace_back(work, thread);
+	sync.arrive_and_wait();
+
+	// One thread running every CPU, which also warms them up
+	const auto baselineStart = Clock::now();
+	auto baselineCycles = uint64_t{0};
+	for (size_t i = 0; i < instances; i++)
+		baselineCycles += runSlice(*cpus[i], initial(i), sliceCycles);
+	const auto baselineRate =
+	    static_cast<double>(baselineCycles) /
+	    seconds(Clock::now() - baselineStart);
+
+	const auto start = Clock::now();
+	for (auto _ : state) {
+		sync.arrive_and_wait();
+		sync.arrive_and_wait();
+	}
+	const auto elapsed = seconds(Clock::now() - start);
+
+	done = true;
+	sync.arrive_and_wait();
+	workers.clear();
+
+	const auto total = static_cast<double>(cycles.load());
+	state.counters["cycles"] =
+	    benchmark::Counter(total, benchmark::Counter::kIsRate);
+	state.counters["bytesPerInstance"] = benchmark::Counter(
+	    sizeof(emu::CPU), benchmark::Counter::kDefaults,
+	    benchmark::Counter::kIs1024);
+	state.counters["efficiency"] =
+	    total / elapsed / (baselineRate * static_cast<double>(threads));
+}
+
+// Up to as many threads as CPUs
+void scalingArguments(benchmark::internal::Benchmark *benchmark) {
+	for (const auto instances : {1, 4, 16, 64}) {
+		for (const auto threads : {1, 2, 4, 8}) {
+			if (threads > instances)
+				continue;
+
+			for (const auto allocatePerThread : {0, 1})
+				benchmark->Args(
+				    {instances, threads, allocatePerThread});
+		}
+	}
+}
+BENCHMARK(scaling)->Apply(scalingArguments)->UseRealTime();
+
+} // namespace
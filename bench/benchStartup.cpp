@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "workloads.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const auto &program = workloads.front().program;
+
+// Latency of each iteration as timed by measure, which returns the time
+// taken by the part of the iteration being measured. Reports percentiles in
+// nanoseconds
+template <class Measure>
+void latency(benchmark::State &state, Measure measure) {
+	std::vector<double> samples;
+	for (auto _ : state) {
+		const auto taken = measure(state);
+		samples.push_back(
+		    std::chrono::duration<double, std::nano>(taken).count());
+	}
+
+	std::sort(samples.begin(), samples.end());
+	const auto percentile = [&](double fraction) {
+		const auto last = static_cast<double>(samples.size() - 1);
+		return samples.at(static_cast<size_t>(fraction * last));
+	};
+	state.counters["p50"] = percentile(0.5);
+	state.counters["p90"] = percentile(0.9);
+	state.counters["p99"] = percentile(0.99);
+	state.counters["p999"] = percentile(0.999);
+	state.counters["max"] = samples.back();
+}
+
+// Construct a CPU and load the program, up to its first instruction
+void startRaw(benchmark::State &state) {
+	latency(state, [](auto &) {
+		const auto start = Clock::now();
+		auto cpu = std::make_unique<emu::CPU>();
+		cpu->loadProgram(program);
+		benchmark::DoNotOptimize(cpu->step());
+		const auto taken = Clock::now() - start;
+
+		benchmark::DoNotOptimize(cpu.get());
+		return taken;
+	});
+}
+BENCHMARK(startRaw);
+
+// Construct a CPU by copying a snapshot taken after loading the program
+void startSnapshot(benchmark::State &state) {
+	auto snapshot = emu::CPU{};
+	snapshot.loadProgram(program);
+
+	latency(state, [&](auto &) {
+		const auto start = Clock::now();
+		auto cpu = std::make_unique<emu::CPU>(snapshot);
+		benchmark::DoNotOptimize(cpu->step());
+		const auto taken = Clock::now() - start;
+
+		benchmark::DoNotOptimize(cpu.get());
+		return taken;
+	});
+}
+BENCHMARK(startSnapshot);
+
+// Restore a CPU which has already been allocated from a template shared by
+// every instance, as a pool of CPUs would
+void startTemplate(benchmark::State &state) {
+	auto shared = emu::CPU{};
+	shared.loadProgram(program);
+	auto cpu = std::make_unique<emu::CPU>();
+
+	latency(state, [&](auto &) {
+		const auto start = Clock::now();
+		*cpu = shared;
+		benchmark::DoNotOptimize(cpu->step());
+		return Clock::now() - start;
+	});
+}
+BENCHMARK(startTemplate);
+
+void reset(benchmark::State &state) {
+	auto cpu = emu::CPU{};
+	cpu.loadProgram(program);
+
+	latency(state, [&](auto &) {
+		const auto start = Clock::now();
+		cpu.reset();
+		const auto taken = Clock::now() - start;
+
+		benchmark::DoNotOptimize(cpu.memory.data());
+		return taken;
+	});
+}
+BENCHMARK(reset);
+
+// Destroy a CPU which has run, so its memory has been touched
+void destroy(benchmark::State &state) {
+	latency(state, [](auto &state) {
+		state.PauseTiming();
+		auto cpu = std::make_unique<emu::CPU>();
+		cpu->loadProgram(program);
+		benchmark::DoNotOptimize(cpu->step());
+		state.ResumeTiming();
+
+		const auto start = Clock::now();
+		cpu.reset();
+		return Clock::now() - start;
+	});
+}
+BENCHMARK(destroy);
+
+} // namespace
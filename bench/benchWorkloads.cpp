@@ -0,0 +1,41 @@
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "tiered.hpp"
+#include "workloads.hpp"
+
+namespace {
+
+// Runs a workload to the end, by the interpreter or by a TieredEngine
+void workload(benchmark::State &state) {
+	const auto index = static_cast<size_t>(state.range(0));
+	const auto &workload = workloads.at(index);
+	const auto tiered = state.range(1) != 0;
+	state.SetLabel(std::string{workload.name} +
+		       (tiered ? " tiered" : " interpreted"));
+
+	for (auto _ : state) {
+		auto cpu = emu::CPU{};
+		cpu.loadProgram(workload.program);
+		if (tiered) {
+			auto engine = emu::TieredEngine{cpu};
+			const auto stopped = !engine.run(workload.cycles + 1);
+			benchmark::DoNotOptimize(stopped);
+		} else {
+			benchmark::DoNotOptimize(cpu.run(workload.cycles + 1));
+		}
+
+		if (cpu.cycle != workload.cycles)
+			state.SkipWithError("Workload stopped unexpectedly");
+	}
+
+	state.counters["cycles"] = benchmark::Counter(
+	    static_cast<double>(state.iterations() * workload.cycles),
+	    benchmark::Counter::kIsRate);
+}
+BENCHMARK(workload)
+    ->ArgsProduct({benchmark::CreateDenseRange(0, workloads.size() - 1, 1),
+		   {0, 1}});
+
+} // namespace
@@ -0,0 +1,376 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "microlator.h"
+
+// Python module wrapping the C API. Memory is exposed through the buffer
+// protocol, so memoryview(cpu) and numpy.asarray(cpu.memory) alias the
+// CPU's memory without copying it. Runs release the GIL, so CPUs can run in
+// parallel on Python threads. Using a CPU from another thread while it runs
+// raises RuntimeError, other than through its memory, which is only aliased
+
+namespace {
+
+struct CPUObject {
+	PyObject_HEAD
+	microlator_cpu *cpu;
+	// Running with the GIL released. Only accessed with the GIL held
+	bool busy;
+};
+
+// Created when the module is initialised
+PyTypeObject *cpuType = nullptr;
+
+constexpr auto memorySize = Py_ssize_t{65536};
+constexpr auto defaultOffset = uint16_t{0x600};
+
+auto cpuOf(PyObject *self) -> microlator_cpu * {
+	return reinterpret_cast<CPUObject *>(self)->cpu;
+}
+
+auto busy(PyObject *self) -> bool & {
+	return reinterpret_cast<CPUObject *>(self)->busy;
+}
+
+// Raise RuntimeError if the CPU is running on another thread
+auto checkIdle(PyObject *self) -> bool {
+	if (!busy(self))
+		return true;
+
+	PyErr_SetString(PyExc_RuntimeError, "CPU is running on another thread");
+	return false;
+}
+
+auto check(microlator_status status) -> bool {
+	switch (status) {
+	case MICROLATOR_OK:
+		return true;
+	case MICROLATOR_INVALID_SNAPSHOT:
+		PyErr_SetString(PyExc_ValueError, "Invalid snapshot");
+		return false;
+	default:
+		PyErr_SetString(PyExc_ValueError, "Invalid argument");
+		return false;
+	}
+}
+
+auto registers(PyObject *self) -> microlator_registers {
+	auto result = microlator_registers{};
+	const microlator_cpu *const cpus[] = {cpuOf(self)};
+	microlator_get_registers(cpus, 1, &result);
+	return result;
+}
+
+void setRegisters(PyObject *self, const microlator_registers &value) {
+	microlator_cpu *const cpus[] = {cpuOf(self)};
+	microlator_set_registers(cpus, 1, &value);
+}
+
+auto cpuNew(PyTypeObject *type, PyObject *, PyObject *) -> PyObject * {
+	auto *self = reinterpret_cast<CPUObject *>(type->tp_alloc(type, 0));
+	if (self == nullptr)
+		return nullptr;
+
+	self->busy = false;
+	self->cpu = microlator_create();
+	if (self->cpu == nullptr) {
+		Py_DECREF(self);
+		return PyErr_NoMemory();
+	}
+
+	return reinterpret_cast<PyObject *>(self);
+}
+
+void cpuDealloc(PyObject *self) {
+	auto *type = Py_TYPE(self);
+	microlator_destroy(cpuOf(self));
+	type->tp_free(self);
+	Py_DECREF(type);
+}
+
+auto cpuGetBuffer(PyObject *self, Py_buffer *view, int flags) -> int {
+	return PyBuffer_FillInfo(view, self, microlator_memory(cpuOf(self)),
+				 memorySize, 0, flags);
+}
+
+auto cpuLoadProgram(PyObject *self, PyObject *args) -> PyObject * {
+	auto program = Py_buffer{};
+	auto offset = defaultOffset;
+	if (!checkIdle(self) ||
+	    !PyArg_ParseTuple(args, "y*|H", &program, &offset))
+		return nullptr;
+
+	const auto status = microlator_load_program(
+	    cpuOf(self), static_cast<const uint8_t *>(program.buf),
+	    static_cast<size_t>(program.len), offset);
+	PyBuffer_Release(&program);
+	if (!check(status))
+		return nullptr;
+
+	Py_RETURN_NONE;
+}
+
+auto cpuReset(PyObject *self, PyObject *) -> PyObject * {
+	if (!checkIdle(self))
+		return nullptr;
+
+	microlator_reset(cpuOf(self));
+	Py_RETURN_NONE;
+}
+
+// Returns False if an unimplemented instruction was reached before
+// until_cycle
+auto cpuRun(PyObject *self, PyObject *args) -> PyObject * {
+	auto untilCycle = 0ULL;
+	if (!checkIdle(self) || !PyArg_ParseTuple(args, "K", &untilCycle))
+		return nullptr;
+
+	auto running = 0;
+	busy(self) = true;
+	Py_BEGIN_ALLOW_THREADS
+	running = microlator_run(cpuOf(self), untilCycle);
+	Py_END_ALLOW_THREADS
+	busy(self) = false;
+
+	return PyBool_FromLong(running);
+}
+
+auto cpuSave(PyObject *self, PyObject *) -> PyObject * {
+	if (!checkIdle(self))
+		return nullptr;
+
+	auto *snapshot =
+	    PyBytes_FromStringAndSize(nullptr, MICROLATOR_SNAPSHOT_SIZE);
+	if (snapshot == nullptr)
+		return nullptr;
+
+	auto *buffer = reinterpret_cast<uint8_t *>(PyBytes_AS_STRING(snapshot));
+	if (!check(microlator_save(cpuOf(self), buffer,
+				   MICROLATOR_SNAPSHOT_SIZE))) {
+		Py_DECREF(snapshot);
+		return nullptr;
+	}
+
+	return snapshot;
+}
+
+auto cpuRestore(PyObject *self, PyObject *args) -> PyObject * {
+	auto snapshot = Py_buffer{};
+	if (!checkIdle(self) || !PyArg_ParseTuple(args, "y*", &snapshot))
+		return nullptr;
+
+	const auto status = microlator_restore(
+	    cpuOf(self), static_cast<const uint8_t *>(snapshot.buf),
+	    static_cast<size_t>(snapshot.len));
+	PyBuffer_Release(&snapshot);
+	if (!check(status))
+		return nullptr;
+
+	Py_RETURN_NONE;
+}
+
+auto cpuMemory(PyObject *self, void *) -> PyObject * {
+	return PyMemoryView_FromObject(self);
+}
+
+// Accessors for each register, given its member in microlator_registers
+template <auto Member> auto getRegister(PyObject *self, void *) -> PyObject * {
+	if (!checkIdle(self))
+		return nullptr;
+
+	return PyLong_FromUnsignedLongLong(registers(self).*Member);
+}
+
+template <auto Member>
+auto setRegister(PyObject *self, PyObject *value, void *) -> int {
+	if (value == nullptr) {
+		PyErr_SetString(PyExc_TypeError, "Registers can't be deleted");
+		return -1;
+	}
+
+	if (!checkIdle(self))
+		return -1;
+
+	const auto number = PyLong_AsUnsignedLongLong(value);
+	if (PyErr_Occurred() != nullptr)
+		return -1;
+
+	auto current = registers(self);
+	using Register = std::remove_reference_t<decltype(current.*Member)>;
+	if (number > static_cast<uint64_t>(Register(~Register{0}))) {
+		PyErr_SetString(PyExc_OverflowError, "Register out of range");
+		return -1;
+	}
+
+	current.*Member = static_cast<Register>(number);
+	setRegisters(self, current);
+	return 0;
+}
+
+template <auto Member>
+constexpr auto registerGetSet(const char *name) -> PyGetSetDef {
+	return {name, getRegister<Member>, setRegister<Member>, nullptr,
+		nullptr};
+}
+
+auto runMany(PyObject *, PyObject *args) -> PyObject * {
+	auto *sequence = static_cast<PyObject *>(nullptr);
+	auto cycles = 0ULL;
+	if (!PyArg_ParseTuple(args, "OK", &sequence, &cycles))
+		return nullptr;
+
+	auto *list = PySequence_Fast(sequence, "Expected a sequence of CPUs");
+	if (list == nullptr)
+		return nullptr;
+
+	const auto count = PySequence_Fast_GET_SIZE(list);
+	std::vector<microlator_cpu *> cpus;
+	for (Py_ssize_t i = 0; i < count; i++) {
+		auto *item = PySequence_Fast_GET_ITEM(list, i);
+		if (PyObject_TypeCheck(item, cpuType) == 0) {
+			Py_DECREF(list);
+			PyErr_SetString(PyExc_TypeError, "Expected a CPU");
+			return nullptr;
+		}
+		cpus.push_back(cpuOf(item));
+	}
+
+	auto sorted = cpus;
+	std::ranges::sort(sorted);
+	if (std::ranges::adjacent_find(sorted) != sorted.end()) {
+		Py_DECREF(list);
+		PyErr_SetString(PyExc_ValueError, "CPUs can't be repeated");
+		return nullptr;
+	}
+
+	for (Py_ssize_t i = 0; i < count; i++) {
+		if (!checkIdle(PySequence_Fast_GET_ITEM(list, i))) {
+			Py_DECREF(list);
+			return nullptr;
+		}
+	}
+
+	// CPUs are kept alive by the list while the GIL is released
+	const auto setBusy = [list, count](bool value) {
+		for (Py_ssize_t i = 0; i < count; i++)
+			busy(PySequence_Fast_GET_ITEM(list, i)) = value;
+	};
+
+	std::vector<int> running(cpus.size());
+	auto status = MICROLATOR_OK;
+	setBusy(true);
+	Py_BEGIN_ALLOW_THREADS
+	status = microlator_run_many(cpus.data(), cpus.size(), cycles,
+				     running.data());
+	Py_END_ALLOW_THREADS
+	setBusy(false);
+
+	Py_DECREF(list);
+	if (!check(status))
+		return nullptr;
+
+	auto *result = PyList_New(count);
+	if (result == nullptr)
+		return nullptr;
+
+	for (Py_ssize_t i = 0; i < count; i++)
+		PyList_SET_ITEM(result, i, PyBool_FromLong(running[i]));
+
+	return result;
+}
+
+PyMethodDef cpuMethods[] = {
+    {"load_program", cpuLoadProgram, METH_VARARGS,
+     "load_program(program, offset=0x600)\n--\n\n"
+     "Copy a program into memory at offset, and point pc at it"},
+    {"reset", cpuReset, METH_NOARGS, "Clear memory and registers"},
+    {"run", cpuRun, METH_VARARGS,
+     "run(until_cycle)\n--\n\n"
+     "Execute instructions until cycle reaches until_cycle, releasing the "
+     "GIL. Returns False if an unimplemented instruction was reached first"},
+    {"save", cpuSave, METH_NOARGS,
+     "Snapshot of the registers and memory, as bytes"},
+    {"restore", cpuRestore, METH_VARARGS,
+     "restore(snapshot)\n--\n\nRestore a snapshot taken by save()"},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyGetSetDef cpuGetSet[] = {
+    {"memory", cpuMemory, nullptr,
+     "Writable memoryview aliasing the CPU's memory", nullptr},
+    registerGetSet<&microlator_registers::accumulator>("accumulator"),
+    registerGetSet<&microlator_registers::index_x>("index_x"),
+    registerGetSet<&microlator_registers::index_y>("index_y"),
+    registerGetSet<&microlator_registers::stack>("stack"),
+    registerGetSet<&microlator_registers::flags>("flags"),
+    registerGetSet<&microlator_registers::pc>("pc"),
+    registerGetSet<&microlator_registers::cycle>("cycle"),
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyType_Slot cpuSlots[] = {
+    {Py_tp_doc, const_cast<char *>("A 6502 CPU with 64KiB of memory")},
+    {Py_tp_new, reinterpret_cast<void *>(cpuNew)},
+    {Py_tp_dealloc, reinterpret_cast<void *>(cpuDealloc)},
+    {Py_tp_methods, cpuMethods},
+    {Py_tp_getset, cpuGetSet},
+    {Py_bf_getbuffer, reinterpret_cast<void *>(cpuGetBuffer)},
+    {0, nullptr},
+};
+
+PyType_Spec cpuSpec = {
+    "microlator.CPU",
+    sizeof(CPUObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    cpuSlots,
+};
+
+PyMethodDef moduleMethods[] = {
+    {"run_many", runMany, METH_VARARGS,
+     "run_many(cpus, cycles)\n--\n\n"
+     "Run each CPU for at least cycles more cycles, releasing the GIL. "
+     "Returns whether each is still running. Each CPU may only be given "
+     "once"},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyModuleDef moduleDef = {
+    PyModuleDef_HEAD_INIT,
+    "microlator",
+    "6502 emulator",
+    -1,
+    moduleMethods,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+};
+
+} // namespace
+
+PyMODINIT_FUNC PyInit_microlator() {
+	auto *module = PyModule_Create(&moduleDef);
+	if (module == nullptr)
+		return nullptr;
+
+	auto *type = PyType_FromSpec(&cpuSpec);
+	const auto added =
+	    type != nullptr &&
+	    PyModule_AddObjectRef(module, "CPU", type) == 0 &&
+	    PyModule_AddIntConstant(module, "SNAPSHOT_SIZE",
+				    MICROLATOR_SNAPSHOT_SIZE) == 0;
+	// The module keeps a reference to the type
+	Py_XDECREF(type);
+	if (!added) {
+		Py_DECREF(module);
+		return nullptr;
+	}
+
+	cpuType = reinterpret_cast<PyTypeObject *>(type);
+	return module;
+}
@@ -0,0 +1,193 @@
+#include "analysis.hpp"
+
+namespace {
+
+using microlator::AddressMode;
+using microlator::DecodedInstruction;
+using microlator::InstructionType;
+using microlator::KnownRegisters;
+using microlator::Mnemonic;
+
+constexpr auto toU8(auto value) { return static_cast<uint8_t>(value); }
+
+constexpr auto toU16(auto value) { return static_cast<uint16_t>(value); }
+
+// Update what is known about the registers after an instruction
+void propagate(const DecodedInstruction &instruction, KnownRegisters &known) {
+	using M = Mnemonic;
+
+	auto &[accumulator, indexX, indexY] = known;
+	const auto immediate =
+	    instruction.addressMode == AddressMode::Immediate
+		? std::optional{toU8(instruction.operand)}
+		: std::nullopt;
+	// Logical operations with an immediate value on a known accumulator
+	const auto combine = [&](auto operation) -> std::optional<uint8_t> {
+		if (!accumulator || !immediate)
+			return std::nullopt;
+
+		return toU8(operation(*accumulator, *immediate));
+	};
+
+	switch (instruction.mnemonic) {
+	case M::LDA:
+		accumulator = immediate;
+		break;
+	case M::LDX:
+		indexX = immediate;
+		break;
+	case M::LDY:
+		indexY = immediate;
+		break;
+	case M::TAX:
+		indexX = accumulator;
+		break;
+	case M::TAY:
+		indexY = accumulator;
+		break;
+	case M::TXA:
+		accumulator = indexX;
+		break;
+	case M::TYA:
+		accumulator = indexY;
+		break;
+	case M::TSX:
+		indexX.reset();
+		break;
+	case M::INX:
+		if (indexX)
+			indexX = toU8(*indexX + 1);
+		break;
+	case M::DEX:
+		if (indexX)
+			indexX = toU8(*indexX - 1);
+		break;
+	case M::INY:
+		if (indexY)
+			indexY = toU8(*indexY + 1);
+		break;
+	case M::DEY:
+		if (indexY)
+			indexY = toU8(*indexY - 1);
+		break;
+	case M::AND:
+		accumulator = combine([](auto a, auto b) { return a & b; });
+		break;
+	case M::ORA:
+		accumulator = combine([](auto a, auto b) { return a | b; });
+		break;
+	case M::EOR:
+		accumulator = combine([](auto a, auto b) { return a ^ b; });
+		break;
+	// The result depends on the carry, which is not tracked
+	case M::ADC:
+	case M::SBC:
+	case M::PLA:
+		accumulator.reset();
+		break;
+	case M::ASL:
+	case M::LSR:
+	case M::ROL:
+	case M::ROR:
+		if (instruction.addressMode == AddressMode::Accumulator)
+			accumulator.reset();
+		break;
+	default:
+		break;
+	}
+}
+
+// Turn an absolute address indexed by a known value into an absolute address
+void foldAbsolute(DecodedInstruction &instruction, uint8_t index) {
+	// Only reads which stay within a page skip the cycle to fix the
+	// address's high byte
+	const auto crossesPage = (instruction.operand & 0xffU) + index > 0xffU;
+	if (instruction.type != InstructionType::Read || crossesPage)
+		instruction.extraCycles++;
+
+	instruction.addressMode = AddressMode::Absolute;
+	instruction.operand = toU16(instruction.operand + index);
+}
+
+// Turn a zeropage address indexed by a known value into a zeropage address
+void foldZeropage(DecodedInstruction &instruction, uint8_t index) {
+	instruction.extraCycles++;
+	instruction.addressMode = AddressMode::Zeropage;
+	instruction.operand = toU8(instruction.operand + index);
+}
+
+} // namespace
+
+namespace microlator {
+
+auto mayStopAfter(const DecodedInstruction &instruction) noexcept -> bool {
+	switch (instruction.mnemonic) {
+	case Mnemonic::PHA:
+	case Mnemonic::PHP:
+		return true;
+	default:
+		return instruction.addressMode != AddressMode::Accumulator &&
+		       (instruction.type == InstructionType::Write ||
+			instruction.type == InstructionType::ReadModifyWrite);
+	}
+}
+
+auto analyse(std::span<const DecodedInstruction> block) -> BlockAnalysis {
+	auto analysis = BlockAnalysis{
+	    std::vector<uint8_t>(block.size()),
+	    std::vector<KnownRegisters>(block.size()),
+	};
+
+	// Constants flow forwards from the start of the block
+	auto known = KnownRegisters{};
+	for (auto i = size_t{0}; i < block.size(); i++) {
+		analysis.known[i] = known;
+		propagate(block[i], known);
+	}
+
+	// Liveness flows backwards from the end of the block, where all flags
+	// may be read
+	auto live = CPU::allFlags;
+	for (auto i = block.size(); i-- > 0;) {
+		if (mayStopAfter(block[i]))
+			live = CPU::allFlags;
+
+		analysis.liveFlags[i] = live;
+		const auto mnemonic = block[i].mnemonic;
+		live = toU8((live & ~flagsWritten(mnemonic)) |
+			    flagsRead(mnemonic));
+	}
+
+	return analysis;
+}
+
+auto specialise(const DecodedInstruction &instruction,
+		const KnownRegisters &known) noexcept -> DecodedInstruction {
+	using Mode = AddressMode;
+
+	auto result = instruction;
+	switch (instruction.addressMode) {
+	case Mode::AbsoluteX:
+		if (known.indexX)
+			foldAbsolute(result, *known.indexX);
+		break;
+	case Mode::AbsoluteY:
+		if (known.indexY)
+			foldAbsolute(result, *known.indexY);
+		break;
+	case Mode::ZeropageX:
+		if (known.indexX)
+			foldZeropage(result, *known.indexX);
+		break;
+	case Mode::ZeropageY:
+		if (known.indexY)
+			foldZeropage(result, *known.indexY);
+		break;
+	default:
+		break;
+	}
+
+	return result;
+}
+
+} // namespace microlator
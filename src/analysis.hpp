@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "cpu.hpp"
+
+namespace microlator {
+
+// Register values known to be constant at a point in a basic block
+struct KnownRegisters {
+	std::optional<uint8_t> accumulator;
+	std::optional<uint8_t> indexX;
+	std::optional<uint8_t> indexY;
+
+	auto operator==(const KnownRegisters &rhs) const noexcept
+	    -> bool = default;
+};
+
+// Facts about each instruction of a basic block, found ahead of running it
+// so that work which cannot be observed can be skipped
+struct BlockAnalysis {
+	// Flags read before being overwritten after each instruction. Only
+	// these need to be computed by it
+	std::vector<uint8_t> liveFlags;
+	// Register values known before each instruction, whatever the state
+	// on entering the block
+	std::vector<KnownRegisters> known;
+};
+
+// Whether a block may have to stop after an instruction, leaving the CPU's
+// state exact: a write to memory may modify the block's code, or be to a
+// device which moves the cycle count
+auto mayStopAfter(const DecodedInstruction &instruction) noexcept -> bool;
+
+// Analyse a basic block, which is only entered at its first instruction and
+// only left after its last, or where it may stop
+auto analyse(std::span<const DecodedInstruction> block) -> BlockAnalysis;
+
+// Fold the registers known before an instruction into it, e.g. an absolute
+// address indexed by a constant X becomes an absolute address. It takes the
+// same cycles, including those for crossing a page, and has the same effect
+auto specialise(const DecodedInstruction &instruction,
+		const KnownRegisters &known) noexcept -> DecodedInstruction;
+
+} // namespace microlator
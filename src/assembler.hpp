@@ -0,0 +1,490 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "cpu.hpp"
+
+namespace microlator {
+
+// A string literal which can be passed as a template argument
+template <size_t N> struct FixedString {
+	constexpr FixedString(const char (&string)[N]) {
+		std::copy_n(string, N, data.begin());
+	}
+
+	[[nodiscard]] constexpr auto view() const noexcept -> std::string_view {
+		return {data.data(), N - 1};
+	}
+
+	std::array<char, N> data{};
+};
+
+// Names of each Mnemonic, in the same order
+constexpr auto mnemonicNames = std::to_array<std::string_view>({
+    // clang-format off
+	"ADC", "AND", "ASL", "BCC", "BCS", "BEQ", "BIT", "BMI", "BNE", "BPL",
+	"BRK", "BVC", "BVS", "CLC", "CLD", "CLI", "CLV", "CMP", "CPX", "CPY",
+	"DEC", "DEX", "DEY", "EOR", "INC", "INX", "INY", "JMP", "JSR", "LDA",
+	"LDX", "LDY", "LSR", "NOP", "ORA", "PHA", "PHP", "PLA", "PLP", "ROL",
+	"ROR", "RTI", "RTS", "SBC", "SEC", "SED", "SEI", "STA", "STX", "STY",
+	"TAX", "TAY", "TSX", "TXA", "TXS", "TYA",
+    // clang-format on
+});
+
+// Two pass assembler for 6502 source, which can run at compile time. Each
+// line holds an optional label and an instruction or directive:
+//     loop:   LDA table,X   ; comment
+// Operands are written as usual: #value, A, address, address,X, (address),
+// (address,X) and (address),Y. The zeropage form is chosen for addresses
+// below $100 which are known from the lines above, and branches take their
+// target address. Values are decimal, $hex or %binary numbers or symbols,
+// added or subtracted, and <value or >value select their low or high byte.
+// Directives are .org address, .byte values and .word values, and symbols
+// are defined with name = value.
+// Output begins at the first byte assembled, by default at $0600 where the
+// CPU starts. Errors throw std::invalid_argument, which fails compilation in
+// a constant expression
+class Assembler {
+public:
+	constexpr explicit Assembler(std::string_view source);
+
+	// Address of the first byte of output
+	[[nodiscard]] constexpr auto origin() const noexcept -> uint16_t;
+	[[nodiscard]] constexpr auto bytes() const noexcept
+	    -> const std::vector<uint8_t> &;
+
+	constexpr static auto defaultOrigin = uint16_t{0x600};
+
+private:
+	struct Symbol {
+		std::string_view name;
+		uint16_t value;
+		// Line on which the symbol is defined
+		size_t line;
+	};
+
+	struct Value {
+		uint16_t value{0};
+		// Whether every symbol was defined
+		bool resolved{true};
+		// Whether every symbol was defined on an earlier line, so the
+		// value was known when the first pass reached this line
+		bool early{true};
+	};
+
+	constexpr void pass(bool emit);
+	constexpr void assembleLine(std::string_view text);
+	constexpr void define(std::string_view name, Value value);
+	constexpr void directive(std::string_view name,
+				 std::string_view operands);
+	constexpr void instruction(std::string_view name,
+				   std::string_view operand);
+	constexpr void emit(uint8_t value);
+	[[nodiscard]] constexpr auto evaluate(std::string_view text) const
+	    -> Value;
+	[[nodiscard]] constexpr auto term(std::string_view text) const -> Value;
+
+	constexpr static auto trim(std::string_view text) -> std::string_view;
+	constexpr static auto upper(char c) -> char;
+	constexpr static auto equal(std::string_view a, std::string_view b)
+	    -> bool;
+	constexpr static auto endsWith(std::string_view text,
+				       std::string_view suffix) -> bool;
+	constexpr static auto parseNumber(std::string_view digits,
+					  uint32_t base) -> uint16_t;
+	constexpr static auto find(Mnemonic mnemonic, AddressMode mode)
+	    -> int;
+
+	std::string_view source;
+	std::vector<Symbol> symbols;
+	std::vector<uint8_t> output;
+	bool emitting{false};
+	bool started{false};
+	uint16_t start{defaultOrigin};
+	uint32_t address{defaultOrigin};
+	size_t line{0};
+};
+
+// Assemble source at compile time, e.g.
+//     constexpr auto program = assemble<"LDX #0\nloop: INX\nBNE loop">();
+template <FixedString Source> consteval auto assemble() {
+	constexpr auto size = Assembler{Source.view()}.bytes().size();
+	const auto assembler = Assembler{Source.view()};
+
+	std::array<uint8_t, size> program{};
+	std::copy(assembler.bytes().begin(), assembler.bytes().end(),
+		  program.begin());
+	return program;
+}
+
+constexpr Assembler::Assembler(std::string_view source) : source{source} {
+	pass(false);
+	pass(true);
+}
+
+constexpr auto Assembler::origin() const noexcept -> uint16_t {
+	return start;
+}
+
+constexpr auto Assembler::bytes() const noexcept
+    -> const std::vector<uint8_t> & {
+	return output;
+}
+
+// The first pass only defines labels, so that the second can refer to those
+// defined later
+constexpr void Assembler::pass(bool emit) {
+	emitting = emit;
+	started = false;
+	start = defaultOrigin;
+	address = defaultOrigin;
+	line = 0;
+
+	auto remaining = source;
+	while (!remaining.empty()) {
+		const auto end = remaining.find('\n');
+		assembleLine(remaining.substr(0, end));
+		remaining = (end == std::string_view::npos)
+				? std::string_view{}
+				: remaining.substr(end + 1);
+		line++;
+	}
+}
+
+constexpr void Assembler::assembleLine(std::string_view text) {
+	text = trim(text.substr(0, text.find(';')));
+
+	if (const auto colon = text.find(':');
+	    colon != std::string_view::npos) {
+		define(trim(text.substr(0, colon)),
+		       {static_cast<uint16_t>(address)});
+		text = trim(text.substr(colon + 1));
+	}
+
+	if (text.empty())
+		return;
+
+	const auto space = std::min(text.find_first_of(" \t="), text.size());
+	const auto name = text.substr(0, space);
+	const auto rest = trim(text.substr(space));
+
+	if (rest.starts_with('=')) {
+		const auto value = evaluate(rest.substr(1));
+		if (!value.early)
+			throw std::invalid_argument{
+			    "Symbol refers to a later symbol"};
+
+		define(name, value);
+	} else if (name.starts_with('.')) {
+		directive(name, rest);
+	} else {
+		instruction(name, rest);
+	}
+}
+
+constexpr void Assembler::define(std::string_view name, Value value) {
+	if (name.empty() ||
+	    !std::ranges::all_of(name, [](char c) {
+		    return c == '_' || (c >= '0' && c <= '9') ||
+			   (upper(c) >= 'A' && upper(c) <= 'Z');
+	    }) ||
+	    (name[0] >= '0' && name[0] <= '9'))
+		throw std::invalid_argument{"Invalid symbol name"};
+
+	// Symbols are all known after the first pass
+	if (emitting)
+		return;
+
+	if (std::ranges::any_of(symbols, [&](const auto &symbol) {
+		    return symbol.name == name;
+	    }))
+		throw std::invalid_argument{"Symbol defined twice"};
+
+	symbols.push_back({name, value.value, line});
+}
+
+constexpr void Assembler::directive(std::string_view name,
+				    std::string_view operands) {
+	if (equal(name, ".org")) {
+		const auto value = evaluate(operands);
+		if (!value.early)
+			throw std::invalid_argument{
+			    "Origin refers to a later symbol"};
+		if (started && value.value < address)
+			throw std::invalid_argument{"Origin moves backwards"};
+
+		if (!started)
+			address = value.value;
+
+		while (address < value.value)
+			emit(0);
+
+		return;
+	}
+
+	const auto word = equal(name, ".word");
+	if (!word && !equal(name, ".byte"))
+		throw std::invalid_argument{"Unknown directive"};
+
+	while (!operands.empty()) {
+		const auto comma =
+		    std::min(operands.find(','), operands.size());
+		const auto value = evaluate(operands.substr(0, comma));
+		if (emitting && !value.resolved)
+			throw std::invalid_argument{"Undefined symbol"};
+		if (emitting && !word && value.value > 0xff)
+			throw std::invalid_argument{"Byte out of range"};
+
+		emit(static_cast<uint8_t>(value.value));
+		if (word)
+			emit(static_cast<uint8_t>(value.value >> 8U));
+
+		operands =
+		    operands.substr(std::min(comma + 1, operands.size()));
+	}
+}
+
+constexpr void Assembler::instruction(std::string_view name,
+				      std::string_view operand) {
+	using Mode = AddressMode;
+
+	const auto it = std::ranges::find_if(
+	    mnemonicNames, [&](auto other) { return equal(name, other); });
+	if (it == mnemonicNames.end())
+		throw std::invalid_argument{"Unknown instruction"};
+
+	const auto mnemonic =
+	    static_cast<Mnemonic>(std::distance(mnemonicNames.begin(), it));
+
+	// Whitespace within operands has no meaning
+	std::array<char, 64> buffer{};
+	auto length = size_t{0};
+	for (const auto c : operand) {
+		if (c == ' ' || c == '\t')
+			continue;
+		if (length == buffer.size())
+			throw std::invalid_argument{"Operand too long"};
+
+		buffer.at(length++) = c;
+	}
+	operand = {buffer.data(), length};
+
+	// The mode to use if the value fits in the zeropage, and otherwise
+	auto zeropage = Mode::Implicit;
+	auto mode = Mode::Implicit;
+	auto value = Value{};
+	if (operand.empty()) {
+		const auto implicit = find(mnemonic, Mode::Implicit) >= 0;
+		mode = implicit ? Mode::Implicit : Mode::Accumulator;
+	} else if (equal(operand, "A")) {
+		mode = Mode::Accumulator;
+	} else if (operand.starts_with('#')) {
+		mode = Mode::Immediate;
+		value = evaluate(operand.substr(1));
+	} else if (operand.starts_with('(') && endsWith(operand, ",X)")) {
+		mode = Mode::IndirectX;
+		value = evaluate(operand.substr(1, operand.size() - 4));
+	} else if (operand.starts_with('(') && endsWith(operand, "),Y")) {
+		mode = Mode::IndirectY;
+		value = evaluate(operand.substr(1, operand.size() - 4));
+	} else if (operand.starts_with('(') && operand.ends_with(')')) {
+		mode = Mode::Indirect;
+		value = evaluate(operand.substr(1, operand.size() - 2));
+	} else if (endsWith(operand, ",X")) {
+		zeropage = Mode::ZeropageX;
+		mode = Mode::AbsoluteX;
+		value = evaluate(operand.substr(0, operand.size() - 2));
+	} else if (endsWith(operand, ",Y")) {
+		zeropage = Mode::ZeropageY;
+		mode = Mode::AbsoluteY;
+		value = evaluate(operand.substr(0, operand.size() - 2));
+	} else if (find(mnemonic, Mode::Relative) >= 0) {
+		mode = Mode::Relative;
+		value = evaluate(operand);
+	} else {
+		zeropage = Mode::Zeropage;
+		mode = Mode::Absolute;
+		value = evaluate(operand);
+	}
+
+	if (zeropage != Mode::Implicit && value.early && value.value <= 0xff &&
+	    find(mnemonic, zeropage) >= 0)
+		mode = zeropage;
+
+	const auto opcode = find(mnemonic, mode);
+	if (opcode < 0)
+		throw std::invalid_argument{
+		    "Addressing mode not supported by instruction"};
+	if (emitting && !value.resolved)
+		throw std::invalid_argument{"Undefined symbol"};
+
+	emit(static_cast<uint8_t>(opcode));
+	switch (mode) {
+	case Mode::Relative: {
+		// Relative to the end of the instruction
+		const auto offset = int32_t{value.value} -
+				    static_cast<int32_t>(address + 1);
+		if (emitting && (offset < -128 || offset > 127))
+			throw std::invalid_argument{"Branch out of range"};
+
+		emit(static_cast<uint8_t>(offset));
+		break;
+	}
+	default:
+		if (operandLength(mode) == 1) {
+			if (emitting && value.value > 0xff)
+				throw std::invalid_argument{
+				    "Value out of range"};
+
+			emit(static_cast<uint8_t>(value.value));
+		} else if (operandLength(mode) == 2) {
+			emit(static_cast<uint8_t>(value.value));
+			emit(static_cast<uint8_t>(value.value >> 8U));
+		}
+		break;
+	}
+}
+
+constexpr void Assembler::emit(uint8_t value) {
+	if (address >= CPU::memorySize)
+		throw std::invalid_argument{"Program can't fit in memory"};
+
+	if (!started) {
+		started = true;
+		start = static_cast<uint16_t>(address);
+	}
+
+	if (emitting)
+		output.push_back(value);
+
+	address++;
+}
+
+constexpr auto Assembler::evaluate(std::string_view text) const -> Value {
+	text = trim(text);
+
+	auto selector = '\0';
+	if (text.starts_with('<') || text.starts_with('>')) {
+		selector = text[0];
+		text = text.substr(1);
+	}
+
+	auto result = Value{};
+	auto sum = uint32_t{0};
+	auto subtract = false;
+	while (true) {
+		const auto end = text.find_first_of("+-");
+		const auto value = term(text.substr(0, end));
+		sum = subtract ? sum - value.value : sum + value.value;
+		result.resolved = result.resolved && value.resolved;
+		result.early = result.early && value.early;
+
+		if (end == std::string_view::npos)
+			break;
+
+		subtract = text[end] == '-';
+		text = text.substr(end + 1);
+	}
+
+	result.value = static_cast<uint16_t>(sum);
+	if (selector == '<')
+		result.value = static_cast<uint8_t>(result.value);
+	else if (selector == '>')
+		result.value = static_cast<uint8_t>(result.value >> 8U);
+
+	return result;
+}
+
+constexpr auto Assembler::term(std::string_view text) const -> Value {
+	constexpr auto hexadecimal = 16U;
+	constexpr auto decimal = 10U;
+
+	text = trim(text);
+	if (text.empty())
+		throw std::invalid_argument{"Missing value"};
+
+	if (text.starts_with('$'))
+		return {parseNumber(text.substr(1), hexadecimal)};
+	if (text.starts_with('%'))
+		return {parseNumber(text.substr(1), 2)};
+	if (text[0] >= '0' && text[0] <= '9')
+		return {parseNumber(text, decimal)};
+
+	const auto symbol =
+	    std::ranges::find_if(symbols, [&](const auto &other) {
+		    return other.name == text;
+	    });
+	if (symbol == symbols.end())
+		return {0, false, false};
+
+	return {symbol->value, true, symbol->line < line};
+}
+
+constexpr auto Assembler::trim(std::string_view text) -> std::string_view {
+	const auto first = text.find_first_not_of(" \t\r");
+	if (first == std::string_view::npos)
+		return {};
+
+	const auto last = text.find_last_not_of(" \t\r");
+	return text.substr(first, last - first + 1);
+}
+
+constexpr auto Assembler::upper(char c) -> char {
+	return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// Compare ignoring case
+constexpr auto Assembler::equal(std::string_view a, std::string_view b)
+    -> bool {
+	return std::ranges::equal(a, b, [](char x, char y) {
+		return upper(x) == upper(y);
+	});
+}
+
+constexpr auto Assembler::endsWith(std::string_view text,
+				   std::string_view suffix) -> bool {
+	return text.size() >= suffix.size() &&
+	       equal(text.substr(text.size() - suffix.size()), suffix);
+}
+
+constexpr auto Assembler::parseNumber(std::string_view digits, uint32_t base)
+    -> uint16_t {
+	if (digits.empty())
+		throw std::invalid_argument{"Missing digits"};
+
+	auto value = uint32_t{0};
+	for (const auto c : digits) {
+		const auto u = upper(c);
+		const auto digit = (u >= 'A' && u <= 'Z')
+				       ? static_cast<uint32_t>(u - 'A' + 10)
+				       : static_cast<uint32_t>(c - '0');
+		if (digit >= base)
+			throw std::invalid_argument{"Invalid digit"};
+
+		value = value * base + digit;
+		if (value > 0xffff)
+			throw std::invalid_argument{"Value out of range"};
+	}
+
+	return static_cast<uint16_t>(value);
+}
+
+// The opcode of an instruction using an addressing mode, or -1 if it has none
+constexpr auto Assembler::find(Mnemonic mnemonic, AddressMode mode) -> int {
+	const auto it =
+	    std::ranges::find_if(opcodes, [&](const Opcode &opcode) {
+		    return opcode.mnemonic == mnemonic &&
+			   opcode.addressMode == mode;
+	    });
+
+	return (it != opcodes.end())
+		   ? static_cast<int>(std::distance(opcodes.begin(), it))
+		   : -1;
+}
+
+} // namespace microlator
@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "atari2600.hpp"
+
+namespace {
+
+// The 6507 only has 13 address lines
+constexpr auto addressMask = 0x1fffU;
+constexpr auto cartridgeBit = 0x1000U;
+// Within the lower half of the address space, which chip is selected
+constexpr auto riotBit = 0x80U;
+constexpr auto riotIOBit = 0x200U;
+constexpr auto riotTimerBit = 0x04U;
+constexpr auto riotTimerWriteBit = 0x10U;
+constexpr auto ramMask = 0x7fU;
+
+constexpr auto mirrorPages = (addressMask + 1) / microlator::CPU::pageSize;
+constexpr auto halfPages = mirrorPages / 2;
+
+constexpr auto timerIntervals = std::to_array<uint16_t>({1, 8, 64, 1024});
+
+constexpr auto toU8(auto value) { return static_cast<uint8_t>(value); }
+
+} // namespace
+
+namespace microlator {
+
+auto Tia::read(const CPU &, uint16_t address) -> uint8_t {
+	// Only the top two bits are driven, and only inputs are modelled
+	constexpr auto inputBit = 0x80U;
+
+	switch (address & 0x0fU) {
+	case INPT4:
+		return buttons[0] ? 0 : inputBit;
+	case INPT5:
+		return buttons[1] ? 0 : inputBit;
+	default:
+		return 0;
+	}
+}
+
+void Tia::write(CPU &cpu, uint16_t address, uint8_t value) {
+	constexpr auto vsyncBit = 0x02U;
+	const auto reg = toU8(address & 0x3fU);
+
+	catchUp(cpu.cycle);
+	const auto previous = registers[reg];
+	registers[reg] = value;
+
+	switch (reg) {
+	case VSYNC:
+		if ((value & vsyncBit) && !(previous & vsyncBit)) {
+			frame++;
+			frameLines = scanline;
+			scanline = 0;
+		}
+		break;
+	case WSYNC:
+		// The CPU is halted until the start of the next scanline
+		if (cpu.cycle != lineStart) {
+			cpu.cycle = lineStart + cyclesPerLine;
+			catchUp(cpu.cycle);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void Tia::reset() { *this = Tia{}; }
+
+void Tia::catchUp(uint64_t cycle) {
+	const auto lines = (cycle - lineStart) / cyclesPerLine;
+	scanline += lines;
+	lineStart += lines * cyclesPerLine;
+}
+
+auto Riot::read(const CPU &cpu, uint16_t address) -> uint8_t {
+	constexpr auto underflowBit = 0x80U;
+
+	if (!(address & riotTimerBit)) {
+		switch (address & 0x03U) {
+		case 0:
+			return swcha;
+		case 2:
+			return swchb;
+		default:
+			return 0;
+		}
+	}
+
+	// The timer counts down once per interval until it passes zero, then
+	// once per cycle
+	const auto elapsed = cpu.cycle - timerStart;
+	const auto ticks = elapsed / timerInterval;
+	const auto underflowed = ticks > timerValue;
+
+	if (address & 0x01U)
+		return underflowed ? underflowBit : 0;
+
+	if (!underflowed)
+		return toU8(timerValue - ticks);
+
+	const auto underflow = (timerValue + uint64_t{1}) * timerInterval;
+	return toU8(0xff - (elapsed - underflow));
+}
+
+void Riot::write(CPU &cpu, uint16_t address, uint8_t value) {
+	if (!(address & riotTimerBit) || !(address & riotTimerWriteBit))
+		return;
+
+	timerStart = cpu.cycle;
+	timerValue = value;
+	timerInterval = timerIntervals.at(address & 0x03U);
+}
+
+void Riot::reset() { *this = Riot{}; }
+
+Atari2600::Atari2600(std::span<const uint8_t> rom)
+    : rom{rom.begin(), rom.end()} {
+	switch (rom.size()) {
+	case bankSize / 2:
+	case bankSize:
+		break;
+	case bankSize * 2:
+		firstHotspot = 0xff8;
+		lastHotspot = 0xff9;
+		break;
+	case bankSize * 4:
+		firstHotspot = 0xff6;
+		lastHotspot = 0xff9;
+		break;
+	case bankSize * 8:
+		firstHotspot = 0xff4;
+		lastHotspot = 0xffb;
+		break;
+	default:
+		throw std::invalid_argument{"Unsupported cartridge size"};
+	}
+
+	// The TIA, RAM and RIOT occupy the lower half of each mirror. Within
+	// the cartridge, only the page containing the bank switching hotspots
+	// is always intercepted, and the rest until they have been loaded
+	for (auto page = 0U; page < CPU::pageCount; page += mirrorPages)
+		cpu.map(*this, page, page + halfPages - 1);
+
+	reset();
+}
+
+void Atari2600::reset() {
+	constexpr auto resetVector = 0xfffcU;
+
+	cpu.reset();
+	tia.reset();
+	riot.reset();
+
+	// Resetting the CPU cleared the cartridge from memory
+	bank = noBank;
+	pageBanks.fill(noBank);
+	selectBank(std::max<size_t>(rom.size() / bankSize, 1) - 1);
+	load(resetVector);
+	cpu.pc = static_cast<uint16_t>(cpu.memory[resetVector] |
+				       (cpu.memory[resetVector + 1] << 8U));
+}
+
+auto Atari2600::runFrames(uint64_t frames, uint64_t maxCycles) -> bool {
+	const auto frame = tia.frame + frames;
+	const auto cycle = cpu.cycle + maxCycles;
+
+	while (tia.frame < frame && cpu.cycle < cycle) {
+		if (!cpu.step())
+			return false;
+	}
+
+	return true;
+}
+
+auto Atari2600::read(const CPU &cpu, uint16_t address) -> uint8_t {
+	address = access(address);
+	if (address & cartridgeBit) {
+		// Copies of the CPU, such as checkpoints, read the cartridge
+		// directly, as only this one's memory is kept up to date
+		if (&cpu != &this->cpu) {
+			const auto size =
+			    std::min<size_t>(rom.size(), bankSize);
+			return rom[bank * size + address % size];
+		}
+
+		load(address);
+		return cpu.memory[address];
+	}
+
+	if (!(address & riotBit))
+		return tia.read(cpu, address);
+
+	if (!(address & riotIOBit))
+		return cpu.memory[riotBit | (address & ramMask)];
+
+	return riot.read(cpu, address);
+}
+
+void Atari2600::write(CPU &cpu, uint16_t address, uint8_t value) {
+	address = access(address);
+	if (address & cartridgeBit)
+		return;
+
+	if (!(address & riotBit))
+		tia.write(cpu, address, value);
+	else if (!(address & riotIOBit))
+		cpu.memory[riotBit | (address & ramMask)] = value;
+	else
+		riot.write(cpu, address, value);
+}
+
+// Switch banks if a hotspot was accessed, and strip the unconnected address
+// lines
+auto Atari2600::access(uint16_t address) -> uint16_t {
+	const auto offset = address & (bankSize - 1);
+	if ((address & cartridgeBit) && offset >= firstHotspot &&
+	    offset <= lastHotspot && lastHotspot != 0)
+		selectBank(offset - firstHotspot);
+
+	// Cartridge reads go to the mirror they were made through, as each
+	// holds a copy of the current bank once loaded
+	return (address & cartridgeBit) ? address : (address & addressMask);
+}
+
+// Intercept accesses to the pages of the cartridge which hold another bank,
+// so that they are loaded when next accessed
+void Atari2600::selectBank(size_t selected) {
+	if (selected == bank)
+		return;
+
+	bank = selected;
+	for (auto mirror = halfPages; mirror < CPU::pageCount;
+	     mirror += mirrorPages) {
+		for (auto page = mirror; page < mirror + halfPages; page++) {
+			const auto current = pageBanks.at(page) == bank;
+			if (hotspotPage(page))
+				cpu.map(*this, page, page);
+			else if (current && cpu.mapped(page * CPU::pageSize))
+				cpu.unmap(page, page);
+			else if (!current && !cpu.mapped(page * CPU::pageSize))
+				cpu.map(*this, page, page);
+			else
+				continue;
+
+			if (!current)
+				cpu.notifyWatchers(page, page);
+		}
+	}
+}
+
+// Copy the current bank into the page of the cartridge containing address,
+// if it holds another, and stop intercepting it
+void Atari2600::load(uint16_t address) {
+	const auto page = address / CPU::pageSize;
+	if (pageBanks.at(page) != bank) {
+		const auto size = std::min<size_t>(rom.size(), bankSize);
+		const auto offset = (page * CPU::pageSize) % size;
+		const auto *begin = rom.data() + bank * size + offset;
+		std::copy(begin, begin + CPU::pageSize,
+			  cpu.memory.begin() + page * CPU::pageSize);
+		pageBanks.at(page) = bank;
+	}
+
+	if (!hotspotPage(page))
+		cpu.unmap(page, page);
+}
+
+auto Atari2600::hotspotPage(size_t page) const -> bool {
+	return lastHotspot != 0 && page % mirrorPages == mirrorPages - 1;
+}
+
+} // namespace microlator
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "cpu.hpp"
+#include "device.hpp"
+
+namespace microlator {
+
+// Headless model of the Television Interface Adaptor. Nothing is drawn: the
+// beam position is only brought up to date ("caught up") when a register is
+// accessed, and WSYNC skips the CPU straight to the end of the scanline
+class Tia {
+public:
+	constexpr static auto cyclesPerLine = 76U;
+
+	enum Register : uint8_t {
+		VSYNC = 0x00,
+		VBLANK = 0x01,
+		WSYNC = 0x02,
+		INPT4 = 0x0c,
+		INPT5 = 0x0d,
+	};
+
+	auto read(const CPU &cpu, uint16_t address) -> uint8_t;
+	void write(CPU &cpu, uint16_t address, uint8_t value);
+	void reset();
+
+	// Frames started so far, counted at the start of vertical sync
+	uint64_t frame{0};
+	// Scanlines since the start of the current frame
+	uint32_t scanline{0};
+	// Scanlines in the last complete frame
+	uint32_t frameLines{0};
+	// Last value written to each register
+	std::array<uint8_t, 0x40> registers{};
+	// Whether the fire button of each joystick is pressed
+	std::array<bool, 2> buttons{};
+
+private:
+	void catchUp(uint64_t cycle);
+
+	// CPU cycle at which the current scanline began
+	uint64_t lineStart{0};
+};
+
+// Headless model of the 6532 RAM-I/O-Timer. The timer is not decremented
+// while running; reads derive its value from the cycles since it was set
+class Riot {
+public:
+	auto read(const CPU &cpu, uint16_t address) -> uint8_t;
+	void write(CPU &cpu, uint16_t address, uint8_t value);
+	void reset();
+
+	// Joystick directions, active low
+	uint8_t swcha{0xff};
+	// Console switches, active low: colour, with reset and select released
+	uint8_t swchb{0x0b};
+
+private:
+	uint64_t timerStart{0};
+	uint8_t timerValue{0};
+	uint16_t timerInterval{1024};
+};
+
+// Headless Atari 2600, for running cartridges without a display. Supports
+// 2K and 4K cartridges, and 8K, 16K and 32K cartridges using the standard
+// F8, F6 and F4 bank switching schemes.
+// The cartridge is copied into memory a page at a time, the first time each
+// page is accessed after the bank it holds is switched out. Until then the
+// page is mapped to this device, and write watchers are notified that it
+// changed when the bank is switched. Copies of the CPU read the pages still
+// mapped to it straight from the cartridge
+class Atari2600 : public Device {
+public:
+	// cpu maps pages to this device, so neither can be copied or moved
+	explicit Atari2600(std::span<const uint8_t> rom);
+	Atari2600(const Atari2600 &) = delete;
+	Atari2600(Atari2600 &&) = delete;
+	auto operator=(const Atari2600 &) -> Atari2600 & = delete;
+	auto operator=(Atari2600 &&) -> Atari2600 & = delete;
+	~Atari2600() override = default;
+
+	// Power on, starting at the cartridge's reset vector
+	void reset();
+	// Run until the given number of frames have started or maxCycles have
+	// passed. Returns false if the CPU reached an unimplemented instruction
+	auto runFrames(uint64_t frames, uint64_t maxCycles) -> bool;
+
+	auto read(const CPU &cpu, uint16_t address) -> uint8_t override;
+	void write(CPU &cpu, uint16_t address, uint8_t value) override;
+
+	CPU cpu;
+	Tia tia;
+	Riot riot;
+
+private:
+	constexpr static auto bankSize = 0x1000U;
+	constexpr static auto noBank = ~size_t{0};
+
+	auto access(uint16_t address) -> uint16_t;
+	void selectBank(size_t bank);
+	void load(uint16_t address);
+	[[nodiscard]] auto hotspotPage(size_t page) const -> bool;
+
+	std::vector<uint8_t> rom;
+	size_t bank{noBank};
+	// Bank held in memory by each page of the cartridge
+	std::array<size_t, CPU::pageCount> pageBanks{};
+	// Addresses within the cartridge which select each bank when accessed
+	uint16_t firstHotspot{0};
+	uint16_t lastHotspot{0};
+};
+
+} // namespace microlator
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "batch.hpp"
+
+namespace {
+
+using microlator::CPU;
+using microlator::MemoryRange;
+
+// Vectors are claimed by each thread in chunks, to limit contention on the
+// shared counter
+constexpr auto vectorsPerClaim = size_t{16};
+
+auto threadCount(unsigned threads) -> unsigned {
+	if (threads != 0)
+		return threads;
+
+	return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+void checkRange(MemoryRange range) {
+	if (range.address + range.length > CPU::memorySize)
+		throw std::invalid_argument{"Range can't fit in memory"};
+}
+
+} // namespace
+
+namespace microlator {
+
+Batch::Batch(std::span<const uint8_t> program, uint16_t offset,
+	     MemoryRange input, MemoryRange output, uint64_t maxCycles)
+    : input{input}, output{output}, maxCycles{maxCycles} {
+	checkRange(input);
+	checkRange(output);
+	snapshot.loadProgram(program, offset);
+}
+
+auto Batch::run(std::span<const std::span<const uint8_t>> inputs,
+		unsigned threads) const -> std::vector<BatchResult> {
+	const auto tooLong = [this](auto vector) {
+		return vector.size() > input.length;
+	};
+	if (std::any_of(inputs.begin(), inputs.end(), tooLong))
+		throw std::invalid_argument{"Input vector is too long"};
+
+	std::vector<BatchResult> results(inputs.size());
+	std::atomic<size_t> next{0};
+
+	const auto work = [&] {
+		// Each thread reuses one CPU, restoring it from the snapshot
+		auto cpu = snapshot;
+		for (auto begin = next.fetch_add(vectorsPerClaim);
+		     begin < inputs.size();
+		     begin = next.fetch_add(vectorsPerClaim)) {
+			const auto end =
+			    std::min(begin + vectorsPerClaim, inputs.size());
+			for (auto i = begin; i < end; i++) {
+				cpu = snapshot;
+				results[i] = runOne(cpu, inputs[i]);
+			}
+		}
+	};
+
+	{
+		std::vector<std::jthread> workers;
+		const auto claims =
+		    (inputs.size() + vectorsPerClaim - 1) / vectorsPerClaim;
+		const auto count =
+		    std::min<size_t>(threadCount(threads), claims);
+		for (size_t i = 1; i < count; i++)
+			workers.emplace_back(work);
+
+		work();
+	}
+
+	return results;
+}
+
+auto Batch::runOne(CPU &cpu, std::span<const uint8_t> vector) const
+    -> BatchResult {
+	std::copy(vector.begin(), vector.end(),
+		  cpu.memory.begin() + input.address);
+
+	auto result = BatchResult{};
+	result.finished = !cpu.run(snapshot.cycle + maxCycles);
+	result.cycles = cpu.cycle - snapshot.cycle;
+
+	const auto *outputBegin = cpu.memory.begin() + output.address;
+	result.output.assign(outputBegin, outputBegin + output.length);
+
+	return result;
+}
+
+} // namespace microlator
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "cpu.hpp"
+
+namespace microlator {
+
+// A region of guest memory
+struct MemoryRange {
+	uint16_t address{0};
+	uint16_t length{0};
+};
+
+struct BatchResult {
+	// Contents of the output range after the run
+	std::vector<uint8_t> output;
+	uint64_t cycles{0};
+	// Whether the program finished by reaching an unimplemented
+	// instruction, rather than running out of cycles
+	bool finished{false};
+};
+
+// Runs one program against many input vectors. Each vector is written to the
+// input range of a copy of the CPU taken after loading the program, which then
+// runs until reaching an unimplemented instruction (e.g. $02) or maxCycles
+class Batch {
+public:
+	Batch(std::span<const uint8_t> program, uint16_t offset,
+	      MemoryRange input, MemoryRange output, uint64_t maxCycles);
+
+	// Run every vector, spreading them across threads
+	[[nodiscard]] auto
+	run(std::span<const std::span<const uint8_t>> inputs,
+	    unsigned threads = 0) const -> std::vector<BatchResult>;
+
+private:
+	auto runOne(CPU &cpu, std::span<const uint8_t> input) const
+	    -> BatchResult;
+
+	CPU snapshot;
+	MemoryRange input;
+	MemoryRange output;
+	uint64_t maxCycles;
+};
+
+} // namespace microlator
@@ -0,0 +1,111 @@
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "blockdevice.hpp"
+#include "cpu.hpp"
+
+namespace {
+
+constexpr auto registerMask = 0x07U;
+
+[[noreturn]] void throwErrno(const char *what) {
+	throw std::system_error{errno, std::generic_category(), what};
+}
+
+} // namespace
+
+namespace microlator {
+
+BlockDevice::BlockDevice(const std::filesystem::path &path, size_t sectorSize)
+    : sectorSize{sectorSize} {
+	if (sectorSize == 0)
+		throw std::invalid_argument{"Sectors can't be empty"};
+
+	const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		throwErrno("Failed to open block device file");
+
+	struct stat info {};
+	if (::fstat(fd, &info) != 0) {
+		::close(fd);
+		throwErrno("Failed to stat block device file");
+	}
+
+	// The mapping stays valid once the file is closed. An empty file can't
+	// be mapped, but has nothing to transfer anyway
+	length = static_cast<size_t>(info.st_size);
+	if (length != 0) {
+		mapping =
+		    ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED) {
+			::close(fd);
+			throwErrno("Failed to map block device file");
+		}
+		data = static_cast<const uint8_t *>(mapping);
+	}
+
+	::close(fd);
+}
+
+BlockDevice::~BlockDevice() {
+	if (data != nullptr)
+		::munmap(mapping, length);
+}
+
+auto BlockDevice::read(const CPU &, uint16_t address) -> uint8_t {
+	const auto reg = address & registerMask;
+	if (reg == Status)
+		return status;
+	if (reg == Command)
+		return 0;
+
+	return parameters[reg];
+}
+
+void BlockDevice::write(CPU &cpu, uint16_t address, uint8_t value) {
+	const auto reg = address & registerMask;
+	if (reg < Command) {
+		parameters[reg] = value;
+		return;
+	}
+
+	if (reg != Command)
+		return;
+
+	if (value == Read)
+		transfer(cpu);
+	else
+		status = UnknownCommand;
+}
+
+auto BlockDevice::size() const -> size_t { return length; }
+
+void BlockDevice::transfer(CPU &cpu) {
+	const auto offset = size_t{parameter(SectorLow)} * sectorSize;
+	const auto destination = size_t{parameter(DestinationLow)};
+	const auto count = size_t{parameter(LengthLow)};
+
+	cpu.cycle += commandCycles;
+	if (offset > length || count > length - offset ||
+	    destination + count > CPU::memorySize) {
+		status = OutOfRange;
+		return;
+	}
+
+	cpu.store(static_cast<uint16_t>(destination), {data + offset, count});
+	cpu.cycle += cyclesPerByte * count;
+	status = Ok;
+}
+
+auto BlockDevice::parameter(Register low) const -> uint16_t {
+	return static_cast<uint16_t>(parameters[low] |
+				     (parameters[low + 1] << 8U));
+}
+
+} // namespace microlator
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+
+#include "device.hpp"
+
+namespace microlator {
+
+// Memory-mapped disk which copies whole runs of sectors from a host file into
+// the CPU's memory in one operation, as direct memory access would. The file
+// is mapped into the host's memory rather than read.
+// The guest sets the sector, destination and length registers, then writes
+// Read to the command register, after which the CPU resumes with the data in
+// place and the cost of the transfer added to its cycle. Transferred bytes
+// are stored directly to memory with CPU::store(), bypassing any devices
+// mapped there
+class BlockDevice : public Device {
+public:
+	// Registers, mirrored through every page the device is mapped to.
+	// Multi-byte registers are little endian
+	enum Register : uint8_t {
+		SectorLow = 0,
+		SectorHigh = 1,
+		DestinationLow = 2,
+		DestinationHigh = 3,
+		LengthLow = 4,
+		LengthHigh = 5,
+		Command = 6,
+		Status = 7,
+	};
+
+	enum CommandCode : uint8_t {
+		Read = 1,
+	};
+
+	enum StatusCode : uint8_t {
+		Ok = 0,
+		// The transfer would read past the end of the file, or write
+		// past the end of memory
+		OutOfRange = 1,
+		UnknownCommand = 2,
+	};
+
+	explicit BlockDevice(const std::filesystem::path &path,
+			     size_t sectorSize = 256);
+	~BlockDevice() override;
+
+	auto read(const CPU &cpu, uint16_t address) -> uint8_t override;
+	void write(CPU &cpu, uint16_t address, uint8_t value) override;
+
+	[[nodiscard]] auto size() const -> size_t;
+
+	// Cycles charged for each command, and for each byte transferred
+	uint64_t commandCycles{0};
+	uint64_t cyclesPerByte{1};
+
+private:
+	void transfer(CPU &cpu);
+	[[nodiscard]] auto parameter(Register low) const -> uint16_t;
+
+	void *mapping{nullptr};
+	const uint8_t *data{nullptr};
+	size_t length{0};
+	size_t sectorSize;
+
+	std::array<uint8_t, Command> parameters{};
+	uint8_t status{Ok};
+};
+
+} // namespace microlator
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "console.hpp"
+
+namespace {
+
+constexpr auto registerMask = 0x03U;
+
+} // namespace
+
+namespace microlator {
+
+Console::Console(int fd, size_t capacity) : fd{fd}, buffer(capacity) {
+	if (capacity == 0)
+		throw std::invalid_argument{"Console buffer can't be empty"};
+}
+
+Console::~Console() { flush(); }
+
+void Console::provideInput(std::span<const uint8_t> bytes) {
+	// Drop what has already been read, rather than growing forever
+	input.erase(input.begin(), input.begin() + inputPosition);
+	inputPosition = 0;
+	input.insert(input.end(), bytes.begin(), bytes.end());
+}
+
+auto Console::flush() -> bool {
+	while (size > 0) {
+		// The buffered bytes wrap around at most once, so take at most
+		// two writes
+		const auto contiguous = std::min(size, buffer.size() - head);
+		const auto written =
+		    ::write(fd, buffer.data() + head, contiguous);
+		writes++;
+
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return false;
+
+			dropped += size;
+			head = size = 0;
+			return false;
+		}
+
+		head = (head + static_cast<size_t>(written)) % buffer.size();
+		size -= static_cast<size_t>(written);
+	}
+
+	head = 0;
+	return true;
+}
+
+auto Console::read(const CPU &, uint16_t address) -> uint8_t {
+	const auto remaining = inputPosition < input.size();
+
+	switch (address & registerMask) {
+	case Input:
+		return remaining ? input[inputPosition++] : 0;
+	case Status:
+		return static_cast<uint8_t>(OutputReady |
+					    (remaining ? InputReady : 0));
+	default:
+		return 0;
+	}
+}
+
+void Console::write(CPU &, uint16_t address, uint8_t value) {
+	if ((address & registerMask) != Output)
+		return;
+
+	put(value);
+	if (size == buffer.size() || (lineBuffered && value == '\n'))
+		flush();
+}
+
+void Console::put(uint8_t value) {
+	if (size == buffer.size()) {
+		dropped++;
+		return;
+	}
+
+	buffer[(head + size) % buffer.size()] = value;
+	size++;
+}
+
+} // namespace microlator
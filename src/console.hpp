@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "device.hpp"
+
+namespace microlator {
+
+// Memory-mapped text console. Output is collected in a ring buffer, which is
+// written to a host file descriptor when a newline is output, when it fills
+// up, or when flush() is called, e.g. at the end of each run. Input is served
+// from bytes provided up front.
+// Errors writing to the descriptor can't be raised while the CPU is running,
+// so the output is discarded and counted instead
+class Console : public Device {
+public:
+	// Registers, mirrored through every page the console is mapped to
+	enum Register : uint8_t {
+		// Write a byte of output
+		Output = 0,
+		// Read the next byte of input, or 0 once there is none left
+		Input = 1,
+		// Read which of the status bits are set
+		Status = 2,
+	};
+
+	enum StatusBit : uint8_t {
+		InputReady = 0x01,
+		OutputReady = 0x02,
+	};
+
+	explicit Console(int fd, size_t capacity = 4096);
+	~Console() override;
+
+	// Queue bytes for the guest to read
+	void provideInput(std::span<const uint8_t> bytes);
+	// Write all buffered output. Returns false if some could not be
+	// written, because the descriptor would block or failed
+	auto flush() -> bool;
+
+	auto read(const CPU &cpu, uint16_t address) -> uint8_t override;
+	void write(CPU &cpu, uint16_t address, uint8_t value) override;
+
+	// Whether a newline flushes the output
+	bool lineBuffered{true};
+	// Writes made to the descriptor so far
+	uint64_t writes{0};
+	// Bytes of output discarded after errors or while the buffer was full
+	uint64_t dropped{0};
+
+private:
+	void put(uint8_t value);
+
+	int fd;
+	std::vector<uint8_t> buffer;
+	size_t head{0};
+	size_t size{0};
+
+	std::vector<uint8_t> input;
+	size_t inputPosition{0};
+};
+
+} // namespace microlator
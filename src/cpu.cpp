@@ -4,6 +4,8 @@
 #include <stdexcept>
 
 #include "cpu.hpp"
+#include "device.hpp"
+#include "taint.hpp"
 
 namespace {
 
@@ -79,12 +81,15 @@ constexpr auto ValueStore::read() const noexcept -> uint16_t {
 	return {};
 }
 
-constexpr void CPU::reset() {
+void CPU::reset() {
 	memory = Memory{};
 	pc = initialProgramCounter;
 	stack = initialStackPointer;
 	flags.reset();
 	cycle = 0;
+#ifdef MICROLATOR_LAST_WRITER
+	std::ranges::fill(lastWriters, LastWriter{});
+#endif
 }
 
 void CPU::loadProgram(const std::span<const uint8_t> program, uint16_t offset) {
@@ -99,24 +104,290 @@ void CPU::loadProgram(const std::span<const uint8_t> program) {
 	loadProgram(program, initialProgramCounter);
 }
 
+void CPU::store(uint16_t address, std::span<const uint8_t> data) {
+	if (address + data.size() > memory.size())
+		throw std::invalid_argument{"Data can't fit in memory"};
+
+	const auto end = address + data.size();
+	for (auto i = size_t{address}; i < end; i++) {
+#ifdef MICROLATOR_LAST_WRITER
+		lastWriters[i] = writer;
+#endif
+		if (auto *watcher = watchers.pages[i / pageSize])
+			watcher->written(*this, static_cast<uint16_t>(i));
+	}
+
+	std::ranges::copy(data, memory.begin() + address);
+}
+
+void CPU::map(Device &device, uint8_t firstPage, uint8_t lastPage) {
+	if (firstPage > lastPage)
+		throw std::invalid_argument{"Page range is empty"};
+
+	std::fill(devices.begin() + firstPage, devices.begin() + lastPage + 1,
+		  &device);
+}
+
+void CPU::unmap(uint8_t firstPage, uint8_t lastPage) {
+	if (firstPage > lastPage)
+		throw std::invalid_argument{"Page range is empty"};
+
+	std::fill(devices.begin() + firstPage, devices.begin() + lastPage + 1,
+		  nullptr);
+}
+
+void CPU::protect(uint8_t firstPage, uint8_t lastPage) {
+	if (firstPage > lastPage)
+		throw std::invalid_argument{"Page range is empty"};
+
+	std::fill(readOnlyPages.begin() + firstPage,
+		  readOnlyPages.begin() + lastPage + 1, true);
+}
+
+void CPU::unprotect(uint8_t firstPage, uint8_t lastPage) {
+	if (firstPage > lastPage)
+		throw std::invalid_argument{"Page range is empty"};
+
+	std::fill(readOnlyPages.begin() + firstPage,
+		  readOnlyPages.begin() + lastPage + 1, false);
+}
+
 auto CPU::step() noexcept -> bool {
+	NoTaint taint;
+	return execute(taint);
+}
+
+auto CPU::step(TaintState &taint) noexcept -> bool { return execute(taint); }
+
+auto CPU::run(uint64_t untilCycle) noexcept -> bool {
+	while (cycle < untilCycle) {
+		if (!step())
+			return false;
+	}
+
+	return true;
+}
+
+void CPU::nmi() noexcept { interrupt(nmiVector); }
+
+auto CPU::irq() noexcept -> bool {
+	if (flags.test(F::InterruptOff))
+		return false;
+
+	interrupt(irqVector);
+	return true;
+}
+
+auto CPU::decode(uint16_t address) const noexcept -> DecodedInstruction {
+	static const auto decoded = [] {
+		const auto instructions = getInstructions<NoTaint>();
+		std::array<DecodedInstruction, instructions.size()> result{};
+		for (auto i = size_t{0}; i < instructions.size(); i++) {
+			const auto &[function, mode] = instructions.at(i);
+			if (!function)
+				continue;
+
+			result.at(i) = {
+			    function,
+			    opcodes.at(i).mnemonic,
+			    mode,
+			    getInstructionType<NoTaint>(function),
+			    toU8(operandLength(mode) + 1),
+			};
+		}
+
+		return result;
+	}();
+
+	auto instruction = decoded.at(memory[address]);
+	const auto low = memory[toU16(address + 1)];
+	const auto high = memory[toU16(address + 2)];
+	switch (instruction.length) {
+	case 2:
+		instruction.operand = low;
+		break;
+	case 3:
+		instruction.operand = toU16(low | (high << 8U));
+		break;
+	default:
+		break;
+	}
+
+	return instruction;
+}
+
+void CPU::execute(const DecodedInstruction &instruction,
+		  uint8_t liveFlags) noexcept {
+	assert(instruction.function);
+
+#ifdef MICROLATOR_LAST_WRITER
+	writer = {pc, cycle};
+#endif
+	// Account for the fetch as step() would
+	cycle += instruction.length + instruction.extraCycles;
+	pc += instruction.length;
+
+	const auto target = resolveTarget(
+	    instruction.addressMode, instruction.type, instruction.operand);
+	if ((liveFlags & flagsWritten(instruction.mnemonic)) == 0 &&
+	    executeWithoutFlags(instruction.mnemonic, target))
+		return;
+
+	NoTaint taint;
+	std::invoke(instruction.function, this, target, taint);
+}
+
+auto CPU::mapped(uint16_t address) const noexcept -> bool {
+	return devices[address / pageSize] != nullptr;
+}
+
+auto CPU::readOnly(uint16_t address) const noexcept -> bool {
+	return readOnlyPages[address / pageSize];
+}
+
+void CPU::watch(WriteWatcher &watcher, uint8_t firstPage, uint8_t lastPage) {
+	if (firstPage > lastPage)
+		throw std::invalid_argument{"Page range is empty"};
+
+	std::fill(watchers.pages.begin() + firstPage,
+		  watchers.pages.begin() + lastPage + 1, &watcher);
+}
+
+void CPU::unwatch(uint8_t firstPage, uint8_t lastPage) {
+	if (firstPage > lastPage)
+		throw std::invalid_argument{"Page range is empty"};
+
+	std::fill(watchers.pages.begin() + firstPage,
+		  watchers.pages.begin() + lastPage + 1, nullptr);
+}
+
+void CPU::notifyWatchers(uint8_t firstPage, uint8_t lastPage) {
+	if (firstPage > lastPage)
+		throw std::invalid_argument{"Page range is empty"};
+
+	// Watchers may stop watching part way through a page
+	const auto end = (lastPage + 1U) * pageSize;
+	for (auto address = firstPage * pageSize; address < end; address++) {
+		if (auto *watcher = watchers.pages[address / pageSize])
+			watcher->written(*this, static_cast<uint16_t>(address));
+	}
+}
+
+template <class Taint> auto CPU::execute(Taint &taint) noexcept -> bool {
+#ifdef MICROLATOR_LAST_WRITER
+	writer = {pc, cycle};
+#endif
 	const auto opcode = read(pc++);
 
-	static auto instructions = CPU::getInstructions();
+	static auto instructions = CPU::getInstructions<Taint>();
 	const auto instruction = instructions.at(opcode);
 	if (!instruction.function)
 		return false;
 
-	const auto type = getInstructionType(instruction.function);
+	const auto type = getInstructionType<Taint>(instruction.function);
 	const auto target = getTarget(instruction.addressMode, type);
-	std::invoke(instruction.function, this, target);
+	std::invoke(instruction.function, this, target, taint);
 
 	return true;
 }
 
+// Execute an instruction whose flag results are all dead, with the same
+// timing and memory accesses. Returns false if it has no such shortcut
+constexpr auto CPU::executeWithoutFlags(Mnemonic mnemonic,
+					ValueStore target) noexcept -> bool {
+	using M = Mnemonic;
+
+	switch (mnemonic) {
+	case M::LDA:
+		accumulator = toU8(target.read());
+		return true;
+	case M::LDX:
+		indexX = toU8(target.read());
+		return true;
+	case M::LDY:
+		indexY = toU8(target.read());
+		return true;
+	case M::AND:
+		accumulator &= toU8(target.read());
+		return true;
+	case M::ORA:
+		accumulator |= toU8(target.read());
+		return true;
+	case M::EOR:
+		accumulator ^= toU8(target.read());
+		return true;
+	case M::CMP:
+	case M::CPX:
+	case M::CPY:
+	case M::BIT:
+		// Only the read is observable
+		static_cast<void>(target.read());
+		return true;
+	case M::TAX:
+		indexX = accumulator;
+		break;
+	case M::TAY:
+		indexY = accumulator;
+		break;
+	case M::TXA:
+		accumulator = indexX;
+		break;
+	case M::TYA:
+		accumulator = indexY;
+		break;
+	case M::TSX:
+		indexX = stack;
+		break;
+	case M::INX:
+		indexX++;
+		break;
+	case M::INY:
+		indexY++;
+		break;
+	case M::DEX:
+		indexX--;
+		break;
+	case M::DEY:
+		indexY--;
+		break;
+	case M::CLC:
+	case M::SEC:
+	case M::CLV:
+	case M::CLD:
+	case M::SED:
+		break;
+	default:
+		return false;
+	}
+
+	// Implied instructions take an extra cycle
+	cycle++;
+	return true;
+}
+
 // Get the target address depending on the addressing mode
 constexpr auto CPU::getTarget(AddressMode mode, InstructionType type) noexcept
     -> ValueStore {
+	return resolveTarget(mode, type, fetchOperand(mode));
+}
+
+// Read the bytes of the instruction following its opcode
+constexpr auto CPU::fetchOperand(AddressMode mode) noexcept -> uint16_t {
+	switch (operandLength(mode)) {
+	case 1:
+		return read(pc++);
+	case 2: {
+		const auto operand = read2(pc);
+		pc += 2;
+		return operand;
+	}
+	default:
+		return 0;
+	}
+}
+
+constexpr auto CPU::resolveTarget(AddressMode mode, InstructionType type,
+				  uint16_t operand) noexcept -> ValueStore {
 	using Mode = AddressMode;
 	using Type = InstructionType;
 
@@ -134,32 +405,26 @@ constexpr auto CPU::getTarget(AddressMode mode, InstructionType type) noexcept
 		return ValueStore(self);
 	}
 
-	// Use value at next address e.g. LDX #$00
+	// Use next byte as the value e.g. LDX #$00
 	case Mode::Immediate: {
-		return {self, read(pc++), ValueStore::Type::Value};
+		return {self, operand, ValueStore::Type::Value};
 	}
 
 	// Use 16-bit value embedded in instruction, e.g. JMP $1234
 	case Mode::Absolute: {
-		const auto address = read2(pc);
-		pc += 2;
-		return {self, address};
+		return {self, operand};
 	}
 
 	// Like Absolute, but add value of register X, e.g. JMP $1234,X
 	case Mode::AbsoluteX: {
-		const uint16_t address =
-		    relativeAddress(getTarget(Mode::Absolute).get(), indexX,
-				    type != Type::Read);
-		return {self, address};
+		return {self,
+			relativeAddress(operand, indexX, type != Type::Read)};
 	}
 
 	// Like Absolute, but add value of register Y, e.g. JMP $1234,Y
 	case Mode::AbsoluteY: {
-		const uint16_t address =
-		    relativeAddress(getTarget(Mode::Absolute).get(), indexY,
-				    type != Type::Read);
-		return {self, address};
+		return {self,
+			relativeAddress(operand, indexY, type != Type::Read)};
 	}
 
 	// Use the value at the address embedded in the instruction
@@ -167,31 +432,27 @@ constexpr auto CPU::getTarget(AddressMode mode, InstructionType type) noexcept
 	case Mode::Indirect: {
 		// indirectJumpBug: a hardware bug results in the increment
 		// actually flipping the lower byte from 0xff to 0x00
-		const uint16_t lowTarget = getTarget(Mode::Absolute).get(),
-			       highTarget =
-				   indirectJumpBug && (lowTarget & u8Max)
-				       ? (lowTarget & u16Upper)
-				       : lowTarget + 1;
+		const uint16_t highTarget =
+		    indirectJumpBug && (operand & u8Max) == u8Max
+			? (operand & u16Upper)
+			: operand + 1;
 
-		return {self,
-			toU16((read(highTarget) << 8U) + read(lowTarget))};
+		return {self, toU16((read(highTarget) << 8U) + read(operand))};
 	}
 
 	// Like Zeropage, but the X index to the indirect address
 	// e.g. LDA ($12,X)
 	case Mode::IndirectX: {
-		const auto indirectAddr = relativeAddress(
-		    getTarget(Mode::Zeropage).get(), indexX, true);
+		const auto indirectAddr =
+		    relativeAddress(operand, indexX, true);
 		return {self, read2(indirectAddr, true)};
 	}
 
 	// Like Indirect, but the Y index to the final address
 	// e.g. LDA ($12),Y
 	case Mode::IndirectY: {
-		const uint16_t indirectAddr = getTarget(Mode::Zeropage).get(),
-			       address =
-				   relativeAddress(read2(indirectAddr, true),
-						   indexY, type != Type::Read);
+		const uint16_t address = relativeAddress(
+		    read2(operand, true), indexY, type != Type::Read);
 
 		return {self, address};
 	}
@@ -199,13 +460,12 @@ constexpr auto CPU::getTarget(AddressMode mode, InstructionType type) noexcept
 	// Use the value embedded in the instruction as a signed offset
 	// from the program counter (after the instruction has been decoded)
 	case Mode::Relative: {
-		const uint8_t value = getTarget(Mode::Immediate).get(),
-			      lowerBits = value ^ 0b1000'0000U;
+		const auto value = toU8(operand);
 		// Two's complement: when the high bit is set the number is
-		// negative, in which case flip the lower bits and add one.
-		// If positive the original value is correct
+		// negative, in which case flip the bits and add one to get its
+		// magnitude. If positive the original value is correct
 		if (isNegative(value))
-			return {self, toU16(pc - (~lowerBits + 1))};
+			return {self, toU16(pc - toU8(~value + 1))};
 
 		return {self, toU16(pc + value)};
 	}
@@ -213,21 +473,19 @@ constexpr auto CPU::getTarget(AddressMode mode, InstructionType type) noexcept
 	// Use the 4-bit value embedded in the instruction as an offset from the
 	// beginning of memory
 	case Mode::Zeropage: {
-		return {self, read(pc++)};
+		return {self, operand};
 	}
 
 	// Like Zeropage, but add value of register X and wrap within the page
 	case Mode::ZeropageX: {
 		return {self,
-			wrapToByte(relativeAddress(
-			    getTarget(Mode::Immediate).get(), indexX, true))};
+			wrapToByte(relativeAddress(operand, indexX, true))};
 	}
 
 	// Like Zeropage, but add value of register Y and wrap within the page
 	case Mode::ZeropageY: {
 		return {self,
-			wrapToByte(relativeAddress(
-			    getTarget(Mode::Immediate).get(), indexY, true))};
+			wrapToByte(relativeAddress(operand, indexY, true))};
 	}
 	}
 
@@ -241,8 +499,21 @@ constexpr void CPU::branch(uint16_t address, bool useCycle) noexcept {
 		cycle++;
 }
 
+// Push the program counter and flags, then jump through the vector
+constexpr void CPU::interrupt(uint16_t vector) noexcept {
+	read(pc); // Read and discard
+	read(pc);
+	push2(pc);
+	push(toU8(flags.get() & ~Flags::bitmask(F::Break)));
+	flags.set(F::InterruptOff, true);
+	pc = read2(vector);
+}
+
 constexpr auto CPU::read(uint16_t address) const noexcept -> uint8_t {
 	cycle++;
+	if (auto *device = devices[address / pageSize])
+		return device->read(*this, address);
+
 	return memory[address];
 }
 
@@ -266,6 +537,20 @@ constexpr auto CPU::relativeAddress(uint16_t address, uint8_t offset,
 
 constexpr void CPU::write(uint16_t address, uint8_t value) noexcept {
 	cycle++;
+	if (readOnlyPages[address / pageSize])
+		return;
+
+#ifdef MICROLATOR_LAST_WRITER
+	lastWriters[address] = writer;
+#endif
+	if (auto *watcher = watchers.pages[address / pageSize])
+		watcher->written(*this, address);
+
+	if (auto *device = devices[address / pageSize]) {
+		device->write(*this, address, value);
+		return;
+	}
+
 	memory[address] = value;
 }
 
@@ -331,360 +616,502 @@ constexpr void CPU::compare(uint8_t a, uint8_t b) noexcept {
 
 constexpr void CPU::addWithCarry(uint8_t value) noexcept {
 	// TODO: implement decimal mode
-	const uint8_t result =
-	    accumulator + value + (flags.test(F::Carry) ? 1 : 0);
+	const auto sum = accumulator + value + (flags.test(F::Carry) ? 1U : 0U);
+	const auto result = toU8(sum);
 	calculateFlag(result, F::Zero, F::Negative);
 
 	const auto resultSign = sign(result);
 	flags.set(F::Overflow, (sign(accumulator) != resultSign) &&
 				   (sign(value) != resultSign));
-	flags.set(F::Carry, result < accumulator);
+	flags.set(F::Carry, sum > u8Max);
 
 	accumulator = result;
 }
 
-constexpr void CPU::oADC(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oADC(ValueStore address, Taint &taint) noexcept {
 	addWithCarry(address.read());
+	const auto label =
+	    taint.accumulator | taint.of(address) | taint.flag(F::Carry);
+	taint.accumulator = label;
+	taint.setFlags(label, F::Carry, F::Zero, F::Overflow, F::Negative);
 }
 
-constexpr void CPU::oAND(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oAND(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	accumulator &= input;
 	calculateFlag(accumulator, F::Zero, F::Negative);
+	taint.accumulator = taint.accumulator | taint.of(address);
+	taint.setFlags(taint.accumulator, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oASL(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oASL(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	flags.set(F::Carry, getBit(7, input));
 	const auto result = input << 1U;
 	cycle++;
 	calculateFlag(result, F::Zero, F::Negative);
 	address.write(result);
+	taint.setFlags(taint.of(address), F::Carry, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oBCC(ValueStore target) noexcept {
+template <class Taint>
+constexpr void CPU::oBCC(ValueStore target, Taint &) noexcept {
 	if (!flags.test(F::Carry))
 		branch(target.get());
 }
 
-constexpr void CPU::oBCS(ValueStore target) noexcept {
+template <class Taint>
+constexpr void CPU::oBCS(ValueStore target, Taint &) noexcept {
 	if (flags.test(F::Carry))
 		branch(target.get());
 }
 
-constexpr void CPU::oBEQ(ValueStore target) noexcept {
+template <class Taint>
+constexpr void CPU::oBEQ(ValueStore target, Taint &) noexcept {
 	if (flags.test(F::Zero))
 		branch(target.get());
 }
 
-constexpr void CPU::oBIT(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oBIT(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	flags.set(F::Zero, (input & accumulator) == 0U);
 	flags.set(F::Overflow, getBit(6, input));
 	flags.set(F::Negative, isNegative(input));
+	taint.setFlags(taint.accumulator | taint.of(address), F::Zero);
+	taint.setFlags(taint.of(address), F::Overflow, F::Negative);
 }
 
-constexpr void CPU::oBMI(ValueStore target) noexcept {
+template <class Taint>
+constexpr void CPU::oBMI(ValueStore target, Taint &) noexcept {
 	if (flags.test(F::Negative))
 		branch(target.get());
 }
 
-constexpr void CPU::oBNE(ValueStore target) noexcept {
+template <class Taint>
+constexpr void CPU::oBNE(ValueStore target, Taint &) noexcept {
 	if (!flags.test(F::Zero))
 		branch(target.get());
 }
 
-constexpr void CPU::oBPL(ValueStore target) noexcept {
+template <class Taint>
+constexpr void CPU::oBPL(ValueStore target, Taint &) noexcept {
 	if (!flags.test(F::Negative))
 		branch(target.get());
 }
 
-constexpr void CPU::oBRK(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oBRK(ValueStore, Taint &taint) noexcept {
 	read(pc++); // Read and discard
 	flags.set(F::InterruptOff, true);
+	taint.setFlags({}, F::InterruptOff);
 
+	taint.store(toU16(stackTop + stack), {});
+	taint.store(toU16(stackTop + toU8(stack - 1)), {});
 	push2(pc);
+	taint.store(toU16(stackTop + stack), taint.allFlags());
 	push(toU8(flags.get()));
 }
 
-constexpr void CPU::oBVC(ValueStore target) noexcept {
+template <class Taint>
+constexpr void CPU::oBVC(ValueStore target, Taint &) noexcept {
 	if (!flags.test(F::Overflow))
 		branch(target.get());
 }
 
-constexpr void CPU::oBVS(ValueStore target) noexcept {
+template <class Taint>
+constexpr void CPU::oBVS(ValueStore target, Taint &) noexcept {
 	if (flags.test(F::Overflow))
 		branch(target.get());
 }
 
-constexpr void CPU::oCLC(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oCLC(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	flags.set(F::Carry, false);
+	taint.setFlags({}, F::Carry);
 }
 
-constexpr void CPU::oCLD(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oCLD(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	flags.set(F::Decimal, false);
+	taint.setFlags({}, F::Decimal);
 }
 
-constexpr void CPU::oCLI(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oCLI(ValueStore, Taint &taint) noexcept {
 	flags.set(F::InterruptOff, false);
+	taint.setFlags({}, F::InterruptOff);
 }
 
-constexpr void CPU::oCLV(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oCLV(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	flags.set(F::Overflow, false);
+	taint.setFlags({}, F::Overflow);
 }
 
-constexpr void CPU::oCMP(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oCMP(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	compare(accumulator, input);
+	taint.setFlags(taint.accumulator | taint.of(address), F::Carry,
+		       F::Zero, F::Negative);
 }
 
-constexpr void CPU::oCPX(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oCPX(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	compare(indexX, input);
+	taint.setFlags(taint.indexX | taint.of(address), F::Carry, F::Zero,
+		       F::Negative);
 }
 
-constexpr void CPU::oCPY(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oCPY(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	compare(indexY, input);
+	taint.setFlags(taint.indexY | taint.of(address), F::Carry, F::Zero,
+		       F::Negative);
 }
 
-constexpr void CPU::oDEC(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oDEC(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	const auto result = input - 1;
 	cycle++;
 	calculateFlag(result, F::Zero, F::Negative);
 	address.write(result);
+	taint.setFlags(taint.of(address), F::Zero, F::Negative);
 }
 
-constexpr void CPU::oDEX(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oDEX(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	const auto result = indexX - 1;
 	calculateFlag(result, F::Zero, F::Negative);
 	indexX = result;
+	taint.setFlags(taint.indexX, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oDEY(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oDEY(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	const auto result = indexY - 1;
 	calculateFlag(result, F::Zero, F::Negative);
 	indexY = result;
+	taint.setFlags(taint.indexY, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oEOR(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oEOR(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	accumulator = accumulator ^ input;
 	calculateFlag(accumulator, F::Zero, F::Negative);
+	taint.accumulator = taint.accumulator | taint.of(address);
+	taint.setFlags(taint.accumulator, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oINC(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oINC(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	const auto result = input + 1;
 	cycle++;
 	calculateFlag(result, F::Zero, F::Negative);
 	address.write(result);
+	taint.setFlags(taint.of(address), F::Zero, F::Negative);
 }
 
-constexpr void CPU::oINX(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oINX(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	const auto result = indexX + 1;
 	calculateFlag(result, F::Zero, F::Negative);
 	indexX = result;
+	taint.setFlags(taint.indexX, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oINY(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oINY(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	const auto result = indexY + 1;
 	calculateFlag(result, F::Zero, F::Negative);
 	indexY = result;
+	taint.setFlags(taint.indexY, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oJMP(ValueStore target) noexcept {
+template <class Taint>
+constexpr void CPU::oJMP(ValueStore target, Taint &) noexcept {
 	branch(target.get(), false);
 }
 
-constexpr void CPU::oJSR(ValueStore target) noexcept {
+template <class Taint>
+constexpr void CPU::oJSR(ValueStore target, Taint &taint) noexcept {
 	cycle++; // Internal operation
+	taint.store(toU16(stackTop + stack), {});
+	taint.store(toU16(stackTop + toU8(stack - 1)), {});
 	push2(toU16(pc - 1));
 	branch(target.get(), false);
 }
 
-constexpr void CPU::oLDA(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oLDA(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	accumulator = input;
 	calculateFlag(input, F::Zero, F::Negative);
+	taint.accumulator = taint.of(address);
+	taint.setFlags(taint.accumulator, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oLDX(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oLDX(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	indexX = input;
 	calculateFlag(input, F::Zero, F::Negative);
+	taint.indexX = taint.of(address);
+	taint.setFlags(taint.indexX, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oLDY(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oLDY(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	indexY = input;
 	calculateFlag(input, F::Zero, F::Negative);
+	taint.indexY = taint.of(address);
+	taint.setFlags(taint.indexY, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oLSR(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oLSR(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	const auto result = input >> 1U;
 	cycle++;
 	calculateFlag(result, F::Zero, F::Negative);
 	flags.set(F::Carry, getBit(0, input));
 	address.write(result);
+	taint.setFlags(taint.of(address), F::Carry, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oNOP(ValueStore) noexcept { cycle++; }
+template <class Taint> constexpr void CPU::oNOP(ValueStore, Taint &) noexcept {
+	cycle++;
+}
 
-constexpr void CPU::oORA(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oORA(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	const auto result = accumulator | input;
 	calculateFlag(result, F::Zero, F::Negative);
 	accumulator = result;
+	taint.accumulator = taint.accumulator | taint.of(address);
+	taint.setFlags(taint.accumulator, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oPHA(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oPHA(ValueStore, Taint &taint) noexcept {
 	read(pc); // Read and discard
+	taint.store(toU16(stackTop + stack), taint.accumulator);
 	push(accumulator);
 }
 
-constexpr void CPU::oPHP(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oPHP(ValueStore, Taint &taint) noexcept {
 	read(pc); // Read and discard
+	taint.store(toU16(stackTop + stack), taint.allFlags());
 	push(toU8(flags.get() | Flags::bitmask(F::Break)));
 }
 
-constexpr void CPU::oPLA(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oPLA(ValueStore, Taint &taint) noexcept {
 	read(pc); // Read and discard
 	accumulator = pop(true);
 	calculateFlag(accumulator, F::Zero, F::Negative);
+	taint.accumulator = taint.load(toU16(stackTop + stack));
+	taint.setFlags(taint.accumulator, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oPLP(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oPLP(ValueStore, Taint &taint) noexcept {
 	read(pc); // Read and discard
 	popFlags(true);
+	taint.setFlags(taint.load(toU16(stackTop + stack)), F::Carry, F::Zero,
+		       F::InterruptOff, F::Decimal, F::Break, F::Unused,
+		       F::Overflow, F::Negative);
 }
 
-constexpr void CPU::oROL(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oROL(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	const auto result = setBit(0, input << 1U, flags.test(F::Carry));
 	cycle++;
 	flags.set(F::Carry, getBit(7, input));
 	calculateFlag(result, F::Zero, F::Negative);
 	address.write(result);
+	const auto label = taint.of(address) | taint.flag(F::Carry);
+	taint.setFlags(taint.of(address), F::Carry);
+	taint.setFlags(label, F::Zero, F::Negative);
+	taint.set(address, label);
 }
 
-constexpr void CPU::oROR(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oROR(ValueStore address, Taint &taint) noexcept {
 	const auto input = address.read();
 	const auto result = setBit(7, input >> 1U, flags.test(F::Carry));
 	cycle++;
 	flags.set(F::Carry, getBit(0, input));
 	calculateFlag(result, F::Zero, F::Negative);
 	address.write(result);
+	const auto label = taint.of(address) | taint.flag(F::Carry);
+	taint.setFlags(taint.of(address), F::Carry);
+	taint.setFlags(label, F::Zero, F::Negative);
+	taint.set(address, label);
 }
 
-constexpr void CPU::oRTI(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oRTI(ValueStore, Taint &taint) noexcept {
 	popFlags(true);
+	taint.setFlags(taint.load(toU16(stackTop + stack)), F::Carry, F::Zero,
+		       F::InterruptOff, F::Decimal, F::Break, F::Unused,
+		       F::Overflow, F::Negative);
 	branch(pop2());
 }
 
-constexpr void CPU::oRTS(ValueStore) noexcept {
+template <class Taint> constexpr void CPU::oRTS(ValueStore, Taint &) noexcept {
 	read(pc); // Read and discard
 	branch(pop2(true) + 1);
 }
 
-constexpr void CPU::oSBC(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oSBC(ValueStore address, Taint &taint) noexcept {
 	addWithCarry(~address.read());
+	const auto label =
+	    taint.accumulator | taint.of(address) | taint.flag(F::Carry);
+	taint.accumulator = label;
+	taint.setFlags(label, F::Carry, F::Zero, F::Overflow, F::Negative);
 }
 
-constexpr void CPU::oSEC(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oSEC(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	flags.set(F::Carry, true);
+	taint.setFlags({}, F::Carry);
 }
 
-constexpr void CPU::oSED(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oSED(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	flags.set(F::Decimal, true);
+	taint.setFlags({}, F::Decimal);
 }
 
-constexpr void CPU::oSEI(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oSEI(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	flags.set(F::InterruptOff, true);
+	taint.setFlags({}, F::InterruptOff);
 }
 
-constexpr void CPU::oSTA(ValueStore address) noexcept {
+template <class Taint>
+constexpr void CPU::oSTA(ValueStore address, Taint &taint) noexcept {
 	address.write(accumulator);
+	taint.set(address, taint.accumulator);
 }
 
-constexpr void CPU::oSTX(ValueStore address) noexcept { address.write(indexX); }
+template <class Taint>
+constexpr void CPU::oSTX(ValueStore address, Taint &taint) noexcept {
+	address.write(indexX);
+	taint.set(address, taint.indexX);
+}
 
-constexpr void CPU::oSTY(ValueStore address) noexcept { address.write(indexY); }
+template <class Taint>
+constexpr void CPU::oSTY(ValueStore address, Taint &taint) noexcept {
+	address.write(indexY);
+	taint.set(address, taint.indexY);
+}
 
-constexpr void CPU::oTAX(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oTAX(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	indexX = accumulator;
 	calculateFlag(indexX, F::Zero, F::Negative);
+	taint.indexX = taint.accumulator;
+	taint.setFlags(taint.indexX, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oTAY(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oTAY(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	indexY = accumulator;
 	calculateFlag(indexY, F::Zero, F::Negative);
+	taint.indexY = taint.accumulator;
+	taint.setFlags(taint.indexY, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oTSX(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oTSX(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	indexX = stack;
 	calculateFlag(indexX, F::Zero, F::Negative);
+	taint.indexX = {};
+	taint.setFlags({}, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oTXA(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oTXA(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	accumulator = indexX;
 	calculateFlag(accumulator, F::Zero, F::Negative);
+	taint.accumulator = taint.indexX;
+	taint.setFlags(taint.accumulator, F::Zero, F::Negative);
 }
 
-constexpr void CPU::oTXS(ValueStore) noexcept {
+template <class Taint> constexpr void CPU::oTXS(ValueStore, Taint &) noexcept {
 	cycle++;
 	stack = indexX;
 }
 
-constexpr void CPU::oTYA(ValueStore) noexcept {
+template <class Taint>
+constexpr void CPU::oTYA(ValueStore, Taint &taint) noexcept {
 	cycle++;
 	accumulator = indexY;
 	calculateFlag(accumulator, F::Zero, F::Negative);
+	taint.accumulator = taint.indexY;
+	taint.setFlags(taint.accumulator, F::Zero, F::Negative);
 }
 
-constexpr auto CPU::getInstructionType(Instruction::Function f)
+template <class Taint>
+constexpr auto
+CPU::getInstructionType(typename Instruction<Taint>::Function f)
     -> InstructionType {
 	using C = CPU;
 	using T = InstructionType;
-	const auto map = std::to_array<std::pair<Instruction::Function, T>>({
-	    {&C::oLDA, T::Read},
-	    {&C::oLDX, T::Read},
-	    {&C::oLDY, T::Read},
-	    {&C::oEOR, T::Read},
-	    {&C::oAND, T::Read},
-	    {&C::oORA, T::Read},
-	    {&C::oADC, T::Read},
-	    {&C::oSBC, T::Read},
-	    {&C::oCMP, T::Read},
-	    {&C::oBIT, T::Read},
-	    {&C::oNOP, T::Read},
-
-	    {&C::oASL, T::ReadModifyWrite},
-	    {&C::oLSR, T::ReadModifyWrite},
-	    {&C::oROL, T::ReadModifyWrite},
-	    {&C::oROR, T::ReadModifyWrite},
-	    {&C::oINC, T::ReadModifyWrite},
-	    {&C::oDEC, T::ReadModifyWrite},
-
-	    {&C::oSTA, T::Write},
-	    {&C::oSTX, T::Write},
-	    {&C::oSTY, T::Write},
+	using Function = typename Instruction<Taint>::Function;
+	const auto map = std::to_array<std::pair<Function, T>>({
+	    {&C::oLDA<Taint>, T::Read},
+	    {&C::oLDX<Taint>, T::Read},
+	    {&C::oLDY<Taint>, T::Read},
+	    {&C::oEOR<Taint>, T::Read},
+	    {&C::oAND<Taint>, T::Read},
+	    {&C::oORA<Taint>, T::Read},
+	    {&C::oADC<Taint>, T::Read},
+	    {&C::oSBC<Taint>, T::Read},
+	    {&C::oCMP<Taint>, T::Read},
+	    {&C::oBIT<Taint>, T::Read},
+	    {&C::oNOP<Taint>, T::Read},
+
+	    {&C::oASL<Taint>, T::ReadModifyWrite},
+	    {&C::oLSR<Taint>, T::ReadModifyWrite},
+	    {&C::oROL<Taint>, T::ReadModifyWrite},
+	    {&C::oROR<Taint>, T::ReadModifyWrite},
+	    {&C::oINC<Taint>, T::ReadModifyWrite},
+	    {&C::oDEC<Taint>, T::ReadModifyWrite},
+
+	    {&C::oSTA<Taint>, T::Write},
+	    {&C::oSTX<Taint>, T::Write},
+	    {&C::oSTY<Taint>, T::Write},
 	});
 
 	const auto *res = std::find_if(map.begin(), map.end(),
@@ -692,85 +1119,141 @@ constexpr auto CPU::getInstructionType(Instruction::Function f)
 	return (res != map.end()) ? res->second : InstructionType::Other;
 }
 
-constexpr auto CPU::getInstructions() -> Instructions {
+template <class T>
+constexpr auto CPU::getFunction(Mnemonic mnemonic) ->
+    typename Instruction<T>::Function {
 	using C = CPU;
-	using M = AddressMode;
-
-	return {{
-	    // clang-format off
-		{&C::oBRK         }, {&C::oORA, M::IndX}, {                 }, {},
-		{                 }, {&C::oORA, M::Zpg }, {&C::oASL, M::Zpg }, {},
-		{&C::oPHP         }, {&C::oORA, M::Imm }, {&C::oASL, M::A   }, {},
-		{                 }, {&C::oORA, M::Abs }, {&C::oASL, M::Abs }, {},
-		{&C::oBPL, M::Rel }, {&C::oORA, M::IndY}, {                 }, {},
-		{                 }, {&C::oORA, M::ZpgX}, {&C::oASL, M::ZpgX}, {},
-		{&C::oCLC         }, {&C::oORA, M::AbsY}, {                 }, {},
-		{                 }, {&C::oORA, M::AbsX}, {&C::oASL, M::AbsX}, {},
-
-		{&C::oJSR, M::Abs }, {&C::oAND, M::IndX}, {                 }, {},
-		{&C::oBIT, M::Zpg }, {&C::oAND, M::Zpg }, {&C::oROL, M::Zpg }, {},
-		{&C::oPLP         }, {&C::oAND, M::Imm }, {&C::oROL, M::A   }, {},
-		{&C::oBIT, M::Abs }, {&C::oAND, M::Abs }, {&C::oROL, M::Abs }, {},
-		{&C::oBMI, M::Rel }, {&C::oAND, M::IndY}, {                 }, {},
-		{                 }, {&C::oAND, M::ZpgX}, {&C::oROL, M::ZpgX}, {},
-		{&C::oSEC         }, {&C::oAND, M::AbsY}, {                 }, {},
-		{                 }, {&C::oAND, M::AbsX}, {&C::oROL, M::AbsX}, {},
-
-		{&C::oRTI         }, {&C::oEOR, M::IndX}, {                 }, {},
-		{                 }, {&C::oEOR, M::Zpg }, {&C::oLSR, M::Zpg }, {},
-		{&C::oPHA         }, {&C::oEOR, M::Imm }, {&C::oLSR, M::A   }, {},
-		{&C::oJMP, M::Abs }, {&C::oEOR, M::Abs }, {&C::oLSR, M::Abs }, {},
-		{&C::oBVC, M::Rel }, {&C::oEOR, M::IndY}, {                 }, {},
-		{                 }, {&C::oEOR, M::ZpgX}, {&C::oLSR, M::ZpgX}, {},
-		{&C::oCLI         }, {&C::oEOR, M::AbsY}, {                 }, {},
-		{                 }, {&C::oEOR, M::AbsX}, {&C::oLSR, M::AbsX}, {},
-
-		{&C::oRTS         }, {&C::oADC, M::IndX}, {                 }, {},
-		{                 }, {&C::oADC, M::Zpg }, {&C::oROR, M::Zpg }, {},
-		{&C::oPLA         }, {&C::oADC, M::Imm }, {&C::oROR, M::A   }, {},
-		{&C::oJMP, M::Ind }, {&C::oADC, M::Abs }, {&C::oROR, M::Abs }, {},
-		{&C::oBVS, M::Rel }, {&C::oADC, M::IndY}, {                 }, {},
-		{                 }, {&C::oADC, M::ZpgX}, {&C::oROR, M::ZpgX}, {},
-		{&C::oSEI         }, {&C::oADC, M::AbsY}, {                 }, {},
-		{                 }, {&C::oADC, M::AbsX}, {&C::oROR, M::AbsX}, {},
-
-		{                 }, {&C::oSTA, M::IndX}, {                 }, {},
-		{&C::oSTY, M::Zpg }, {&C::oSTA, M::Zpg }, {&C::oSTX, M::Zpg }, {},
-		{&C::oDEY         }, {                 }, {&C::oTXA         }, {},
-		{&C::oSTY, M::Abs }, {&C::oSTA, M::Abs }, {&C::oSTX, M::Abs }, {},
-		{&C::oBCC, M::Rel }, {&C::oSTA, M::IndY}, {                 }, {},
-		{&C::oSTY, M::ZpgX}, {&C::oSTA, M::ZpgX}, {&C::oSTX, M::ZpgY}, {},
-		{&C::oTYA         }, {&C::oSTA, M::AbsY}, {&C::oTXS         }, {},
-		{                 }, {&C::oSTA, M::AbsX}, {                 }, {},
-
-		{&C::oLDY, M::Imm }, {&C::oLDA, M::IndX}, {&C::oLDX, M::Imm }, {},
-		{&C::oLDY, M::Zpg }, {&C::oLDA, M::Zpg }, {&C::oLDX, M::Zpg }, {},
-		{&C::oTAY         }, {&C::oLDA, M::Imm }, {&C::oTAX         }, {},
-		{&C::oLDY, M::Abs }, {&C::oLDA, M::Abs }, {&C::oLDX, M::Abs }, {},
-		{&C::oBCS, M::Rel }, {&C::oLDA, M::IndY}, {                 }, {},
-		{&C::oLDY, M::ZpgX}, {&C::oLDA, M::ZpgX}, {&C::oLDX, M::ZpgY}, {},
-		{&C::oCLV         }, {&C::oLDA, M::AbsY}, {&C::oTSX         }, {},
-		{&C::oLDY, M::AbsX}, {&C::oLDA, M::AbsX}, {&C::oLDX, M::AbsY}, {},
-
-		{&C::oCPY, M::Imm }, {&C::oCMP, M::IndX}, {                 }, {},
-		{&C::oCPY, M::Zpg }, {&C::oCMP, M::Zpg }, {&C::oDEC, M::Zpg }, {},
-		{&C::oINY         }, {&C::oCMP, M::Imm }, {&C::oDEX         }, {},
-		{&C::oCPY, M::Abs }, {&C::oCMP, M::Abs }, {&C::oDEC, M::Abs }, {},
-		{&C::oBNE, M::Rel }, {&C::oCMP, M::IndY}, {                 }, {},
-		{                 }, {&C::oCMP, M::ZpgX}, {&C::oDEC, M::ZpgX}, {},
-		{&C::oCLD         }, {&C::oCMP, M::AbsY}, {                 }, {},
-		{                 }, {&C::oCMP, M::AbsX}, {&C::oDEC, M::AbsX}, {},
-
-		{&C::oCPX, M::Imm }, {&C::oSBC, M::IndX}, {                 }, {},
-		{&C::oCPX, M::Zpg }, {&C::oSBC, M::Zpg }, {&C::oINC, M::Zpg }, {},
-		{&C::oINX         }, {&C::oSBC, M::Imm }, {&C::oNOP         }, {},
-		{&C::oCPX, M::Abs }, {&C::oSBC, M::Abs }, {&C::oINC, M::Abs }, {},
-		{&C::oBEQ, M::Rel }, {&C::oSBC, M::IndY}, {                 }, {},
-		{                 }, {&C::oSBC, M::ZpgX}, {&C::oINC, M::ZpgX}, {},
-		{&C::oSED         }, {&C::oSBC, M::AbsY}, {                 }, {},
-		{                 }, {&C::oSBC, M::AbsX}, {&C::oINC, M::AbsX}, {},
-	    // clang-format on
-	}};
+	using M = Mnemonic;
+
+	switch (mnemonic) {
+	case M::ADC:
+		return &C::oADC<T>;
+	case M::AND:
+		return &C::oAND<T>;
+	case M::ASL:
+		return &C::oASL<T>;
+	case M::BCC:
+		return &C::oBCC<T>;
+	case M::BCS:
+		return &C::oBCS<T>;
+	case M::BEQ:
+		return &C::oBEQ<T>;
+	case M::BIT:
+		return &C::oBIT<T>;
+	case M::BMI:
+		return &C::oBMI<T>;
+	case M::BNE:
+		return &C::oBNE<T>;
+	case M::BPL:
+		return &C::oBPL<T>;
+	case M::BRK:
+		return &C::oBRK<T>;
+	case M::BVC:
+		return &C::oBVC<T>;
+	case M::BVS:
+		return &C::oBVS<T>;
+	case M::CLC:
+		return &C::oCLC<T>;
+	case M::CLD:
+		return &C::oCLD<T>;
+	case M::CLI:
+		return &C::oCLI<T>;
+	case M::CLV:
+		return &C::oCLV<T>;
+	case M::CMP:
+		return &C::oCMP<T>;
+	case M::CPX:
+		return &C::oCPX<T>;
+	case M::CPY:
+		return &C::oCPY<T>;
+	case M::DEC:
+		return &C::oDEC<T>;
+	case M::DEX:
+		return &C::oDEX<T>;
+	case M::DEY:
+		return &C::oDEY<T>;
+	case M::EOR:
+		return &C::oEOR<T>;
+	case M::INC:
+		return &C::oINC<T>;
+	case M::INX:
+		return &C::oINX<T>;
+	case M::INY:
+		return &C::oINY<T>;
+	case M::JMP:
+		return &C::oJMP<T>;
+	case M::JSR:
+		return &C::oJSR<T>;
+	case M::LDA:
+		return &C::oLDA<T>;
+	case M::LDX:
+		return &C::oLDX<T>;
+	case M::LDY:
+		return &C::oLDY<T>;
+	case M::LSR:
+		return &C::oLSR<T>;
+	case M::NOP:
+		return &C::oNOP<T>;
+	case M::ORA:
+		return &C::oORA<T>;
+	case M::PHA:
+		return &C::oPHA<T>;
+	case M::PHP:
+		return &C::oPHP<T>;
+	case M::PLA:
+		return &C::oPLA<T>;
+	case M::PLP:
+		return &C::oPLP<T>;
+	case M::ROL:
+		return &C::oROL<T>;
+	case M::ROR:
+		return &C::oROR<T>;
+	case M::RTI:
+		return &C::oRTI<T>;
+	case M::RTS:
+		return &C::oRTS<T>;
+	case M::SBC:
+		return &C::oSBC<T>;
+	case M::SEC:
+		return &C::oSEC<T>;
+	case M::SED:
+		return &C::oSED<T>;
+	case M::SEI:
+		return &C::oSEI<T>;
+	case M::STA:
+		return &C::oSTA<T>;
+	case M::STX:
+		return &C::oSTX<T>;
+	case M::STY:
+		return &C::oSTY<T>;
+	case M::TAX:
+		return &C::oTAX<T>;
+	case M::TAY:
+		return &C::oTAY<T>;
+	case M::TSX:
+		return &C::oTSX<T>;
+	case M::TXA:
+		return &C::oTXA<T>;
+	case M::TXS:
+		return &C::oTXS<T>;
+	case M::TYA:
+		return &C::oTYA<T>;
+	case M::None:
+		break;
+	}
+
+	return nullptr;
+}
+
+template <class T>
+constexpr auto CPU::getInstructions() -> Instructions<T> {
+	Instructions<T> instructions{};
+	for (auto i = size_t{0}; i < instructions.size(); i++) {
+		const auto [mnemonic, mode] = opcodes.at(i);
+		instructions.at(i) = {getFunction<T>(mnemonic), mode};
+	}
+
+	return instructions;
 }
 
 } // namespace microlator
@@ -4,10 +4,15 @@
 #include <cstdint>
 #include <functional>
 #include <span>
+#include <vector>
 
 namespace microlator {
 
 class CPU;
+class Device;
+class WriteWatcher;
+struct NoTaint;
+struct TaintState;
 
 enum class AddressMode {
 	// clang-format off
@@ -74,6 +79,7 @@ public:
 	[[nodiscard]] constexpr auto read() const noexcept -> uint16_t;
 	constexpr void write(uint8_t) noexcept;
 	[[nodiscard]] constexpr auto get() const noexcept -> uint16_t;
+	[[nodiscard]] constexpr auto getType() const noexcept -> Type;
 
 private:
 	const uint16_t value;
@@ -83,20 +89,177 @@ private:
 
 enum class InstructionType : uint8_t { Read, ReadModifyWrite, Write, Other };
 
-struct Instruction {
-	using Function = void (CPU::*)(ValueStore);
+template <class Taint = NoTaint> struct Instruction {
+	using Function = void (CPU::*)(ValueStore, Taint &);
 	Function function = nullptr;
 	AddressMode addressMode = AddressMode::Implicit;
 };
 
+enum class Mnemonic : uint8_t {
+	// clang-format off
+	ADC, AND, ASL, BCC, BCS, BEQ, BIT, BMI, BNE, BPL, BRK, BVC, BVS, CLC,
+	CLD, CLI, CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR, INC, INX, INY, JMP,
+	JSR, LDA, LDX, LDY, LSR, NOP, ORA, PHA, PHP, PLA, PLP, ROL, ROR, RTI,
+	RTS, SBC, SEC, SED, SEI, STA, STX, STY, TAX, TAY, TSX, TXA, TXS, TYA,
+	// clang-format on
+	// An opcode with no implemented instruction
+	None,
+};
+
+struct Opcode {
+	Mnemonic mnemonic{Mnemonic::None};
+	AddressMode addressMode{AddressMode::Implicit};
+};
+
+// The instruction and addressing mode of each opcode, shared by the CPU and
+// the assembler
+constexpr auto opcodes = [] {
+	using M = Mnemonic;
+	using A = AddressMode;
+
+	return std::to_array<Opcode>({
+	    // clang-format off
+		{M::BRK         }, {M::ORA, A::IndX}, {               }, {},
+		{               }, {M::ORA, A::Zpg }, {M::ASL, A::Zpg }, {},
+		{M::PHP         }, {M::ORA, A::Imm }, {M::ASL, A::A   }, {},
+		{               }, {M::ORA, A::Abs }, {M::ASL, A::Abs }, {},
+		{M::BPL, A::Rel }, {M::ORA, A::IndY}, {               }, {},
+		{               }, {M::ORA, A::ZpgX}, {M::ASL, A::ZpgX}, {},
+		{M::CLC         }, {M::ORA, A::AbsY}, {               }, {},
+		{               }, {M::ORA, A::AbsX}, {M::ASL, A::AbsX}, {},
+
+		{M::JSR, A::Abs }, {M::AND, A::IndX}, {               }, {},
+		{M::BIT, A::Zpg }, {M::AND, A::Zpg }, {M::ROL, A::Zpg }, {},
+		{M::PLP         }, {M::AND, A::Imm }, {M::ROL, A::A   }, {},
+		{M::BIT, A::Abs }, {M::AND, A::Abs }, {M::ROL, A::Abs }, {},
+		{M::BMI, A::Rel }, {M::AND, A::IndY}, {               }, {},
+		{               }, {M::AND, A::ZpgX}, {M::ROL, A::ZpgX}, {},
+		{M::SEC         }, {M::AND, A::AbsY}, {               }, {},
+		{               }, {M::AND, A::AbsX}, {M::ROL, A::AbsX}, {},
+
+		{M::RTI         }, {M::EOR, A::IndX}, {               }, {},
+		{               }, {M::EOR, A::Zpg }, {M::LSR, A::Zpg }, {},
+		{M::PHA         }, {M::EOR, A::Imm }, {M::LSR, A::A   }, {},
+		{M::JMP, A::Abs }, {M::EOR, A::Abs }, {M::LSR, A::Abs }, {},
+		{M::BVC, A::Rel }, {M::EOR, A::IndY}, {               }, {},
+		{               }, {M::EOR, A::ZpgX}, {M::LSR, A::ZpgX}, {},
+		{M::CLI         }, {M::EOR, A::AbsY}, {               }, {},
+		{               }, {M::EOR, A::AbsX}, {M::LSR, A::AbsX}, {},
+
+		{M::RTS         }, {M::ADC, A::IndX}, {               }, {},
+		{               }, {M::ADC, A::Zpg }, {M::ROR, A::Zpg }, {},
+		{M::PLA         }, {M::ADC, A::Imm }, {M::ROR, A::A   }, {},
+		{M::JMP, A::Ind }, {M::ADC, A::Abs }, {M::ROR, A::Abs }, {},
+		{M::BVS, A::Rel }, {M::ADC, A::IndY}, {               }, {},
+		{               }, {M::ADC, A::ZpgX}, {M::ROR, A::ZpgX}, {},
+		{M::SEI         }, {M::ADC, A::AbsY}, {               }, {},
+		{               }, {M::ADC, A::AbsX}, {M::ROR, A::AbsX}, {},
+
+		{               }, {M::STA, A::IndX}, {               }, {},
+		{M::STY, A::Zpg }, {M::STA, A::Zpg }, {M::STX, A::Zpg }, {},
+		{M::DEY         }, {               }, {M::TXA         }, {},
+		{M::STY, A::Abs }, {M::STA, A::Abs }, {M::STX, A::Abs }, {},
+		{M::BCC, A::Rel }, {M::STA, A::IndY}, {               }, {},
+		{M::STY, A::ZpgX}, {M::STA, A::ZpgX}, {M::STX, A::ZpgY}, {},
+		{M::TYA         }, {M::STA, A::AbsY}, {M::TXS         }, {},
+		{               }, {M::STA, A::AbsX}, {               }, {},
+
+		{M::LDY, A::Imm }, {M::LDA, A::IndX}, {M::LDX, A::Imm }, {},
+		{M::LDY, A::Zpg }, {M::LDA, A::Zpg }, {M::LDX, A::Zpg }, {},
+		{M::TAY         }, {M::LDA, A::Imm }, {M::TAX         }, {},
+		{M::LDY, A::Abs }, {M::LDA, A::Abs }, {M::LDX, A::Abs }, {},
+		{M::BCS, A::Rel }, {M::LDA, A::IndY}, {               }, {},
+		{M::LDY, A::ZpgX}, {M::LDA, A::ZpgX}, {M::LDX, A::ZpgY}, {},
+		{M::CLV         }, {M::LDA, A::AbsY}, {M::TSX         }, {},
+		{M::LDY, A::AbsX}, {M::LDA, A::AbsX}, {M::LDX, A::AbsY}, {},
+
+		{M::CPY, A::Imm }, {M::CMP, A::IndX}, {               }, {},
+		{M::CPY, A::Zpg }, {M::CMP, A::Zpg }, {M::DEC, A::Zpg }, {},
+		{M::INY         }, {M::CMP, A::Imm }, {M::DEX         }, {},
+		{M::CPY, A::Abs }, {M::CMP, A::Abs }, {M::DEC, A::Abs }, {},
+		{M::BNE, A::Rel }, {M::CMP, A::IndY}, {               }, {},
+		{               }, {M::CMP, A::ZpgX}, {M::DEC, A::ZpgX}, {},
+		{M::CLD         }, {M::CMP, A::AbsY}, {               }, {},
+		{               }, {M::CMP, A::AbsX}, {M::DEC, A::AbsX}, {},
+
+		{M::CPX, A::Imm }, {M::SBC, A::IndX}, {               }, {},
+		{M::CPX, A::Zpg }, {M::SBC, A::Zpg }, {M::INC, A::Zpg }, {},
+		{M::INX         }, {M::SBC, A::Imm }, {M::NOP         }, {},
+		{M::CPX, A::Abs }, {M::SBC, A::Abs }, {M::INC, A::Abs }, {},
+		{M::BEQ, A::Rel }, {M::SBC, A::IndY}, {               }, {},
+		{               }, {M::SBC, A::ZpgX}, {M::INC, A::ZpgX}, {},
+		{M::SED         }, {M::SBC, A::AbsY}, {               }, {},
+		{               }, {M::SBC, A::AbsX}, {M::INC, A::AbsX}, {},
+	    // clang-format on
+	});
+}();
+
+// Bytes following the opcode of an instruction using the addressing mode
+constexpr auto operandLength(AddressMode mode) noexcept -> uint8_t;
+
+// Flags an instruction reads, or may write, as bitmasks
+constexpr auto flagsRead(Mnemonic mnemonic) noexcept -> uint8_t;
+constexpr auto flagsWritten(Mnemonic mnemonic) noexcept -> uint8_t;
+
+// An instruction decoded from memory ahead of being executed, e.g. so that it
+// can be executed repeatedly without being fetched each time
+struct DecodedInstruction {
+	Instruction<>::Function function{nullptr};
+	Mnemonic mnemonic{Mnemonic::None};
+	AddressMode addressMode{AddressMode::Implicit};
+	InstructionType type{InstructionType::Other};
+	// Length in bytes, including the opcode
+	uint8_t length{1};
+	uint16_t operand{0};
+	// Cycles spent indexing an address which has been folded into operand
+	uint8_t extraCycles{0};
+};
+
+#ifdef MICROLATOR_LAST_WRITER
+// Identifies the instruction which most recently wrote to an address, by the
+// address of its opcode and the cycle at which it began
+struct LastWriter {
+	uint16_t pc{0};
+	uint64_t cycle{0};
+
+	constexpr auto operator==(const LastWriter &rhs) const noexcept
+	    -> bool = default;
+};
+#endif
+
 class CPU {
 public:
-	constexpr void reset();
+	void reset();
 	// TODO: loadProgram should be constexpr, but GCC says "inline function
 	// [...] used but never defined" if it is declared constexpr
 	void loadProgram(std::span<const uint8_t> program, uint16_t offset);
 	void loadProgram(std::span<const uint8_t> program);
+	// Copy data into memory from address in one operation, as direct memory
+	// access would, bypassing devices but notifying watchers
+	void store(uint16_t address, std::span<const uint8_t> data);
 	auto step() noexcept -> bool;
+	// Execute an instruction, propagating taint labels through taint
+	auto step(TaintState &taint) noexcept -> bool;
+	// Execute instructions until cycle reaches untilCycle. Returns false if
+	// an unimplemented instruction was reached first
+	auto run(uint64_t untilCycle) noexcept -> bool;
+
+	// Decode the instruction at address from memory, without counting
+	// cycles or accessing devices
+	[[nodiscard]] auto decode(uint16_t address) const noexcept
+	    -> DecodedInstruction;
+	// Execute an instruction decoded from the address in pc, as step()
+	// would but without fetching it. Flags outside liveFlags may be left
+	// unchanged where the instruction would have set them, for when they
+	// are known to be overwritten before being read
+	void execute(const DecodedInstruction &instruction,
+		     uint8_t liveFlags = allFlags) noexcept;
+
+	// Service a non-maskable interrupt through the vector at $FFFA
+	void nmi() noexcept;
+	// Service an interrupt request through the vector at $FFFE, unless
+	// interrupts are disabled. Returns whether it was serviced
+	auto irq() noexcept -> bool;
 
 	// Registers
 	uint8_t accumulator{0};
@@ -111,30 +274,98 @@ public:
 	using Memory = std::array<uint8_t, memorySize>;
 	Memory memory{};
 
+	// Memory-mapped I/O is handled by devices, each mapped to whole pages.
+	// Copies of a CPU share its devices
+	constexpr static auto pageSize = 0x100U;
+	constexpr static auto pageCount = memorySize / pageSize;
+	void map(Device &device, uint8_t firstPage, uint8_t lastPage);
+	void unmap(uint8_t firstPage, uint8_t lastPage);
+	[[nodiscard]] auto mapped(uint16_t address) const noexcept -> bool;
+	// Writes to read-only pages, e.g. holding ROM, take their cycle but are
+	// otherwise ignored, by devices and watchers too
+	void protect(uint8_t firstPage, uint8_t lastPage);
+	void unprotect(uint8_t firstPage, uint8_t lastPage);
+	[[nodiscard]] auto readOnly(uint16_t address) const noexcept -> bool;
+
+	// Watchers are notified before the CPU writes to the pages they watch,
+	// e.g. to discard code translated from them. Watchers watch the memory
+	// of one CPU, so unlike devices they aren't copied with it, and a CPU
+	// assigned to keeps its own
+	void watch(WriteWatcher &watcher, uint8_t firstPage, uint8_t lastPage);
+	void unwatch(uint8_t firstPage, uint8_t lastPage);
+	// Notify watchers that every address in the pages changed other than
+	// by the CPU writing to it, e.g. by a device being mapped over them
+	void notifyWatchers(uint8_t firstPage, uint8_t lastPage);
+
+	constexpr static auto allFlags = uint8_t{0xff};
+
 	mutable uint64_t cycle{0};
 
+#ifdef MICROLATOR_LAST_WRITER
+	// Shadow memory recording the last instruction to write each address.
+	// Kept out of line, as it is far larger than the rest of the CPU
+	using LastWriters = std::vector<LastWriter>;
+	LastWriters lastWriters = LastWriters(memorySize);
+#endif
+
 	constexpr void push(uint16_t) = delete;
 	constexpr void push2(uint8_t) = delete;
 
 private:
 	constexpr static auto stackTop = 0x100;
+	constexpr static auto nmiVector = 0xfffa;
+	constexpr static auto irqVector = 0xfffe;
 	constexpr static auto initialStackPointer = 0xfd;
 	constexpr static auto initialProgramCounter = 0x600;
 
 	bool indirectJumpBug = true;
 
-	// Instruction lookup table
-	using Instructions = std::array<Instruction, 256>;
-	constexpr static auto getInstructions() -> Instructions;
+	std::array<Device *, pageCount> devices{};
+	std::array<bool, pageCount> readOnlyPages{};
+	struct Watchers {
+		Watchers() = default;
+		Watchers(const Watchers &) noexcept {}
+		auto operator=(const Watchers &) noexcept -> Watchers & {
+			return *this;
+		}
+		~Watchers() = default;
+
+		std::array<WriteWatcher *, pageCount> pages{};
+	};
+	Watchers watchers;
 
-	constexpr static auto getInstructionType(Instruction::Function f)
+#ifdef MICROLATOR_LAST_WRITER
+	// The instruction currently being executed
+	LastWriter writer;
+#endif
+
+	// Instruction lookup table
+	template <class Taint>
+	using Instructions = std::array<Instruction<Taint>, 256>;
+	template <class Taint>
+	constexpr static auto getInstructions() -> Instructions<Taint>;
+
+	template <class Taint>
+	constexpr static auto
+	getInstructionType(typename Instruction<Taint>::Function f)
 	    -> InstructionType;
 
+	template <class Taint>
+	constexpr static auto getFunction(Mnemonic mnemonic) ->
+	    typename Instruction<Taint>::Function;
+
+	template <class Taint> auto execute(Taint &taint) noexcept -> bool;
+	constexpr auto executeWithoutFlags(Mnemonic mnemonic,
+					   ValueStore target) noexcept -> bool;
+
 	// Instruction helpers
 	constexpr auto
 	getTarget(AddressMode mode,
 		  InstructionType type = InstructionType::Other) noexcept
 	    -> ValueStore;
+	constexpr auto fetchOperand(AddressMode mode) noexcept -> uint16_t;
+	constexpr auto resolveTarget(AddressMode mode, InstructionType type,
+				     uint16_t operand) noexcept -> ValueStore;
 	constexpr auto read(uint16_t address) const noexcept -> uint8_t;
 	[[nodiscard]] constexpr auto
 	read2(uint16_t address, bool wrapToPage = false) const noexcept
@@ -149,6 +380,7 @@ private:
 	constexpr auto pop2(bool preIncrement = false) noexcept -> uint16_t;
 	constexpr void popFlags(bool preIncrement = false) noexcept;
 	constexpr void branch(uint16_t, bool useCycle = true) noexcept;
+	constexpr void interrupt(uint16_t vector) noexcept;
 
 	template <class T, class... Args>
 	constexpr void calculateFlag(uint8_t value, T flag, Args... flags);
@@ -157,62 +389,62 @@ private:
 	constexpr void addWithCarry(uint8_t value) noexcept;
 
 	// Instructions
-	constexpr void oADC(ValueStore) noexcept;
-	constexpr void oAND(ValueStore) noexcept;
-	constexpr void oASL(ValueStore) noexcept;
-	constexpr void oBCC(ValueStore) noexcept;
-	constexpr void oBCS(ValueStore) noexcept;
-	constexpr void oBEQ(ValueStore) noexcept;
-	constexpr void oBIT(ValueStore) noexcept;
-	constexpr void oBMI(ValueStore) noexcept;
-	constexpr void oBNE(ValueStore) noexcept;
-	constexpr void oBPL(ValueStore) noexcept;
-	constexpr void oBRK(ValueStore) noexcept;
-	constexpr void oBVC(ValueStore) noexcept;
-	constexpr void oBVS(ValueStore) noexcept;
-	constexpr void oCLC(ValueStore) noexcept;
-	constexpr void oCLD(ValueStore) noexcept;
-	constexpr void oCLI(ValueStore) noexcept;
-	constexpr void oCLV(ValueStore) noexcept;
-	constexpr void oCMP(ValueStore) noexcept;
-	constexpr void oCPX(ValueStore) noexcept;
-	constexpr void oCPY(ValueStore) noexcept;
-	constexpr void oDEC(ValueStore) noexcept;
-	constexpr void oDEX(ValueStore) noexcept;
-	constexpr void oDEY(ValueStore) noexcept;
-	constexpr void oEOR(ValueStore) noexcept;
-	constexpr void oINC(ValueStore) noexcept;
-	constexpr void oINX(ValueStore) noexcept;
-	constexpr void oINY(ValueStore) noexcept;
-	constexpr void oJMP(ValueStore) noexcept;
-	constexpr void oJSR(ValueStore) noexcept;
-	constexpr void oLDA(ValueStore) noexcept;
-	constexpr void oLDX(ValueStore) noexcept;
-	constexpr void oLDY(ValueStore) noexcept;
-	constexpr void oLSR(ValueStore) noexcept;
-	constexpr void oNOP(ValueStore) noexcept;
-	constexpr void oORA(ValueStore) noexcept;
-	constexpr void oPHA(ValueStore) noexcept;
-	constexpr void oPHP(ValueStore) noexcept;
-	constexpr void oPLA(ValueStore) noexcept;
-	constexpr void oPLP(ValueStore) noexcept;
-	constexpr void oROL(ValueStore) noexcept;
-	constexpr void oROR(ValueStore) noexcept;
-	constexpr void oRTI(ValueStore) noexcept;
-	constexpr void oRTS(ValueStore) noexcept;
-	constexpr void oSBC(ValueStore) noexcept;
-	constexpr void oSEC(ValueStore) noexcept;
-	constexpr void oSED(ValueStore) noexcept;
-	constexpr void oSEI(ValueStore) noexcept;
-	constexpr void oSTA(ValueStore) noexcept;
-	constexpr void oSTX(ValueStore) noexcept;
-	constexpr void oSTY(ValueStore) noexcept;
-	constexpr void oTAX(ValueStore) noexcept;
-	constexpr void oTAY(ValueStore) noexcept;
-	constexpr void oTSX(ValueStore) noexcept;
-	constexpr void oTXA(ValueStore) noexcept;
-	constexpr void oTXS(ValueStore) noexcept;
-	constexpr void oTYA(ValueStore) noexcept;
+	template <class T> constexpr void oADC(ValueStore, T &) noexcept;
+	template <class T> constexpr void oAND(ValueStore, T &) noexcept;
+	template <class T> constexpr void oASL(ValueStore, T &) noexcept;
+	template <class T> constexpr void oBCC(ValueStore, T &) noexcept;
+	template <class T> constexpr void oBCS(ValueStore, T &) noexcept;
+	template <class T> constexpr void oBEQ(ValueStore, T &) noexcept;
+	template <class T> constexpr void oBIT(ValueStore, T &) noexcept;
+	template <class T> constexpr void oBMI(ValueStore, T &) noexcept;
+	template <class T> constexpr void oBNE(ValueStore, T &) noexcept;
+	template <class T> constexpr void oBPL(ValueStore, T &) noexcept;
+	template <class T> constexpr void oBRK(ValueStore, T &) noexcept;
+	template <class T> constexpr void oBVC(ValueStore, T &) noexcept;
+	template <class T> constexpr void oBVS(ValueStore, T &) noexcept;
+	template <class T> constexpr void oCLC(ValueStore, T &) noexcept;
+	template <class T> constexpr void oCLD(ValueStore, T &) noexcept;
+	template <class T> constexpr void oCLI(ValueStore, T &) noexcept;
+	template <class T> constexpr void oCLV(ValueStore, T &) noexcept;
+	template <class T> constexpr void oCMP(ValueStore, T &) noexcept;
+	template <class T> constexpr void oCPX(ValueStore, T &) noexcept;
+	template <class T> constexpr void oCPY(ValueStore, T &) noexcept;
+	template <class T> constexpr void oDEC(ValueStore, T &) noexcept;
+	template <class T> constexpr void oDEX(ValueStore, T &) noexcept;
+	template <class T> constexpr void oDEY(ValueStore, T &) noexcept;
+	template <class T> constexpr void oEOR(ValueStore, T &) noexcept;
+	template <class T> constexpr void oINC(ValueStore, T &) noexcept;
+	template <class T> constexpr void oINX(ValueStore, T &) noexcept;
+	template <class T> constexpr void oINY(ValueStore, T &) noexcept;
+	template <class T> constexpr void oJMP(ValueStore, T &) noexcept;
+	template <class T> constexpr void oJSR(ValueStore, T &) noexcept;
+	template <class T> constexpr void oLDA(ValueStore, T &) noexcept;
+	template <class T> constexpr void oLDX(ValueStore, T &) noexcept;
+	template <class T> constexpr void oLDY(ValueStore, T &) noexcept;
+	template <class T> constexpr void oLSR(ValueStore, T &) noexcept;
+	template <class T> constexpr void oNOP(ValueStore, T &) noexcept;
+	template <class T> constexpr void oORA(ValueStore, T &) noexcept;
+	template <class T> constexpr void oPHA(ValueStore, T &) noexcept;
+	template <class T> constexpr void oPHP(ValueStore, T &) noexcept;
+	template <class T> constexpr void oPLA(ValueStore, T &) noexcept;
+	template <class T> constexpr void oPLP(ValueStore, T &) noexcept;
+	template <class T> constexpr void oROL(ValueStore, T &) noexcept;
+	template <class T> constexpr void oROR(ValueStore, T &) noexcept;
+	template <class T> constexpr void oRTI(ValueStore, T &) noexcept;
+	template <class T> constexpr void oRTS(ValueStore, T &) noexcept;
+	template <class T> constexpr void oSBC(ValueStore, T &) noexcept;
+	template <class T> constexpr void oSEC(ValueStore, T &) noexcept;
+	template <class T> constexpr void oSED(ValueStore, T &) noexcept;
+	template <class T> constexpr void oSEI(ValueStore, T &) noexcept;
+	template <class T> constexpr void oSTA(ValueStore, T &) noexcept;
+	template <class T> constexpr void oSTX(ValueStore, T &) noexcept;
+	template <class T> constexpr void oSTY(ValueStore, T &) noexcept;
+	template <class T> constexpr void oTAX(ValueStore, T &) noexcept;
+	template <class T> constexpr void oTAY(ValueStore, T &) noexcept;
+	template <class T> constexpr void oTSX(ValueStore, T &) noexcept;
+	template <class T> constexpr void oTXA(ValueStore, T &) noexcept;
+	template <class T> constexpr void oTXS(ValueStore, T &) noexcept;
+	template <class T> constexpr void oTYA(ValueStore, T &) noexcept;
 
 	friend class ValueStore;
 };
@@ -253,4 +485,124 @@ constexpr ValueStore::ValueStore(CPU &cpu)
 
 constexpr auto ValueStore::get() const noexcept -> uint16_t { return value; }
 
+constexpr auto ValueStore::getType() const noexcept -> Type { return type; }
+
+constexpr auto operandLength(AddressMode mode) noexcept -> uint8_t {
+	using Mode = AddressMode;
+
+	switch (mode) {
+	case Mode::Immediate:
+	case Mode::Zeropage:
+	case Mode::ZeropageX:
+	case Mode::ZeropageY:
+	case Mode::IndirectX:
+	case Mode::IndirectY:
+	case Mode::Relative:
+		return 1;
+	case Mode::Absolute:
+	case Mode::AbsoluteX:
+	case Mode::AbsoluteY:
+	case Mode::Indirect:
+		return 2;
+	case Mode::Implicit:
+	case Mode::Accumulator:
+		break;
+	}
+
+	return 0;
+}
+
+constexpr auto flagsRead(Mnemonic mnemonic) noexcept -> uint8_t {
+	using M = Mnemonic;
+	using F = Flags::Index;
+
+	switch (mnemonic) {
+	case M::ADC:
+	case M::SBC:
+		return Flags::bitmask(F::Carry) | Flags::bitmask(F::Decimal);
+	case M::ROL:
+	case M::ROR:
+	case M::BCC:
+	case M::BCS:
+		return Flags::bitmask(F::Carry);
+	case M::BEQ:
+	case M::BNE:
+		return Flags::bitmask(F::Zero);
+	case M::BMI:
+	case M::BPL:
+		return Flags::bitmask(F::Negative);
+	case M::BVC:
+	case M::BVS:
+		return Flags::bitmask(F::Overflow);
+	case M::BRK:
+	case M::PHP:
+	case M::None:
+		return CPU::allFlags;
+	default:
+		return 0;
+	}
+}
+
+constexpr auto flagsWritten(Mnemonic mnemonic) noexcept -> uint8_t {
+	using M = Mnemonic;
+	using F = Flags::Index;
+
+	constexpr auto zeroNegative =
+	    Flags::bitmask(F::Zero) | Flags::bitmask(F::Negative);
+	constexpr auto compare = zeroNegative | Flags::bitmask(F::Carry);
+
+	switch (mnemonic) {
+	case M::ADC:
+	case M::SBC:
+		return compare | Flags::bitmask(F::Overflow);
+	case M::BIT:
+		return zeroNegative | Flags::bitmask(F::Overflow);
+	case M::ASL:
+	case M::LSR:
+	case M::ROL:
+	case M::ROR:
+	case M::CMP:
+	case M::CPX:
+	case M::CPY:
+		return compare;
+	case M::AND:
+	case M::ORA:
+	case M::EOR:
+	case M::LDA:
+	case M::LDX:
+	case M::LDY:
+	case M::TAX:
+	case M::TAY:
+	case M::TXA:
+	case M::TYA:
+	case M::TSX:
+	case M::INX:
+	case M::INY:
+	case M::DEX:
+	case M::DEY:
+	case M::INC:
+	case M::DEC:
+	case M::PLA:
+		return zeroNegative;
+	case M::CLC:
+	case M::SEC:
+		return Flags::bitmask(F::Carry);
+	case M::CLD:
+	case M::SED:
+		return Flags::bitmask(F::Decimal);
+	case M::CLI:
+	case M::SEI:
+	case M::BRK:
+		return Flags::bitmask(F::InterruptOff);
+	case M::CLV:
+		return Flags::bitmask(F::Overflow);
+	case M::PLP:
+	case M::RTI:
+	case M::None:
+		return CPU::allFlags;
+	default:
+		return 0;
+	}
+}
+
 } // namespace microlator
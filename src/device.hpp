@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+namespace microlator {
+
+class CPU;
+
+// A peripheral mapped into pages of a CPU's address space with CPU::map(),
+// which handles every access to those pages in place of memory. The CPU has
+// already counted the cycle of the access when it calls the device
+class Device {
+public:
+	Device() = default;
+	Device(const Device &) = delete;
+	Device(Device &&) = delete;
+	auto operator=(const Device &) -> Device & = delete;
+	auto operator=(Device &&) -> Device & = delete;
+	virtual ~Device() = default;
+
+	virtual auto read(const CPU &cpu, uint16_t address) -> uint8_t = 0;
+	virtual void write(CPU &cpu, uint16_t address, uint8_t value) = 0;
+};
+
+// Notified before a CPU writes to pages watched with CPU::watch(), whether
+// they hold memory or a device
+class WriteWatcher {
+public:
+	WriteWatcher() = default;
+	WriteWatcher(const WriteWatcher &) = delete;
+	WriteWatcher(WriteWatcher &&) = delete;
+	auto operator=(const WriteWatcher &) -> WriteWatcher & = delete;
+	auto operator=(WriteWatcher &&) -> WriteWatcher & = delete;
+	virtual ~WriteWatcher() = default;
+
+	virtual void written(const CPU &cpu, uint16_t address) = 0;
+};
+
+} // namespace microlator
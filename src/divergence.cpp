@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "divergence.hpp"
+#include "tiered.hpp"
+
+namespace {
+
+using microlator::CPU;
+
+constexpr auto haltedHash = uint64_t{0x9e3779b97f4a7c15};
+// Limit on the number of differing memory addresses described
+constexpr auto maxDescribedAddresses = 32U;
+// Limit on the number of states kept to bisect from, which must be even
+constexpr auto maxCheckpoints = size_t{32};
+
+auto threadCount(unsigned threads) -> unsigned {
+	if (threads != 0)
+		return threads;
+
+	return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+auto sameState(const CPU &a, const CPU &b) -> bool {
+	return a.pc == b.pc && a.accumulator == b.accumulator &&
+	       a.indexX == b.indexX && a.indexY == b.indexY &&
+	       a.stack == b.stack && a.flags == b.flags &&
+	       a.cycle == b.cycle && a.memory == b.memory;
+}
+
+// The states of a CPU after an engine ran it for some instructions
+struct Probe {
+	CPU cpu;
+	bool halted{false};
+
+	[[nodiscard]] auto operator==(const Probe &rhs) const -> bool {
+		return halted == rhs.halted && sameState(cpu, rhs.cpu);
+	}
+};
+
+auto run(const microlator::Engine &engine, CPU cpu, uint64_t instructions)
+    -> Probe {
+	const auto halted = !engine(cpu, instructions);
+	return {cpu, halted};
+}
+
+// States an engine reached at the start of every stride-th interval. The
+// stride doubles whenever there are too many, so they take bounded memory
+// however long the run
+struct Checkpoints {
+	std::vector<CPU> states;
+	uint64_t stride{1};
+
+	void add(const CPU &cpu, uint64_t chunk) {
+		if (chunk % stride != 0)
+			return;
+
+		if (states.size() == maxCheckpoints) {
+			for (size_t i = 1; i < states.size() / 2; i++)
+				states[i] = std::move(states[i * 2]);
+			states.erase(states.begin() + states.size() / 2,
+				     states.end());
+			stride *= 2;
+		}
+
+		if (chunk % stride == 0)
+			states.push_back(cpu);
+	}
+};
+
+// Hashes of the states an engine reached every interval instructions,
+// optionally keeping checkpoints of some of the states the hashes were
+// taken from
+auto hashRun(const microlator::Engine &engine, CPU cpu, uint64_t instructions,
+	     uint64_t interval, Checkpoints *checkpoints)
+    -> std::vector<uint64_t> {
+	std::vector<uint64_t> hashes;
+	for (uint64_t done = 0; done < instructions; done += interval) {
+		if (checkpoints)
+			checkpoints->add(cpu, hashes.size());
+
+		const auto halted =
+		    !engine(cpu, std::min(interval, instructions - done));
+		hashes.push_back(microlator::hashState(cpu) ^
+				 (halted ? haltedHash : 0));
+		if (halted)
+			break;
+	}
+
+	return hashes;
+}
+
+} // namespace
+
+namespace microlator {
+
+auto stepEngine(CPU &cpu, uint64_t instructions) -> bool {
+	for (uint64_t i = 0; i < instructions; i++) {
+		if (!cpu.step())
+			return false;
+	}
+
+	return true;
+}
+
+auto tieredEngine(uint32_t blockThreshold, uint32_t optimizeThreshold)
+    -> Engine {
+	return [blockThreshold, optimizeThreshold](CPU &cpu,
+						   uint64_t instructions) {
+		auto engine =
+		    TieredEngine{cpu, blockThreshold, optimizeThreshold};
+		return engine.run(std::numeric_limits<uint64_t>::max(),
+				  instructions);
+	};
+}
+
+auto hashState(const CPU &cpu) noexcept -> uint64_t {
+	// FNV-1a over the registers, then 64-bit words of memory
+	constexpr auto prime = uint64_t{0x100000001b3};
+	auto hash = uint64_t{0xcbf29ce484222325};
+	const auto mix = [&](uint64_t value) {
+		hash ^= value;
+		hash *= prime;
+	};
+
+	mix(cpu.pc);
+	mix(cpu.accumulator);
+	mix(cpu.indexX);
+	mix(cpu.indexY);
+	mix(cpu.stack);
+	mix(cpu.flags.get());
+	mix(cpu.cycle);
+
+	for (size_t i = 0; i < cpu.memory.size(); i += sizeof(uint64_t)) {
+		uint64_t word = 0;
+		std::memcpy(&word, &cpu.memory[i], sizeof(word));
+		mix(word);
+	}
+
+	return hash;
+}
+
+auto findDivergence(const CPU &initial, const Engine &reference,
+		    const Engine &candidate, uint64_t instructions,
+		    uint64_t interval, unsigned threads)
+    -> std::optional<EngineDivergence> {
+	if (interval == 0)
+		throw std::invalid_argument{"Hash interval can't be 0"};
+
+	// Run both engines side by side, keeping checkpoints of the reference
+	Checkpoints checkpoints;
+	std::vector<uint64_t> referenceHashes, candidateHashes;
+	{
+		const std::jthread candidateThread{[&] {
+			candidateHashes = hashRun(candidate, initial,
+						  instructions, interval,
+						  nullptr);
+		}};
+		referenceHashes = hashRun(reference, initial, instructions,
+					  interval, &checkpoints);
+	}
+
+	const auto [referenceIt, candidateIt] =
+	    std::mismatch(referenceHashes.begin(), referenceHashes.end(),
+			  candidateHashes.begin(), candidateHashes.end());
+	if (referenceIt == referenceHashes.end() &&
+	    candidateIt == candidateHashes.end())
+		return {};
+
+	// The engines agree on the state at `start`, the last checkpoint before
+	// the first interval they disagree after, and disagree `length`
+	// instructions later
+	const auto chunk =
+	    static_cast<uint64_t>(referenceIt - referenceHashes.begin());
+	const auto checkpoint = chunk / checkpoints.stride;
+	auto start = checkpoints.states.at(checkpoint);
+	auto offset = checkpoint * checkpoints.stride * interval;
+	auto length =
+	    std::min((chunk + 1) * interval, instructions) - offset;
+
+	// Probe evenly spaced points between them on each thread, then narrow
+	// down to the gap between the last agreeing and first disagreeing
+	// probes
+	while (length > 1) {
+		const auto probes = std::min<uint64_t>(threadCount(threads),
+						       length - 1);
+		std::vector<uint64_t> points;
+		for (uint64_t i = 1; i <= probes; i++)
+			points.push_back(i * length / (probes + 1));
+		points.erase(std::unique(points.begin(), points.end()),
+			     points.end());
+
+		std::vector<Probe> results(points.size(), Probe{start});
+		// Not vector<bool>, as its elements can't be set concurrently
+		std::vector<char> agree(points.size());
+		{
+			std::vector<std::jthread> workers;
+			for (size_t i = 0; i < points.size(); i++) {
+				workers.emplace_back([&, i] {
+					results[i] =
+					    run(reference, start, points[i]);
+					agree[i] = run(candidate, start,
+						       points[i]) == results[i];
+				});
+			}
+		}
+
+		const auto first = static_cast<size_t>(
+		    std::find(agree.begin(), agree.end(), false) -
+		    agree.begin());
+		const auto end = first < points.size() ? points[first] : length;
+		const auto begin = first > 0 ? points[first - 1] : 0;
+		if (first > 0)
+			start = results[first - 1].cpu;
+
+		offset += begin;
+		length = end - begin;
+	}
+
+	auto result = EngineDivergence{offset, start, start, start};
+	result.referenceHalted = !reference(result.reference, 1);
+	result.candidateHalted = !candidate(result.candidate, 1);
+
+	return result;
+}
+
+auto operator<<(std::ostream &os, const EngineDivergence &divergence)
+    -> std::ostream & {
+	const auto flags = os.flags();
+	const auto fill = os.fill();
+	const auto &before = divergence.before;
+	const auto describe = [&](const char *name, const CPU &cpu,
+				  bool halted) {
+		os << name << ": PC:" << std::setw(4) << cpu.pc
+		   << " A:" << std::setw(2) << +cpu.accumulator
+		   << " X:" << std::setw(2) << +cpu.indexX
+		   << " Y:" << std::setw(2) << +cpu.indexY
+		   << " P:" << std::setw(2) << +cpu.flags.get()
+		   << " SP:" << std::setw(2) << +cpu.stack
+		   << " CYC:" << std::dec << cpu.cycle << std::hex
+		   << (halted ? " (halted)" : "") << '\n';
+	};
+
+	os << std::hex << std::setfill('0') << "Engines diverge at instruction "
+	   << std::dec << divergence.instruction << std::hex << '\n';
+	describe("before   ", before, false);
+	describe("reference", divergence.reference,
+		 divergence.referenceHalted);
+	describe("candidate", divergence.candidate,
+		 divergence.candidateHalted);
+
+	auto differences = 0U;
+	for (size_t i = 0; i < before.memory.size(); i++) {
+		const auto expected = divergence.reference.memory[i],
+			   actual = divergence.candidate.memory[i];
+		if (expected == actual)
+			continue;
+
+		if (differences++ < maxDescribedAddresses)
+			os << '$' << std::setw(4) << i << ": " << std::setw(2)
+			   << +expected << " != " << std::setw(2) << +actual
+			   << '\n';
+	}
+
+	if (differences > maxDescribedAddresses)
+		os << std::dec << (differences - maxDescribedAddresses)
+		   << " more differing addresses\n";
+
+	os.flags(flags);
+	os.fill(fill);
+	return os;
+}
+
+} // namespace microlator
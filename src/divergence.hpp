@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+
+#include "cpu.hpp"
+
+namespace microlator {
+
+// Advances a CPU by exactly the given number of instructions, returning
+// false if it halted on an unimplemented instruction first. findDivergence()
+// calls engines concurrently from several threads, each with a CPU of its
+// own, so they must be safe to call concurrently and must not keep state
+// shared between calls
+using Engine = std::function<bool(CPU &cpu, uint64_t instructions)>;
+
+// The reference engine, which executes each instruction with CPU::step()
+auto stepEngine(CPU &cpu, uint64_t instructions) -> bool;
+
+// An engine which executes instructions with a TieredEngine. Each call uses
+// an engine of its own, so blocks are only translated from code which is hot
+// within a call
+auto tieredEngine(uint32_t blockThreshold = 8,
+		  uint32_t optimizeThreshold = 256) -> Engine;
+
+// Hash of the registers, cycle count and memory of a CPU
+[[nodiscard]] auto hashState(const CPU &cpu) noexcept -> uint64_t;
+
+// The first instruction which two engines executed differently
+struct EngineDivergence {
+	// Number of instructions both engines executed before it
+	uint64_t instruction{0};
+	// The state both engines agreed on before executing it
+	CPU before;
+	// The states after each engine executed it
+	CPU reference;
+	CPU candidate;
+	bool referenceHalted{false};
+	bool candidateHalted{false};
+};
+
+// Run both engines from initial for up to instructions instructions, comparing
+// hashes of their states every interval instructions. If they disagree, bisect
+// in parallel between the last agreeing and first disagreeing states until
+// the diverging instruction is found. Only a bounded number of agreeing
+// states are kept, so bisection may start some intervals before the first
+// disagreement. This assumes that once the engines disagree they keep
+// disagreeing, which holds for any divergence in cycle counts
+auto findDivergence(const CPU &initial, const Engine &reference,
+		    const Engine &candidate, uint64_t instructions,
+		    uint64_t interval, unsigned threads = 0)
+    -> std::optional<EngineDivergence>;
+
+// Describe a divergence, listing the registers of both states and the memory
+// addresses whose values differ
+auto operator<<(std::ostream &os, const EngineDivergence &divergence)
+    -> std::ostream &;
+
+} // namespace microlator
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "fairshare.hpp"
+
+namespace {
+
+auto threadCount(unsigned threads) -> unsigned {
+	if (threads != 0)
+		return threads;
+
+	return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+auto saturatingMultiply(uint64_t a, uint64_t b) -> uint64_t {
+	if (a != 0 && b > std::numeric_limits<uint64_t>::max() / a)
+		return std::numeric_limits<uint64_t>::max();
+
+	return a * b;
+}
+
+} // namespace
+
+namespace microlator {
+
+FairShareScheduler::FairShareScheduler(unsigned threads,
+				       Clock::duration targetLatency)
+    : threads{threadCount(threads)}, targetLatency{targetLatency} {
+	if (targetLatency <= Clock::duration::zero())
+		throw std::invalid_argument{"Target latency must be positive"};
+}
+
+auto FairShareScheduler::add(CPU &cpu, const TenantOptions &options)
+    -> TenantId {
+	auto added = Tenant{};
+	added.cpu = &cpu;
+	tenants.push_back(added);
+
+	const auto id = static_cast<TenantId>(tenants.size() - 1);
+	setOptions(id, options);
+	return id;
+}
+
+void FairShareScheduler::remove(TenantId id) { tenant(id).cpu = nullptr; }
+
+void FairShareScheduler::setOptions(TenantId id,
+				    const TenantOptions &options) {
+	if (options.weight == 0)
+		throw std::invalid_argument{"Weight can't be zero"};
+
+	tenant(id).options = options;
+}
+
+auto FairShareScheduler::runRound() -> bool {
+	const auto start = Clock::now();
+
+	std::vector<Tenant *> runnable;
+	auto totalWeight = uint64_t{0};
+	for (auto &candidate : tenants) {
+		auto &account = candidate.account;
+		if (candidate.cpu == nullptr || account.stopped)
+			continue;
+
+		if (account.periodCycles >= candidate.options.quota) {
+			account.throttled++;
+			continue;
+		}
+
+		const auto &options = candidate.options;
+		if (hasDeadline(candidate) && start > options.deadline)
+			account.deadlineMissed = true;
+
+		candidate.allowance = allowance(candidate, start);
+		totalWeight += candidate.options.weight;
+		runnable.push_back(&candidate);
+	}
+
+	if (runnable.empty())
+		return false;
+
+	// Earliest deadline first, then the rest in the order they were added
+	std::stable_sort(runnable.begin(), runnable.end(),
+			 [this](const Tenant *a, const Tenant *b) {
+				 if (!hasDeadline(*a) || !hasDeadline(*b))
+					 return hasDeadline(*a) &&
+						!hasDeadline(*b);
+
+				 return a->options.deadline <
+					b->options.deadline;
+			 });
+
+	// Each tenant is claimed by one thread, which alone updates it
+	std::atomic<size_t> next{0};
+	std::atomic<uint64_t> cycles{0};
+	const auto work = [&] {
+		for (auto i = next++; i < runnable.size(); i = next++) {
+			auto &running = *runnable[i];
+			auto &cpu = *running.cpu;
+			auto &account = running.account;
+
+			const auto before = cpu.cycle;
+			account.stopped = !cpu.run(before + running.allowance);
+			const auto ran = cpu.cycle - before;
+			account.cycles += ran;
+			account.periodCycles += ran;
+			account.slices++;
+			cycles += ran;
+		}
+	};
+
+	{
+		std::vector<std::jthread> workers;
+		const auto count = std::min<size_t>(threads, runnable.size());
+		for (size_t i = 1; i < count; i++)
+			workers.emplace_back(work);
+
+		work();
+	}
+
+	lastRound = Clock::now() - start;
+	resize(cycles, lastRound, totalWeight);
+	return true;
+}
+
+void FairShareScheduler::run(Clock::duration duration) {
+	const auto end = Clock::now() + duration;
+	while (Clock::now() < end && runRound()) {
+	}
+}
+
+void FairShareScheduler::startPeriod() {
+	for (auto &each : tenants)
+		each.account.periodCycles = 0;
+}
+
+auto FairShareScheduler::account(TenantId id) const -> const TenantAccount & {
+	return tenant(id).account;
+}
+
+auto FairShareScheduler::slice() const noexcept -> uint64_t {
+	return sliceCycles;
+}
+
+auto FairShareScheduler::tenant(TenantId id) -> Tenant & {
+	if (id >= tenants.size() || tenants[id].cpu == nullptr)
+		throw std::invalid_argument{"Unknown tenant"};
+
+	return tenants[id];
+}
+
+auto FairShareScheduler::tenant(TenantId id) const -> const Tenant & {
+	if (id >= tenants.size() || tenants[id].cpu == nullptr)
+		throw std::invalid_argument{"Unknown tenant"};
+
+	return tenants[id];
+}
+
+auto FairShareScheduler::hasDeadline(const Tenant &tenant) const -> bool {
+	return tenant.options.deadline != Clock::time_point{} &&
+	       tenant.cpu->cycle < tenant.options.deadlineCycle;
+}
+
+auto FairShareScheduler::allowance(const Tenant &tenant,
+				   Clock::time_point now) const -> uint64_t {
+	const auto &options = tenant.options;
+	auto cycles = saturatingMultiply(sliceCycles, options.weight);
+
+	// Enough to reach the deadline cycle in the rounds left before it, if
+	// they take as long as the last one
+	if (hasDeadline(tenant)) {
+		const auto remaining =
+		    options.deadlineCycle - tenant.cpu->cycle;
+		auto rounds = int64_t{1};
+		if (lastRound > Clock::duration::zero() &&
+		    options.deadline > now)
+			rounds = std::max<int64_t>(
+			    1, (options.deadline - now) / lastRound);
+
+		const auto needed =
+		    (remaining + static_cast<uint64_t>(rounds) - 1) /
+		    static_cast<uint64_t>(rounds);
+		cycles = std::max(cycles, std::min(needed, maxSlice));
+	}
+
+	return std::min(cycles, options.quota - tenant.account.periodCycles);
+}
+
+void FairShareScheduler::resize(uint64_t cycles, Clock::duration elapsed,
+				uint64_t totalWeight) {
+	if (cycles == 0 || elapsed <= Clock::duration::zero())
+		return;
+
+	// Slices which would have made the round take targetLatency, averaged
+	// with the current size to damp noise in the measured rate
+	const auto rate = static_cast<double>(cycles) /
+			  std::chrono::duration<double>(elapsed).count();
+	const auto target =
+	    rate * std::chrono::duration<double>(targetLatency).count() /
+	    static_cast<double>(totalWeight);
+	const auto averaged = (static_cast<double>(sliceCycles) + target) / 2;
+	sliceCycles = std::clamp(static_cast<uint64_t>(averaged), minSlice,
+				 maxSlice);
+}
+
+} // namespace microlator
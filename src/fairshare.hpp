@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "cpu.hpp"
+
+namespace microlator {
+
+struct TenantOptions {
+	constexpr static auto unlimited = std::numeric_limits<uint64_t>::max();
+
+	// Share of the pool relative to other tenants
+	uint32_t weight{1};
+	// Cycles the tenant may run in each period
+	uint64_t quota{unlimited};
+	// Cycle the tenant should reach by deadline, if it has one. Tenants
+	// with deadlines run first, earliest deadline first, and are given
+	// longer slices if they would otherwise miss it
+	uint64_t deadlineCycle{0};
+	std::chrono::steady_clock::time_point deadline{};
+};
+
+// Cycles and slices run by a tenant
+struct TenantAccount {
+	uint64_t cycles{0};
+	// Cycles run since the period started
+	uint64_t periodCycles{0};
+	uint64_t slices{0};
+	// Rounds the tenant was skipped in, having used its quota
+	uint64_t throttled{0};
+	// Whether it reached an unimplemented instruction, after which it is
+	// no longer run
+	bool stopped{false};
+	bool deadlineMissed{false};
+};
+
+// Shares a pool of threads between many tenant CPUs, in proportion to their
+// weights, so that busy tenants can't starve the others.
+// Tenants are run in rounds, in which each runnable tenant runs for one slice
+// of cycles times its weight. Slices are sized from the rate CPUs were
+// emulated at in earlier rounds, so that each round, and so the time between
+// a tenant's turns, takes about targetLatency.
+// Quotas limit the cycles each tenant runs in a period, which starts again on
+// each call to startPeriod()
+class FairShareScheduler {
+public:
+	using Clock = std::chrono::steady_clock;
+	using TenantId = uint32_t;
+
+	constexpr static auto minSlice = uint64_t{100};
+	constexpr static auto maxSlice = uint64_t{10'000'000};
+
+	// threads of 0 uses every core
+	explicit FairShareScheduler(
+	    unsigned threads = 0,
+	    Clock::duration targetLatency = std::chrono::milliseconds{10});
+
+	auto add(CPU &cpu, const TenantOptions &options = {}) -> TenantId;
+	void remove(TenantId tenant);
+	void setOptions(TenantId tenant, const TenantOptions &options);
+
+	// Run one round. Returns false if no tenant was runnable
+	auto runRound() -> bool;
+	// Run rounds until duration has passed, or no tenant is runnable
+	void run(Clock::duration duration);
+	// Reset the cycles each tenant has run against its quota
+	void startPeriod();
+
+	[[nodiscard]] auto account(TenantId tenant) const
+	    -> const TenantAccount &;
+	// Cycles per unit of weight in the next round
+	[[nodiscard]] auto slice() const noexcept -> uint64_t;
+
+private:
+	struct Tenant {
+		CPU *cpu{nullptr};
+		TenantOptions options;
+		TenantAccount account;
+		// Cycles to run in the current round
+		uint64_t allowance{0};
+	};
+
+	auto tenant(TenantId id) -> Tenant &;
+	[[nodiscard]] auto tenant(TenantId id) const -> const Tenant &;
+	[[nodiscard]] auto hasDeadline(const Tenant &tenant) const -> bool;
+	auto allowance(const Tenant &tenant, Clock::time_point now) const
+	    -> uint64_t;
+	void resize(uint64_t cycles, Clock::duration elapsed,
+		    uint64_t totalWeight);
+
+	unsigned threads;
+	Clock::duration targetLatency;
+	std::vector<Tenant> tenants;
+	uint64_t sliceCycles{10'000};
+	Clock::duration lastRound{};
+};
+
+} // namespace microlator
@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <array>
+#include <new>
+
+#include "cpu.hpp"
+#include "microlator.h"
+
+struct microlator_cpu {
+	microlator::CPU cpu;
+};
+
+namespace {
+
+using microlator::CPU;
+
+constexpr auto snapshotMagic = std::to_array<uint8_t>({'M', 'L', 'T', 'R'});
+constexpr auto headerSize = 8U;
+constexpr auto registersSize = 15U;
+static_assert(headerSize + registersSize + CPU::memorySize ==
+	      MICROLATOR_SNAPSHOT_SIZE);
+
+auto fitsMemory(uint16_t address, size_t length) -> bool {
+	return length <= CPU::memorySize - address;
+}
+
+// Little-endian encoding of integers into snapshots
+template <class T> auto put(uint8_t *buffer, T value) -> uint8_t * {
+	for (auto i = 0U; i < sizeof(T); i++)
+		*buffer++ = static_cast<uint8_t>(value >> (i * 8U));
+
+	return buffer;
+}
+
+template <class T> auto get(const uint8_t *&buffer) -> T {
+	auto value = T{0};
+	for (auto i = 0U; i < sizeof(T); i++)
+		value = static_cast<T>(value | T{*buffer++} << (i * 8U));
+
+	return value;
+}
+
+auto getRegisters(const CPU &cpu) -> microlator_registers {
+	return {cpu.cycle,  cpu.pc,    cpu.accumulator, cpu.indexX,
+		cpu.indexY, cpu.stack, cpu.flags.get()};
+}
+
+void setRegisters(CPU &cpu, const microlator_registers &registers) {
+	cpu.cycle = registers.cycle;
+	cpu.pc = registers.pc;
+	cpu.accumulator = registers.accumulator;
+	cpu.indexX = registers.index_x;
+	cpu.indexY = registers.index_y;
+	cpu.stack = registers.stack;
+	cpu.flags = microlator::Flags{registers.flags};
+}
+
+} // namespace
+
+extern "C" {
+
+uint32_t microlator_abi_version(void) { return MICROLATOR_ABI_VERSION; }
+
+microlator_cpu *microlator_create(void) {
+	return new (std::nothrow) microlator_cpu{};
+}
+
+void microlator_destroy(microlator_cpu *cpu) { delete cpu; }
+
+void microlator_reset(microlator_cpu *cpu) {
+	if (cpu != nullptr)
+		cpu->cpu.reset();
+}
+
+microlator_status microlator_load_program(microlator_cpu *cpu,
+					  const uint8_t *program,
+					  size_t length, uint16_t offset) {
+	if (cpu == nullptr || program == nullptr || !fitsMemory(offset, length))
+		return MICROLATOR_INVALID_ARGUMENT;
+
+	cpu->cpu.loadProgram({program, length}, offset);
+	return MICROLATOR_OK;
+}
+
+int microlator_run(microlator_cpu *cpu, uint64_t until_cycle) {
+	return cpu != nullptr && cpu->cpu.run(until_cycle) ? 1 : 0;
+}
+
+microlator_status microlator_run_many(microlator_cpu *const *cpus,
+				      size_t count, uint64_t cycles,
+				      int *running) {
+	if (cpus == nullptr || std::find(cpus, cpus + count, nullptr) !=
+				   cpus + count)
+		return MICROLATOR_INVALID_ARGUMENT;
+
+	for (size_t i = 0; i < count; i++) {
+		auto &cpu = cpus[i]->cpu;
+		const auto result = cpu.run(cpu.cycle + cycles);
+		if (running != nullptr)
+			running[i] = result ? 1 : 0;
+	}
+
+	return MICROLATOR_OK;
+}
+
+uint8_t *microlator_memory(microlator_cpu *cpu) {
+	return cpu != nullptr ? cpu->cpu.memory.data() : nullptr;
+}
+
+microlator_status microlator_read_memory(const microlator_cpu *cpu,
+					 uint16_t address, uint8_t *buffer,
+					 size_t length) {
+	if (cpu == nullptr || buffer == nullptr || !fitsMemory(address, length))
+		return MICROLATOR_INVALID_ARGUMENT;
+
+	const auto begin = cpu->cpu.memory.begin() + address;
+	std::copy(begin, begin + length, buffer);
+	return MICROLATOR_OK;
+}
+
+microlator_status microlator_write_memory(microlator_cpu *cpu,
+					  uint16_t address,
+					  const uint8_t *buffer,
+					  size_t length) {
+	if (cpu == nullptr || buffer == nullptr || !fitsMemory(address, length))
+		return MICROLATOR_INVALID_ARGUMENT;
+
+	std::copy(buffer, buffer + length, cpu->cpu.memory.begin() + address);
+	return MICROLATOR_OK;
+}
+
+microlator_status
+microlator_get_registers(const microlator_cpu *const *cpus, size_t count,
+			 microlator_registers *registers) {
+	if (cpus == nullptr || registers == nullptr ||
+	    std::find(cpus, cpus + count, nullptr) != cpus + count)
+		return MICROLATOR_INVALID_ARGUMENT;
+
+	for (size_t i = 0; i < count; i++)
+		registers[i] = getRegisters(cpus[i]->cpu);
+
+	return MICROLATOR_OK;
+}
+
+microlator_status
+microlator_set_registers(microlator_cpu *const *cpus, size_t count,
+			 const microlator_registers *registers) {
+	if (cpus == nullptr || registers == nullptr ||
+	    std::find(cpus, cpus + count, nullptr) != cpus + count)
+		return MICROLATOR_INVALID_ARGUMENT;
+
+	for (size_t i = 0; i < count; i++)
+		setRegisters(cpus[i]->cpu, registers[i]);
+
+	return MICROLATOR_OK;
+}
+
+microlator_status microlator_save(const microlator_cpu *cpu, uint8_t *buffer,
+				  size_t size) {
+	if (cpu == nullptr || buffer == nullptr ||
+	    size < MICROLATOR_SNAPSHOT_SIZE)
+		return MICROLATOR_INVALID_ARGUMENT;
+
+	const auto registers = getRegisters(cpu->cpu);
+	buffer = std::copy(snapshotMagic.begin(), snapshotMagic.end(), buffer);
+	buffer = put(buffer, uint32_t{MICROLATOR_ABI_VERSION});
+	buffer = put(buffer, registers.cycle);
+	buffer = put(buffer, registers.pc);
+	for (const auto value :
+	     {registers.accumulator, registers.index_x, registers.index_y,
+	      registers.stack, registers.flags})
+		buffer = put(buffer, value);
+
+	std::copy(cpu->cpu.memory.begin(), cpu->cpu.memory.end(), buffer);
+	return MICROLATOR_OK;
+}
+
+microlator_status microlator_restore(microlator_cpu *cpu,
+				     const uint8_t *buffer, size_t size) {
+	if (cpu == nullptr || buffer == nullptr ||
+	    size < MICROLATOR_SNAPSHOT_SIZE)
+		return MICROLATOR_INVALID_ARGUMENT;
+
+	if (!std::equal(snapshotMagic.begin(), snapshotMagic.end(), buffer))
+		return MICROLATOR_INVALID_SNAPSHOT;
+
+	buffer += snapshotMagic.size();
+	if (get<uint32_t>(buffer) != MICROLATOR_ABI_VERSION)
+		return MICROLATOR_INVALID_SNAPSHOT;
+
+	auto registers = microlator_registers{};
+	registers.cycle = get<uint64_t>(buffer);
+	registers.pc = get<uint16_t>(buffer);
+	registers.accumulator = get<uint8_t>(buffer);
+	registers.index_x = get<uint8_t>(buffer);
+	registers.index_y = get<uint8_t>(buffer);
+	registers.stack = get<uint8_t>(buffer);
+	registers.flags = get<uint8_t>(buffer);
+
+	setRegisters(cpu->cpu, registers);
+	std::copy(buffer, buffer + CPU::memorySize, cpu->cpu.memory.begin());
+	return MICROLATOR_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,96 @@
+#pragma once
+
+// C interface to microlator, for use through FFI. CPUs are opaque handles,
+// and calls which operate on many CPUs or much memory at once let callers
+// amortise the cost of crossing into the library.
+// No function throws. Functions which can fail return a microlator_status,
+// and every function accepts null in place of a CPU
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Incremented whenever a change would break existing callers
+#define MICROLATOR_ABI_VERSION 1
+
+// Bytes taken by a snapshot: a header, the registers and all of memory
+#define MICROLATOR_SNAPSHOT_SIZE (8 + 15 + 65536)
+
+typedef struct microlator_cpu microlator_cpu;
+
+typedef enum microlator_status {
+	MICROLATOR_OK = 0,
+	// A null pointer, or a range outside of memory or a buffer
+	MICROLATOR_INVALID_ARGUMENT = 1,
+	// A snapshot from another version, or not a snapshot at all
+	MICROLATOR_INVALID_SNAPSHOT = 2,
+} microlator_status;
+
+typedef struct microlator_registers {
+	uint64_t cycle;
+	uint16_t pc;
+	uint8_t accumulator;
+	uint8_t index_x;
+	uint8_t index_y;
+	uint8_t stack;
+	uint8_t flags;
+} microlator_registers;
+
+// Version of the interface the library was built with
+uint32_t microlator_abi_version(void);
+
+// Returns null if the CPU could not be allocated
+microlator_cpu *microlator_create(void);
+// Destroying or resetting null does nothing
+void microlator_destroy(microlator_cpu *cpu);
+void microlator_reset(microlator_cpu *cpu);
+
+// Copy a program into memory at offset, and point pc at it
+microlator_status microlator_load_program(microlator_cpu *cpu,
+					  const uint8_t *program,
+					  size_t length, uint16_t offset);
+
+// Execute instructions until the CPU's cycle reaches until_cycle. Returns 1,
+// or 0 if an unimplemented instruction was reached first or cpu is null
+int microlator_run(microlator_cpu *cpu, uint64_t until_cycle);
+// Run each of count CPUs for at least cycles more cycles, as
+// microlator_run(). Each result is written to running, if it is not null
+microlator_status microlator_run_many(microlator_cpu *const *cpus,
+				      size_t count, uint64_t cycles,
+				      int *running);
+
+// The CPU's 64KiB of memory, valid until it is destroyed, for callers which
+// inspect or change it in place rather than copying it. Null if cpu is null
+uint8_t *microlator_memory(microlator_cpu *cpu);
+
+// Copy length bytes of memory starting at address
+microlator_status microlator_read_memory(const microlator_cpu *cpu,
+					 uint16_t address, uint8_t *buffer,
+					 size_t length);
+microlator_status microlator_write_memory(microlator_cpu *cpu,
+					  uint16_t address,
+					  const uint8_t *buffer,
+					  size_t length);
+
+// Get or set the registers of each of count CPUs
+microlator_status
+microlator_get_registers(const microlator_cpu *const *cpus, size_t count,
+			 microlator_registers *registers);
+microlator_status
+microlator_set_registers(microlator_cpu *const *cpus, size_t count,
+			 const microlator_registers *registers);
+
+// Save the registers and memory of a CPU into a buffer of at least
+// MICROLATOR_SNAPSHOT_SIZE bytes, or restore them from one. Mapped devices
+// are not included
+microlator_status microlator_save(const microlator_cpu *cpu, uint8_t *buffer,
+				  size_t size);
+microlator_status microlator_restore(microlator_cpu *cpu,
+				     const uint8_t *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <future>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "migration.hpp"
+
+namespace {
+
+using microlator::CPU;
+
+constexpr auto magic = std::to_array<uint8_t>({'M', 'L', 'M', 'G'});
+// Changed whenever the stream format changes
+constexpr auto version = uint8_t{1};
+constexpr auto acknowledgement = uint8_t{1};
+
+// Each record of a stream starts with its type
+enum Record : uint8_t {
+	// The page number, then its contents
+	Page = 1,
+	// The registers, which end the stream
+	Registers = 2,
+};
+
+constexpr auto registersSize = 15U;
+
+[[noreturn]] void throwErrno(const char *what) {
+	throw std::system_error{errno, std::generic_category(), what};
+}
+
+// Closes a socket on destruction
+class Socket {
+public:
+	explicit Socket(int fd) : fd{fd} {}
+	Socket(const Socket &) = delete;
+	Socket(Socket &&) = delete;
+	auto operator=(const Socket &) -> Socket & = delete;
+	auto operator=(Socket &&) -> Socket & = delete;
+	~Socket() { ::close(fd); }
+
+	void send(std::span<const uint8_t> data) const {
+		while (!data.empty()) {
+			const auto sent =
+			    ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+			if (sent < 0 && errno == EINTR)
+				continue;
+			if (sent < 0)
+				throwErrno("Failed to send migration");
+
+			data = data.subspan(static_cast<size_t>(sent));
+		}
+	}
+
+	void receive(std::span<uint8_t> data) const {
+		while (!data.empty()) {
+			const auto received =
+			    ::recv(fd, data.data(), data.size(), 0);
+			if (received < 0 && errno == EINTR)
+				continue;
+			if (received < 0)
+				throwErrno("Failed to receive migration");
+			if (received == 0)
+				throw std::invalid_argument{
+				    "Migration stream is truncated"};
+
+			data = data.subspan(static_cast<size_t>(received));
+		}
+	}
+
+	auto receive() const -> uint8_t {
+		auto value = uint8_t{0};
+		receive(std::span{&value, 1});
+		return value;
+	}
+
+private:
+	int fd;
+};
+
+auto address(const std::string &path) -> sockaddr_un {
+	auto result = sockaddr_un{};
+	if (path.size() >= sizeof(result.sun_path))
+		throw std::invalid_argument{"Socket path is too long"};
+
+	result.sun_family = AF_UNIX;
+	std::copy(path.begin(), path.end(), result.sun_path);
+	return result;
+}
+
+auto connect(const std::string &path) -> int {
+	const auto connected = address(path);
+	const auto fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		throwErrno("Failed to create socket");
+
+	if (::connect(fd, reinterpret_cast<const sockaddr *>(&connected),
+		      sizeof(connected)) != 0) {
+		::close(fd);
+		throwErrno("Failed to connect to migration listener");
+	}
+
+	return fd;
+}
+
+// Little-endian encoding of integers into streams
+template <class T> void put(std::vector<uint8_t> &buffer, T value) {
+	for (auto i = 0U; i < sizeof(T); i++)
+		buffer.push_back(static_cast<uint8_t>(value >> (i * 8U)));
+}
+
+template <class T> auto get(const uint8_t *&buffer) -> T {
+	auto value = T{0};
+	for (auto i = 0U; i < sizeof(T); i++)
+		value = static_cast<T>(value | T{*buffer++} << (i * 8U));
+
+	return value;
+}
+
+auto page(CPU::Memory &memory, size_t number) -> std::span<uint8_t> {
+	return std::span{memory}.subspan(number * CPU::pageSize, CPU::pageSize);
+}
+
+auto page(const CPU::Memory &memory, size_t number)
+    -> std::span<const uint8_t> {
+	return std::span{memory}.subspan(number * CPU::pageSize, CPU::pageSize);
+}
+
+// Pages are found to be dirty by comparing them with the copy last sent,
+// rather than by watching writes, which would displace the CPU's own watchers
+// and miss writes made directly to its memory
+class DirtyPages {
+public:
+	// Records for every page which changed since it was last sent, which
+	// are then considered sent. Returns how many there were
+	auto collect(const CPU &cpu, std::vector<uint8_t> &buffer) -> size_t {
+		auto count = size_t{0};
+		for (auto number = size_t{0}; number < CPU::pageCount;
+		     number++) {
+			const auto current = page(cpu.memory, number);
+			const auto previous = page(*sent, number);
+			if (!first &&
+			    std::equal(current.begin(), current.end(),
+				       previous.begin()))
+				continue;
+
+			buffer.push_back(Page);
+			buffer.push_back(static_cast<uint8_t>(number));
+			buffer.insert(buffer.end(), current.begin(),
+				      current.end());
+			std::copy(current.begin(), current.end(),
+				  previous.begin());
+			count++;
+		}
+
+		first = false;
+		return count;
+	}
+
+private:
+	std::unique_ptr<CPU::Memory> sent{std::make_unique<CPU::Memory>()};
+	bool first{true};
+};
+
+} // namespace
+
+namespace microlator {
+
+MigrationListener::MigrationListener(std::string path)
+    : path{std::move(path)} {
+	const auto bound = address(this->path);
+	fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		throwErrno("Failed to create socket");
+
+	if (::bind(fd, reinterpret_cast<const sockaddr *>(&bound),
+		   sizeof(bound)) != 0) {
+		::close(fd);
+		throwErrno("Failed to bind socket");
+	}
+
+	if (::listen(fd, 1) != 0) {
+		::close(fd);
+		::unlink(this->path.c_str());
+		throwErrno("Failed to listen on socket");
+	}
+}
+
+MigrationListener::~MigrationListener() {
+	::close(fd);
+	::unlink(path.c_str());
+}
+
+void MigrationListener::accept(CPU &cpu) {
+	auto connected = ::accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+	while (connected < 0 && errno == EINTR)
+		connected = ::accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+	if (connected < 0)
+		throwErrno("Failed to accept migration");
+
+	const auto socket = Socket{connected};
+	auto header = std::array<uint8_t, magic.size() + 1>{};
+	socket.receive(header);
+	if (!std::equal(magic.begin(), magic.end(), header.begin()) ||
+	    header.back() != version)
+		throw std::invalid_argument{"Not a migration stream"};
+
+	auto memory = std::make_unique<CPU::Memory>(cpu.memory);
+	while (true) {
+		const auto type = socket.receive();
+		if (type == Page) {
+			const auto number = socket.receive();
+			socket.receive(page(*memory, number));
+			continue;
+		}
+		if (type != Registers)
+			throw std::invalid_argument{"Not a migration stream"};
+
+		auto registers = std::array<uint8_t, registersSize>{};
+		socket.receive(registers);
+		const auto *next = registers.data();
+		cpu.cycle = get<uint64_t>(next);
+		cpu.pc = get<uint16_t>(next);
+		cpu.accumulator = get<uint8_t>(next);
+		cpu.indexX = get<uint8_t>(next);
+		cpu.indexY = get<uint8_t>(next);
+		cpu.stack = get<uint8_t>(next);
+		cpu.flags = Flags{get<uint8_t>(next)};
+		cpu.memory = *memory;
+		break;
+	}
+
+	socket.send(std::span{&acknowledgement, 1});
+}
+
+auto migrate(CPU &cpu, const std::string &path,
+	     const MigrationOptions &options) -> MigrationResult {
+	using Clock = std::chrono::steady_clock;
+
+	const auto socket = Socket{connect(path)};
+	auto buffer = std::vector<uint8_t>{magic.begin(), magic.end()};
+	buffer.push_back(version);
+
+	auto result = MigrationResult{};
+	auto dirty = DirtyPages{};
+	auto pages = dirty.collect(cpu, buffer);
+	auto paused = Clock::now();
+	while (!result.stopped && result.rounds < options.maxRounds &&
+	       pages > options.dirtyPages) {
+		// The CPU runs while the round is sent from a buffer of its
+		// own, and keeps running in slices until it has been, rather
+		// than stalling on a slow receiver
+		auto sending = std::async(std::launch::async,
+					  [&socket, round = std::move(buffer)] {
+						  socket.send(round);
+					  });
+		result.stopped = !cpu.run(cpu.cycle + options.roundCycles);
+		while (!result.stopped &&
+		       sending.wait_for(std::chrono::seconds{0}) !=
+			   std::future_status::ready) {
+			const auto start = cpu.cycle;
+			result.stopped =
+			    !cpu.run(cpu.cycle + options.sliceCycles);
+			result.waitCycles += cpu.cycle - start;
+		}
+		paused = Clock::now();
+		sending.get();
+
+		result.rounds++;
+		result.pagesSent += pages;
+		buffer.clear();
+		pages = dirty.collect(cpu, buffer);
+	}
+
+	result.finalPages = pages;
+	result.pagesSent += pages;
+	buffer.push_back(Registers);
+	put(buffer, cpu.cycle);
+	put(buffer, cpu.pc);
+	put(buffer, cpu.accumulator);
+	put(buffer, cpu.indexX);
+	put(buffer, cpu.indexY);
+	put(buffer, cpu.stack);
+	put(buffer, cpu.flags.get());
+	socket.send(buffer);
+	if (socket.receive() != acknowledgement)
+		throw std::invalid_argument{"Migration wasn't acknowledged"};
+
+	result.downtime = Clock::now() - paused;
+	return result;
+}
+
+} // namespace microlator
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "cpu.hpp"
+
+namespace microlator {
+
+struct MigrationOptions {
+	// Cycles the CPU runs for while each pre-copy round is sent
+	uint64_t roundCycles{100'000};
+	// Pre-copy rounds before the CPU is stopped regardless of how many
+	// pages it is still dirtying
+	unsigned maxRounds{8};
+	// Stop the CPU once a round leaves no more than this many dirty pages
+	size_t dirtyPages{4};
+	// Cycles the CPU runs for at a time once a round's have passed, until
+	// the round has been sent
+	uint64_t sliceCycles{10'000};
+};
+
+struct MigrationResult {
+	// Pre-copy rounds sent while the CPU ran
+	unsigned rounds{0};
+	// Pages sent, including those sent more than once
+	size_t pagesSent{0};
+	// Pages sent after the CPU was stopped
+	size_t finalPages{0};
+	// Cycles the CPU ran beyond roundCycles waiting for rounds to be sent
+	uint64_t waitCycles{0};
+	// From stopping the CPU until the receiver had restored it
+	std::chrono::steady_clock::duration downtime{};
+	// Whether the CPU reached an unimplemented instruction while running
+	// between rounds
+	bool stopped{false};
+};
+
+// Receives CPUs migrated from other processes over a Unix domain socket
+class MigrationListener {
+public:
+	// Listen at path, which is removed again on destruction
+	explicit MigrationListener(std::string path);
+	MigrationListener(const MigrationListener &) = delete;
+	MigrationListener(MigrationListener &&) = delete;
+	auto operator=(const MigrationListener &)
+	    -> MigrationListener & = delete;
+	auto operator=(MigrationListener &&) -> MigrationListener & = delete;
+	~MigrationListener();
+
+	// Wait for one CPU to be migrated, and restore its registers and
+	// memory into cpu, which keeps its own devices and watchers. cpu is
+	// only changed once the whole CPU has been received
+	void accept(CPU &cpu);
+
+private:
+	std::string path;
+	int fd;
+};
+
+// Migrate cpu to the MigrationListener at path, with little downtime.
+// Memory is pre-copied while the CPU keeps running: every page is sent, then
+// each round sends the pages which changed while the last was sent. Once few
+// pages change in a round, the CPU is stopped and its registers are sent with
+// the remaining dirty pages. cpu should not be run again afterwards.
+// Devices aren't migrated, so must be mapped into the receiving CPU
+auto migrate(CPU &cpu, const std::string &path,
+	     const MigrationOptions &options = {}) -> MigrationResult;
+
+} // namespace microlator
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "monitor.hpp"
+
+namespace {
+
+using microlator::CPU;
+using microlator::MonitoredRegisters;
+
+constexpr auto magic = uint32_t{0x4d4c4d4e};
+// Changed whenever the layout of segments changes
+constexpr auto version = uint32_t{1};
+
+// Start of a segment, which is followed by the CPU
+struct Header {
+	uint32_t magic{::magic};
+	uint32_t version{::version};
+	// Of the CPU's memory from the start of the segment
+	uint64_t memoryOffset{0};
+	// Odd while the registers are being published
+	std::atomic<uint64_t> sequence{0};
+	// The cycle, then the other registers packed together
+	std::array<std::atomic<uint64_t>, 2> registers{};
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+	      "Atomics in shared memory must be lock free");
+
+constexpr auto cpuOffset =
+    (sizeof(Header) + alignof(CPU) - 1) / alignof(CPU) * alignof(CPU);
+constexpr auto segmentSize = cpuOffset + sizeof(CPU);
+
+[[noreturn]] void throwErrno(const char *what) {
+	throw std::system_error{errno, std::generic_category(), what};
+}
+
+auto pack(const MonitoredRegisters &registers) -> uint64_t {
+	return uint64_t{registers.pc} | uint64_t{registers.accumulator} << 16U |
+	       uint64_t{registers.indexX} << 24U |
+	       uint64_t{registers.indexY} << 32U |
+	       uint64_t{registers.stack} << 40U |
+	       uint64_t{registers.flags} << 48U |
+	       uint64_t{registers.stopped} << 56U;
+}
+
+auto unpack(uint64_t cycle, uint64_t packed) -> MonitoredRegisters {
+	const auto byte = [packed](unsigned shift) {
+		return static_cast<uint8_t>(packed >> shift);
+	};
+
+	return {
+	    cycle,
+	    static_cast<uint16_t>(packed),
+	    byte(16),
+	    byte(24),
+	    byte(32),
+	    byte(40),
+	    byte(48),
+	    byte(56) != 0,
+	};
+}
+
+auto header(void *segment) -> Header & {
+	return *static_cast<Header *>(segment);
+}
+
+auto header(const void *segment) -> const Header & {
+	return *static_cast<const Header *>(segment);
+}
+
+} // namespace
+
+namespace microlator {
+
+MonitoredCPU::MonitoredCPU(std::string name) : name{std::move(name)} {
+	const auto fd = ::shm_open(this->name.c_str(),
+				   O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+	if (fd < 0)
+		throwErrno("Failed to create shared memory object");
+
+	if (::ftruncate(fd, segmentSize) != 0) {
+		::close(fd);
+		::shm_unlink(this->name.c_str());
+		throwErrno("Failed to size shared memory object");
+	}
+
+	segment = ::mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE,
+			 MAP_SHARED, fd, 0);
+	::close(fd);
+	if (segment == MAP_FAILED) {
+		::shm_unlink(this->name.c_str());
+		throwErrno("Failed to map shared memory object");
+	}
+
+	auto *base = static_cast<uint8_t *>(segment);
+	auto *created = new (segment) Header{};
+	monitored = new (base + cpuOffset) CPU{};
+	created->memoryOffset =
+	    static_cast<uint64_t>(monitored->memory.data() - base);
+	publish();
+}
+
+MonitoredCPU::~MonitoredCPU() {
+	monitored->~CPU();
+	header(segment).~Header();
+	::munmap(segment, segmentSize);
+	::shm_unlink(name.c_str());
+}
+
+auto MonitoredCPU::cpu() noexcept -> CPU & { return *monitored; }
+
+void MonitoredCPU::publish() noexcept {
+	auto &published = header(segment);
+	const auto &cpu = *monitored;
+	const auto registers = MonitoredRegisters{
+	    cpu.cycle,	cpu.pc,	   cpu.accumulator, cpu.indexX,
+	    cpu.indexY, cpu.stack, cpu.flags.get(), stopped,
+	};
+
+	// Monitors retry reads which overlap an odd sequence, or a change in
+	// it
+	const auto sequence =
+	    published.sequence.load(std::memory_order_relaxed);
+	published.sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	published.registers[0].store(registers.cycle,
+				     std::memory_order_relaxed);
+	published.registers[1].store(pack(registers),
+				     std::memory_order_relaxed);
+	published.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+auto MonitoredCPU::run(uint64_t untilCycle, uint64_t interval) -> bool {
+	if (interval == 0)
+		throw std::invalid_argument{"Interval can't be zero"};
+
+	while (monitored->cycle < untilCycle) {
+		const auto next =
+		    std::min(untilCycle, monitored->cycle + interval);
+		stopped = !monitored->run(next);
+		publish();
+		if (stopped)
+			return false;
+	}
+
+	return true;
+}
+
+CPUMonitor::CPUMonitor(const std::string &name) {
+	const auto fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+	if (fd < 0)
+		throwErrno("Failed to open shared memory object");
+
+	struct stat info {};
+	if (::fstat(fd, &info) != 0) {
+		::close(fd);
+		throwErrno("Failed to stat shared memory object");
+	}
+	if (static_cast<size_t>(info.st_size) < segmentSize) {
+		::close(fd);
+		throw std::invalid_argument{"Not a monitored CPU"};
+	}
+
+	segment = ::mmap(nullptr, segmentSize, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (segment == MAP_FAILED)
+		throwErrno("Failed to map shared memory object");
+
+	const auto &mapped = header(segment);
+	if (mapped.magic != magic || mapped.version != version ||
+	    mapped.memoryOffset + CPU::memorySize > segmentSize) {
+		::munmap(const_cast<void *>(segment), segmentSize);
+		throw std::invalid_argument{"Not a monitored CPU"};
+	}
+}
+
+CPUMonitor::~CPUMonitor() {
+	::munmap(const_cast<void *>(segment), segmentSize);
+}
+
+auto CPUMonitor::registers() const noexcept -> MonitoredRegisters {
+	const auto &published = header(segment);
+	while (true) {
+		const auto before =
+		    published.sequence.load(std::memory_order_acquire);
+		const auto cycle =
+		    published.registers[0].load(std::memory_order_relaxed);
+		const auto packed =
+		    published.registers[1].load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const auto after =
+		    published.sequence.load(std::memory_order_relaxed);
+
+		if (before == after && before % 2 == 0)
+			return unpack(cycle, packed);
+	}
+}
+
+auto CPUMonitor::memory() const noexcept
+    -> std::span<const uint8_t, CPU::memorySize> {
+	const auto *base = static_cast<const uint8_t *>(segment);
+	return std::span<const uint8_t, CPU::memorySize>{
+	    base + header(segment).memoryOffset, CPU::memorySize};
+}
+
+} // namespace microlator
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "cpu.hpp"
+
+namespace microlator {
+
+// Registers and counters of a CPU, as last published to monitors
+struct MonitoredRegisters {
+	uint64_t cycle{0};
+	uint16_t pc{0};
+	uint8_t accumulator{0};
+	uint8_t indexX{0};
+	uint8_t indexY{0};
+	uint8_t stack{0};
+	uint8_t flags{0};
+	// Whether the CPU has reached an unimplemented instruction
+	bool stopped{false};
+
+	auto operator==(const MonitoredRegisters &) const -> bool = default;
+};
+
+// A CPU constructed in a POSIX shared memory object, so that monitors in
+// other processes can inspect it while it runs without pausing it.
+// Its registers are published to a block protected by a sequence lock, so
+// monitors always read a consistent set, from after the last call to
+// publish(). Its memory is read directly, so is always current but may
+// change while being read
+class MonitoredCPU {
+public:
+	// Create the shared memory object name, e.g. "/guest", which is
+	// removed again on destruction
+	explicit MonitoredCPU(std::string name);
+	MonitoredCPU(const MonitoredCPU &) = delete;
+	MonitoredCPU(MonitoredCPU &&) = delete;
+	auto operator=(const MonitoredCPU &) -> MonitoredCPU & = delete;
+	auto operator=(MonitoredCPU &&) -> MonitoredCPU & = delete;
+	~MonitoredCPU();
+
+	[[nodiscard]] auto cpu() noexcept -> CPU &;
+	// Publish the current registers to monitors
+	void publish() noexcept;
+	// Run the CPU until untilCycle as CPU::run(), publishing its registers
+	// at least every interval cycles
+	auto run(uint64_t untilCycle, uint64_t interval = 10'000) -> bool;
+
+private:
+	std::string name;
+	void *segment;
+	CPU *monitored;
+	bool stopped{false};
+};
+
+// Read-only view of a MonitoredCPU, from any process
+class CPUMonitor {
+public:
+	explicit CPUMonitor(const std::string &name);
+	CPUMonitor(const CPUMonitor &) = delete;
+	CPUMonitor(CPUMonitor &&) = delete;
+	auto operator=(const CPUMonitor &) -> CPUMonitor & = delete;
+	auto operator=(CPUMonitor &&) -> CPUMonitor & = delete;
+	~CPUMonitor();
+
+	[[nodiscard]] auto registers() const noexcept -> MonitoredRegisters;
+	[[nodiscard]] auto memory() const noexcept
+	    -> std::span<const uint8_t, CPU::memorySize>;
+
+private:
+	const void *segment;
+};
+
+} // namespace microlator
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "multiprocessor.hpp"
+
+namespace microlator {
+
+SharedMemory::SharedMemory(Multiprocessor &owner, uint8_t firstPage,
+			   uint8_t lastPage)
+    : memory((lastPage - firstPage + 1U) * CPU::pageSize), owner{owner},
+      base{static_cast<uint16_t>(firstPage * CPU::pageSize)} {}
+
+auto SharedMemory::read(const CPU &, uint16_t address) -> uint8_t {
+	owner.notifySharedAccess();
+	return memory[address - base];
+}
+
+void SharedMemory::write(CPU &, uint16_t address, uint8_t value) {
+	owner.notifySharedAccess();
+	memory[address - base] = value;
+}
+
+Multiprocessor::Multiprocessor(size_t count, uint64_t minQuantum,
+			       uint64_t maxQuantum)
+    : cpus(count), minQuantum{minQuantum}, maxQuantum{maxQuantum},
+      currentQuantum{minQuantum} {
+	if (minQuantum == 0 || minQuantum > maxQuantum)
+		throw std::invalid_argument{"Invalid quantum range"};
+}
+
+auto Multiprocessor::share(uint8_t firstPage, uint8_t lastPage)
+    -> SharedMemory & {
+	if (firstPage > lastPage)
+		throw std::invalid_argument{"Page range is empty"};
+
+	auto &memory = *shared.emplace_back(
+	    std::make_unique<SharedMemory>(*this, firstPage, lastPage));
+	for (auto &cpu : cpus)
+		cpu.map(memory, firstPage, lastPage);
+
+	return memory;
+}
+
+void Multiprocessor::notifySharedAccess() noexcept { sharedAccesses++; }
+
+auto Multiprocessor::run(uint64_t untilCycle) -> bool {
+	while (now < untilCycle) {
+		const auto target = std::min(untilCycle, now + currentQuantum);
+		const auto accesses = sharedAccesses;
+
+		for (auto &cpu : cpus) {
+			if (!cpu.run(target))
+				return false;
+		}
+
+		now = target;
+		quantaRun++;
+		currentQuantum = (sharedAccesses != accesses)
+				     ? std::max(minQuantum, currentQuantum / 2)
+				     : std::min(maxQuantum, currentQuantum * 2);
+	}
+
+	return true;
+}
+
+auto Multiprocessor::quantum() const noexcept -> uint64_t {
+	return currentQuantum;
+}
+
+auto Multiprocessor::quanta() const noexcept -> uint64_t {
+	return quantaRun;
+}
+
+} // namespace microlator
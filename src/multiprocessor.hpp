@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "cpu.hpp"
+#include "device.hpp"
+
+namespace microlator {
+
+class Multiprocessor;
+
+// RAM mapped into the same pages of every CPU of a Multiprocessor. Each
+// access is reported to it, so that it can synchronise the CPUs more often
+class SharedMemory : public Device {
+public:
+	SharedMemory(Multiprocessor &owner, uint8_t firstPage,
+		     uint8_t lastPage);
+
+	auto read(const CPU &cpu, uint16_t address) -> uint8_t override;
+	void write(CPU &cpu, uint16_t address, uint8_t value) override;
+
+	std::vector<uint8_t> memory;
+
+private:
+	Multiprocessor &owner;
+	uint16_t base;
+};
+
+// Runs several CPUs, e.g. a main CPU and a sound or drive CPU, which
+// communicate through shared memory or ports. Rather than interleaving them
+// an instruction at a time, each CPU runs alone for a quantum of cycles
+// before the next catches up with it, so a CPU can see another's writes up to
+// a quantum early or late.
+// The quantum is halved after any quantum in which a shared device was
+// accessed, and doubled after any in which none was. It depends only on what
+// the CPUs did, and the CPUs always run in the same order on one thread, so
+// results are deterministic
+class Multiprocessor {
+public:
+	Multiprocessor(size_t count, uint64_t minQuantum = 1,
+		       uint64_t maxQuantum = 4096);
+	// Shared devices refer back to the Multiprocessor
+	Multiprocessor(const Multiprocessor &) = delete;
+	Multiprocessor(Multiprocessor &&) = delete;
+	auto operator=(const Multiprocessor &) -> Multiprocessor & = delete;
+	auto operator=(Multiprocessor &&) -> Multiprocessor & = delete;
+	~Multiprocessor() = default;
+
+	// Create memory shared between all CPUs, mapped to the same pages of
+	// each
+	auto share(uint8_t firstPage, uint8_t lastPage) -> SharedMemory &;
+	// Report an access to a shared device, for devices other than
+	// SharedMemory through which the CPUs communicate
+	void notifySharedAccess() noexcept;
+
+	// Run every CPU until the given cycle. Returns false as soon as any CPU
+	// reaches an unimplemented instruction, leaving those after it in the
+	// previous quantum
+	auto run(uint64_t untilCycle) -> bool;
+
+	[[nodiscard]] auto quantum() const noexcept -> uint64_t;
+	// Quanta run so far
+	[[nodiscard]] auto quanta() const noexcept -> uint64_t;
+
+	std::vector<CPU> cpus;
+
+private:
+	std::vector<std::unique_ptr<SharedMemory>> shared;
+	uint64_t minQuantum;
+	uint64_t maxQuantum;
+	uint64_t currentQuantum;
+	uint64_t quantaRun{0};
+	// Cycle every CPU has reached
+	uint64_t now{0};
+	uint64_t sharedAccesses{0};
+};
+
+} // namespace microlator
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "nes.hpp"
+
+namespace {
+
+constexpr auto headerSize = 16U;
+constexpr auto trainerSize = 0x200U;
+constexpr auto trainerBit = 0x04U;
+constexpr auto prgBankSize = 0x4000U;
+constexpr auto chrBankSize = 0x2000U;
+
+// The 2K of RAM is mirrored up to the PPU's registers, which are mirrored
+// every 8 bytes up to the APU and I/O registers
+constexpr auto ramMask = 0x7ffU;
+constexpr auto ppuStart = 0x2000U;
+constexpr auto ioStart = 0x4000U;
+constexpr auto expansionStart = 0x4020U;
+constexpr auto romStart = 0x8000U;
+constexpr auto vramMask = 0x3fffU;
+constexpr auto paletteStart = 0x3f00U;
+
+constexpr auto oamDmaRegister = 0x4014U;
+constexpr auto joy1 = 0x4016U;
+constexpr auto joy2 = 0x4017U;
+// Controller reads only drive the lowest bits, leaving the high byte of the
+// address on the rest of the bus
+constexpr auto openBus = 0x40U;
+
+constexpr auto toU8(auto value) { return static_cast<uint8_t>(value); }
+constexpr auto toU16(auto value) { return static_cast<uint16_t>(value); }
+
+// CPU cycle at which the PPU reaches the second dot of a frame's scanline
+constexpr auto lineCycle(uint64_t frame, uint64_t line) -> uint64_t {
+	using P = microlator::Ppu;
+	constexpr auto frameDots = uint64_t{P::dotsPerLine} * P::linesPerFrame;
+
+	const auto dot = frame * frameDots + line * P::dotsPerLine + 1;
+	return (dot + P::dotsPerCycle - 1) / P::dotsPerCycle;
+}
+
+} // namespace
+
+namespace microlator {
+
+auto Ppu::read(uint16_t address) -> uint8_t {
+	constexpr auto vblankBit = 0x80U;
+
+	switch (address & 0x07U) {
+	case PPUSTATUS: {
+		const auto status = vblank ? vblankBit : 0;
+		vblank = false;
+		secondWrite = false;
+		return toU8(status);
+	}
+	case OAMDATA:
+		return oam[oamAddress];
+	case PPUDATA: {
+		// Reads are delayed by a buffer, except from the palettes,
+		// which put the name table byte underneath them in the buffer
+		// instead
+		const auto target = toU16(this->address & vramMask);
+		auto value = readBuffer;
+		if (target >= paletteStart) {
+			value = vram[target];
+			readBuffer = vram[target - 0x1000U];
+		} else {
+			readBuffer = vram[target];
+		}
+
+		this->address += (control & 0x04U) ? 32 : 1;
+		return value;
+	}
+	default:
+		return 0;
+	}
+}
+
+auto Ppu::write(uint16_t address, uint8_t value) -> bool {
+	switch (address & 0x07U) {
+	case PPUCTRL: {
+		const auto wasEnabled = nmiEnabled();
+		control = value;
+		return vblank && !wasEnabled && nmiEnabled();
+	}
+	case PPUMASK:
+		mask = value;
+		break;
+	case OAMADDR:
+		oamAddress = value;
+		break;
+	case OAMDATA:
+		oam[oamAddress++] = value;
+		break;
+	case PPUSCROLL:
+		// Scrolling only affects rendering
+		secondWrite = !secondWrite;
+		break;
+	case PPUADDR:
+		this->address =
+		    secondWrite ? toU16((this->address & 0xff00U) | value)
+				: toU16(((value & 0x3fU) << 8U) |
+					(this->address & 0xffU));
+		secondWrite = !secondWrite;
+		break;
+	case PPUDATA:
+		vram[this->address & vramMask] = value;
+		this->address += (control & 0x04U) ? 32 : 1;
+		break;
+	default:
+		break;
+	}
+
+	return false;
+}
+
+void Ppu::reset() { *this = Ppu{}; }
+
+auto Ppu::startVblank() -> bool {
+	frame++;
+	vblank = true;
+	return nmiEnabled();
+}
+
+void Ppu::endVblank() { vblank = false; }
+
+auto Ppu::nmiEnabled() const -> bool { return (control & 0x80U) != 0; }
+
+Nes::Nes(std::span<const uint8_t> image) {
+	if (image.size() < headerSize || image[0] != 'N' || image[1] != 'E' ||
+	    image[2] != 'S' || image[3] != 0x1a)
+		throw std::invalid_argument{"Not an iNES image"};
+
+	const auto prgSize = size_t{image[4]} * prgBankSize;
+	const auto chrSize = size_t{image[5]} * chrBankSize;
+	const auto mapper = (image[6] >> 4U) | (image[7] & 0xf0U);
+	const auto prgStart =
+	    headerSize + ((image[6] & trainerBit) ? trainerSize : 0);
+
+	if (mapper != 0)
+		throw std::invalid_argument{"Unsupported mapper"};
+	if (prgSize == 0 || prgSize > CPU::memorySize - romStart)
+		throw std::invalid_argument{"Unsupported PRG ROM size"};
+	if (chrSize > chrBankSize)
+		throw std::invalid_argument{"Unsupported CHR ROM size"};
+	if (image.size() < prgStart + prgSize + chrSize)
+		throw std::invalid_argument{"iNES image is truncated"};
+
+	const auto *prgBegin = image.data() + prgStart;
+	prg.assign(prgBegin, prgBegin + prgSize);
+	chr.assign(prgBegin + prgSize, prgBegin + prgSize + chrSize);
+
+	// The RAM itself is left in plain memory, where most accesses go. The
+	// cartridge is copied into memory too, in read-only pages
+	cpu.map(*this, (ramMask + 1) / CPU::pageSize, ioStart / CPU::pageSize);
+	cpu.protect(romStart / CPU::pageSize, CPU::pageCount - 1);
+
+	reset();
+}
+
+void Nes::reset() {
+	constexpr auto resetVector = 0xfffcU;
+
+	cpu.reset();
+	ppu.reset();
+	scheduler = Scheduler{};
+	shifters = {};
+	strobe = false;
+
+	for (auto offset = size_t{romStart}; offset < CPU::memorySize;
+	     offset += prg.size())
+		std::ranges::copy(prg, cpu.memory.begin() + offset);
+	std::ranges::copy(chr, ppu.vram.begin());
+
+	cpu.pc = toU16(cpu.memory[resetVector] |
+		       (cpu.memory[resetVector + 1] << 8U));
+	scheduler.schedule(vblankCycle(0), [this] { startVblank(); });
+}
+
+auto Nes::runFrames(uint64_t frames) -> bool {
+	if (frames == 0)
+		return true;
+
+	return scheduler.run(cpu, vblankCycle(ppu.frame + frames - 1));
+}
+
+auto Nes::vblankCycle(uint64_t frame) -> uint64_t {
+	return lineCycle(frame, Ppu::vblankLine);
+}
+
+auto Nes::read(const CPU &cpu, uint16_t address) -> uint8_t {
+	if (address < ppuStart)
+		return cpu.memory[address & ramMask];
+
+	if (address < ioStart)
+		return ppu.read(address);
+
+	switch (address) {
+	case joy1:
+	case joy2: {
+		// While strobed the controllers continuously reload, so only
+		// the first button can be read. Once all buttons have been
+		// shifted out, reads return 1
+		auto &shifter = shifters[address - joy1];
+		if (strobe)
+			return toU8(openBus | (buttons[address - joy1] & A));
+
+		const auto bit = shifter & 0x01U;
+		shifter = toU8((shifter >> 1U) | 0x80U);
+		return toU8(openBus | bit);
+	}
+	default:
+		return 0;
+	}
+}
+
+void Nes::write(CPU &cpu, uint16_t address, uint8_t value) {
+	if (address < ppuStart) {
+		cpu.memory[address & ramMask] = value;
+		return;
+	}
+
+	if (address < ioStart) {
+		if (ppu.write(address, value))
+			scheduler.schedule(cpu.cycle, [&cpu] { cpu.nmi(); });
+		return;
+	}
+
+	switch (address) {
+	case oamDmaRegister:
+		oamDma(value);
+		break;
+	case joy1:
+		// Buttons are latched while the strobe is held, and kept once
+		// it is released
+		if (strobe || (value & 0x01U))
+			shifters = buttons;
+		strobe = (value & 0x01U) != 0;
+		break;
+	default:
+		break;
+	}
+}
+
+void Nes::startVblank() {
+	if (ppu.startVblank())
+		cpu.nmi();
+
+	const auto frame = ppu.frame - 1;
+	scheduler.schedule(lineCycle(frame, Ppu::linesPerFrame - 1),
+			   [this] { endVblank(); });
+	scheduler.schedule(vblankCycle(frame + 1), [this] { startVblank(); });
+}
+
+void Nes::endVblank() { ppu.endVblank(); }
+
+// Copy a page into OAM all at once, charging the cycles the CPU would have
+// been stalled for while it was transferred a byte at a time
+void Nes::oamDma(uint8_t page) {
+	const auto stall = oamDmaCycles + (cpu.cycle & 1U);
+
+	for (auto offset = 0U; offset < CPU::pageSize; offset++) {
+		const auto address = toU16((page << 8U) | offset);
+		const auto value = address < expansionStart
+				       ? read(cpu, address)
+				       : cpu.memory[address];
+		ppu.oam[toU8(ppu.oamAddress + offset)] = value;
+	}
+
+	cpu.cycle += stall;
+}
+
+} // namespace microlator
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "cpu.hpp"
+#include "device.hpp"
+#include "scheduler.hpp"
+
+namespace microlator {
+
+// Headless model of the NES picture processing unit's CPU interface. Nothing
+// is drawn: only the registers, video memory and the vertical blank flag are
+// kept, the latter driven by events scheduled by the Nes
+class Ppu {
+public:
+	constexpr static auto dotsPerLine = 341U;
+	constexpr static auto linesPerFrame = 262U;
+	constexpr static auto dotsPerCycle = 3U;
+	// Vertical blank starts on the second dot of this scanline, and ends on
+	// the second dot of the last
+	constexpr static auto vblankLine = 241U;
+
+	enum Register : uint8_t {
+		PPUCTRL = 0,
+		PPUMASK = 1,
+		PPUSTATUS = 2,
+		OAMADDR = 3,
+		OAMDATA = 4,
+		PPUSCROLL = 5,
+		PPUADDR = 6,
+		PPUDATA = 7,
+	};
+
+	auto read(uint16_t address) -> uint8_t;
+	// Returns whether an NMI should be raised, as when NMIs are enabled
+	// during vertical blank
+	auto write(uint16_t address, uint8_t value) -> bool;
+	void reset();
+
+	// Returns whether an NMI should be raised
+	auto startVblank() -> bool;
+	void endVblank();
+
+	// Frames started so far, counted at the start of vertical blank
+	uint64_t frame{0};
+	bool vblank{false};
+	uint8_t control{0};
+	uint8_t mask{0};
+	uint8_t oamAddress{0};
+	std::array<uint8_t, 0x100> oam{};
+	// Pattern tables, name tables and palettes, without mirroring
+	std::array<uint8_t, 0x4000> vram{};
+
+private:
+	[[nodiscard]] auto nmiEnabled() const -> bool;
+
+	uint16_t address{0};
+	// Whether the next PPUSCROLL or PPUADDR write is the second of a pair
+	bool secondWrite{false};
+	uint8_t readBuffer{0};
+};
+
+// Headless NES, for running game logic without a display or sound. Supports
+// iNES images using mapper 0 (NROM). The APU's registers are accepted but
+// ignored
+class Nes : public Device {
+public:
+	// Controller buttons, as bits of each element of buttons
+	enum Button : uint8_t {
+		A = 0x01,
+		B = 0x02,
+		Select = 0x04,
+		Start = 0x08,
+		Up = 0x10,
+		Down = 0x20,
+		Left = 0x40,
+		Right = 0x80,
+	};
+
+	// Cycles the CPU is stalled by OAM DMA, plus one if it starts on an odd
+	// cycle
+	constexpr static auto oamDmaCycles = 513U;
+
+	// cpu maps pages to this device and scheduler's events refer to it, so
+	// it can't be copied or moved
+	explicit Nes(std::span<const uint8_t> image);
+	Nes(const Nes &) = delete;
+	Nes(Nes &&) = delete;
+	auto operator=(const Nes &) -> Nes & = delete;
+	auto operator=(Nes &&) -> Nes & = delete;
+	~Nes() override = default;
+
+	// Power on, starting at the cartridge's reset vector
+	void reset();
+	// Run until the given number of frames have started. Returns false if
+	// the CPU reached an unimplemented instruction
+	auto runFrames(uint64_t frames) -> bool;
+
+	// CPU cycle at which the given frame's vertical blank starts
+	[[nodiscard]] static auto vblankCycle(uint64_t frame) -> uint64_t;
+
+	auto read(const CPU &cpu, uint16_t address) -> uint8_t override;
+	void write(CPU &cpu, uint16_t address, uint8_t value) override;
+
+	CPU cpu;
+	Scheduler scheduler;
+	Ppu ppu;
+	// Buttons held on each controller
+	std::array<uint8_t, 2> buttons{};
+
+private:
+	void startVblank();
+	void endVblank();
+	void oamDma(uint8_t page);
+
+	std::vector<uint8_t> prg;
+	std::vector<uint8_t> chr;
+	// Buttons latched by the last strobe, shifted out one bit per read
+	std::array<uint8_t, 2> shifters{};
+	bool strobe{false};
+};
+
+} // namespace microlator
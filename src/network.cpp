@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+#include "network.hpp"
+
+namespace {
+
+constexpr auto registerMask = 0x07U;
+
+auto threadCount(unsigned threads) -> unsigned {
+	if (threads != 0)
+		return threads;
+
+	return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+} // namespace
+
+namespace microlator {
+
+Port::Port(Network &network, size_t node) : network{network}, node{node} {}
+
+auto Port::read(const CPU &cpu, uint16_t address) -> uint8_t {
+	const auto *message = network.next(node, cpu.cycle);
+
+	switch (address & registerMask) {
+	case Destination:
+		return destination;
+	case Receive: {
+		if (message == nullptr)
+			return 0;
+
+		const auto data = message->data;
+		network.receive(node);
+		return data;
+	}
+	case Status:
+		return message != nullptr ? 1 : 0;
+	case Source:
+		return message != nullptr
+			   ? static_cast<uint8_t>(message->source)
+			   : 0;
+	default:
+		return 0;
+	}
+}
+
+void Port::write(CPU &cpu, uint16_t address, uint8_t value) {
+	switch (address & registerMask) {
+	case Destination:
+		destination = value;
+		break;
+	case Send:
+		network.send(node, destination, cpu.cycle, value);
+		break;
+	default:
+		break;
+	}
+}
+
+Network::Network(size_t nodes, std::span<const Link> links, uint8_t portPage)
+    : cpus(nodes), nodes(nodes),
+      window{std::numeric_limits<uint64_t>::max()} {
+	for (auto i = size_t{0}; i < nodes; i++) {
+		auto &node = this->nodes[i];
+		node.port = std::make_unique<Port>(*this, i);
+		cpus[i].map(*node.port, portPage, portPage);
+	}
+
+	for (const auto &link : links) {
+		if (link.from >= nodes || link.to >= nodes ||
+		    link.from == link.to)
+			throw std::invalid_argument{
+			    "Link between invalid CPUs"};
+		if (link.latency == 0)
+			throw std::invalid_argument{"Links must have latency"};
+
+		auto &from = this->nodes[link.from];
+		const auto linked = [&](const auto *channel) {
+			return channel->link.to == link.to;
+		};
+		if (std::ranges::any_of(from.outgoing, linked))
+			throw std::invalid_argument{"Duplicate link"};
+
+		auto &channel =
+		    *channels.emplace_back(std::make_unique<Channel>());
+		channel.link = link;
+		from.outgoing.push_back(&channel);
+		this->nodes[link.to].incoming.push_back(&channel);
+		window = std::min(window, link.latency);
+	}
+}
+
+auto Network::run(uint64_t untilCycle, unsigned threads) -> bool {
+	if (nodes.empty())
+		return true;
+
+	const auto workers =
+	    std::min<size_t>(threadCount(threads), nodes.size());
+	const auto windowEnd = [&] {
+		return untilCycle - now <= window ? untilCycle : now + window;
+	};
+
+	// Messages are moved into inboxes between windows, while only one thread
+	// runs, so which a CPU sees and which are dropped doesn't depend on how
+	// threads interleave
+	auto end = windowEnd();
+	auto halted = std::atomic<bool>{false};
+	auto sync = std::barrier{static_cast<std::ptrdiff_t>(workers),
+				 [&]() noexcept {
+					 for (auto &node : nodes)
+						 collect(node);
+
+					 now = end;
+					 end = windowEnd();
+				 }};
+
+	{
+		std::vector<std::jthread> pool;
+		for (auto worker = size_t{0}; worker < workers; worker++) {
+			pool.emplace_back([&, worker] {
+				// Every worker reads the same state after each
+				// barrier, so all stop after the same window
+				while (now < untilCycle && !halted) {
+					for (auto i = worker; i < nodes.size();
+					     i += workers) {
+						if (!cpus[i].run(end))
+							halted = true;
+					}
+
+					sync.arrive_and_wait();
+				}
+			});
+		}
+	}
+
+	return !halted;
+}
+
+auto Network::dropped() const noexcept -> uint64_t {
+	auto total = uint64_t{0};
+	for (const auto &node : nodes)
+		total += node.dropped;
+
+	return total;
+}
+
+void Network::send(size_t node, uint8_t destination, uint64_t cycle,
+		   uint8_t data) {
+	auto &sender = nodes[node];
+	const auto channel = std::ranges::find(
+	    sender.outgoing, destination,
+	    [](const auto *channel) { return channel->link.to; });
+
+	if (channel == sender.outgoing.end() ||
+	    !(*channel)->queue.push({cycle + (*channel)->link.latency, node,
+				     (*channel)->sent, data})) {
+		sender.dropped++;
+		return;
+	}
+
+	(*channel)->sent++;
+}
+
+// Only messages sent during the window which just ended are queued, and none
+// can arrive before it ended. Sorting by sender as well as arrival makes the
+// order deterministic
+void Network::collect(Node &node) {
+	const auto later = [](const Message &a, const Message &b) {
+		return std::tie(a.arrival, a.source, a.sequence) >
+		       std::tie(b.arrival, b.source, b.sequence);
+	};
+
+	for (auto *channel : node.incoming) {
+		while (const auto message = channel->queue.pop()) {
+			const auto position = std::ranges::upper_bound(
+			    node.inbox, *message, later);
+			node.inbox.insert(position, *message);
+		}
+	}
+}
+
+auto Network::next(size_t node, uint64_t cycle) const -> const Message * {
+	const auto &inbox = nodes[node].inbox;
+	if (inbox.empty() || inbox.back().arrival > cycle)
+		return nullptr;
+
+	return &inbox.back();
+}
+
+void Network::receive(size_t node) { nodes[node].inbox.pop_back(); }
+
+} // namespace microlator
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "cpu.hpp"
+#include "device.hpp"
+#include "spscqueue.hpp"
+
+namespace microlator {
+
+class Network;
+
+// A one way connection between two CPUs of a Network, over which a byte sent
+// at some cycle arrives latency cycles later
+struct Link {
+	size_t from{0};
+	size_t to{0};
+	uint64_t latency{1};
+};
+
+// Device through which a CPU of a Network sends and receives messages
+class Port : public Device {
+public:
+	// Registers, mirrored through the page the port is mapped to
+	enum Register : uint8_t {
+		// CPU which Send sends to
+		Destination = 0,
+		// Write a byte to send
+		Send = 1,
+		// Read the earliest byte which has arrived, or 0 if none has
+		Receive = 2,
+		// Read whether a byte has arrived
+		Status = 3,
+		// Read which CPU sent the byte Receive would return
+		Source = 4,
+	};
+
+	Port(Network &network, size_t node);
+
+	auto read(const CPU &cpu, uint16_t address) -> uint8_t override;
+	void write(CPU &cpu, uint16_t address, uint8_t value) override;
+
+private:
+	Network &network;
+	size_t node;
+	uint8_t destination{0};
+};
+
+// Runs many CPUs in parallel which only communicate by sending messages to
+// each other over links with known latencies.
+// As no message can arrive sooner than the shortest latency after it was
+// sent, the CPUs can run independently for windows of that many cycles.
+// Messages sent during a window are passed through lock-free queues, and
+// sorted into each receiver's inbox by arrival cycle and sender once every
+// CPU has finished it, so results are the same however many threads run
+// them. A CPU may see a message up to an instruction late, as windows end on
+// instruction boundaries
+class Network {
+public:
+	// Messages which can be in flight over each link in a window before
+	// any more are dropped
+	constexpr static auto linkCapacity = size_t{1024};
+
+	// Each CPU gets a Port mapped to portPage
+	Network(size_t nodes, std::span<const Link> links, uint8_t portPage);
+	Network(const Network &) = delete;
+	Network(Network &&) = delete;
+	auto operator=(const Network &) -> Network & = delete;
+	auto operator=(Network &&) -> Network & = delete;
+	~Network() = default;
+
+	// Run every CPU until the given cycle, spreading them across threads.
+	// Returns false if any CPU reached an unimplemented instruction, in
+	// which case all stop at the end of that window
+	auto run(uint64_t untilCycle, unsigned threads = 0) -> bool;
+
+	// Messages dropped because there was no link to their destination, or
+	// its queue was full
+	[[nodiscard]] auto dropped() const noexcept -> uint64_t;
+
+	std::vector<CPU> cpus;
+
+private:
+	friend class Port;
+
+	struct Message {
+		uint64_t arrival;
+		size_t source;
+		uint64_t sequence;
+		uint8_t data;
+	};
+
+	struct Channel {
+		Link link;
+		SpscQueue<Message, linkCapacity> queue;
+		uint64_t sent{0};
+	};
+
+	struct Node {
+		std::unique_ptr<Port> port;
+		std::vector<Channel *> outgoing;
+		std::vector<Channel *> incoming;
+		// Sorted latest first, so that the next message can be popped
+		std::vector<Message> inbox;
+		uint64_t dropped{0};
+	};
+
+	void send(size_t node, uint8_t destination, uint64_t cycle,
+		  uint8_t data);
+	// Move messages from the queues into a node's inbox
+	void collect(Node &node);
+	[[nodiscard]] auto next(size_t node, uint64_t cycle) const
+	    -> const Message *;
+	void receive(size_t node);
+
+	std::vector<std::unique_ptr<Channel>> channels;
+	std::vector<Node> nodes;
+	uint64_t window{0};
+	uint64_t now{0};
+};
+
+} // namespace microlator
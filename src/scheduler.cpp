@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "scheduler.hpp"
+
+namespace microlator {
+
+auto Scheduler::schedule(uint64_t cycle, Event event) -> Id {
+	const auto id = nextId++;
+	const auto later = [](const Entry &entry, uint64_t value) {
+		return entry.cycle > value;
+	};
+
+	// Insert after every later event and before every earlier one, so that
+	// events due at the same cycle are popped in the order they were added
+	const auto position =
+	    std::lower_bound(events.begin(), events.end(), cycle, later);
+	events.insert(position, {cycle, id, std::move(event)});
+	horizon = std::min(horizon, cycle);
+	return id;
+}
+
+auto Scheduler::cancel(Id id) -> bool {
+	const auto entry = std::ranges::find(events, id, &Entry::id);
+	if (entry == events.end())
+		return false;
+
+	events.erase(entry);
+	return true;
+}
+
+void Scheduler::setIrq(unsigned source, bool asserted) {
+	if (source >= irqSources)
+		throw std::out_of_range{"IRQ source out of range"};
+
+	const auto mask = uint32_t{1} << source;
+	irqLines = asserted ? (irqLines | mask) : (irqLines & ~mask);
+}
+
+auto Scheduler::run(CPU &cpu, uint64_t untilCycle) -> bool {
+	const auto interruptible = [&] {
+		return irqLines != 0 &&
+		       !cpu.flags.test(Flags::Index::InterruptOff);
+	};
+
+	while (true) {
+		dispatch(cpu.cycle);
+		if (interruptible())
+			cpu.irq();
+
+		if (cpu.cycle >= untilCycle)
+			return true;
+
+		// Devices may schedule events while the CPU runs, which lower
+		// the horizon
+		horizon = std::min(untilCycle, nextEvent());
+		do {
+			if (!cpu.step())
+				return false;
+		} while (cpu.cycle < horizon && !interruptible());
+	}
+}
+
+auto Scheduler::nextEvent() const -> uint64_t {
+	return events.empty() ? never : events.back().cycle;
+}
+
+auto Scheduler::irqAsserted() const -> bool { return irqLines != 0; }
+
+void Scheduler::dispatch(uint64_t cycle) {
+	// Events may schedule or cancel others, so the entry is removed before
+	// it is called
+	while (!events.empty() && events.back().cycle <= cycle) {
+		auto event = std::move(events.back().event);
+		events.pop_back();
+		event();
+	}
+}
+
+} // namespace microlator
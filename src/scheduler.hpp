@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "cpu.hpp"
+
+namespace microlator {
+
+// Runs a CPU while dispatching events at the cycles they were scheduled for.
+// Events and interrupts are delivered between instructions, so the CPU runs
+// uninterrupted from one event to the next
+class Scheduler {
+public:
+	using Event = std::function<void()>;
+	using Id = uint64_t;
+
+	constexpr static auto never = std::numeric_limits<uint64_t>::max();
+	constexpr static auto irqSources = 32U;
+
+	// Call event once the CPU reaches cycle. Events due at the same cycle
+	// are dispatched in the order they were scheduled
+	auto schedule(uint64_t cycle, Event event) -> Id;
+	// Returns whether the event was still pending
+	auto cancel(Id id) -> bool;
+	// Hold or release the IRQ line on behalf of one of irqSources devices.
+	// The CPU is interrupted while any source holds it, unless it has
+	// interrupts disabled
+	void setIrq(unsigned source, bool asserted);
+
+	// Run until the CPU reaches untilCycle, dispatching every event due by
+	// then. Returns false if the CPU reached an unimplemented instruction
+	auto run(CPU &cpu, uint64_t untilCycle) -> bool;
+
+	// Cycle of the earliest pending event, or never
+	[[nodiscard]] auto nextEvent() const -> uint64_t;
+	[[nodiscard]] auto irqAsserted() const -> bool;
+
+private:
+	struct Entry {
+		uint64_t cycle;
+		Id id;
+		Event event;
+	};
+
+	void dispatch(uint64_t cycle);
+
+	// Sorted latest first, so that the next event can be popped
+	std::vector<Entry> events;
+	Id nextId{0};
+	// Cycle at which run() must next stop stepping the CPU
+	uint64_t horizon{never};
+	uint32_t irqLines{0};
+};
+
+} // namespace microlator
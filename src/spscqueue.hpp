@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <optional>
+
+namespace microlator {
+
+// Bounded lock-free queue for one producer thread and one consumer thread
+template <class T, size_t Capacity> class SpscQueue {
+	static_assert((Capacity & (Capacity - 1)) == 0,
+		      "Capacity must be a power of two");
+
+public:
+	// Returns false if the queue is full
+	auto push(const T &item) noexcept -> bool;
+	auto pop() noexcept -> std::optional<T>;
+
+private:
+	// Keep the indices on separate cache lines, as each is written by a
+	// different thread
+	constexpr static auto lineSize = size_t{64};
+
+	std::array<T, Capacity> items{};
+	alignas(lineSize) std::atomic<size_t> head{0};
+	alignas(lineSize) std::atomic<size_t> tail{0};
+};
+
+template <class T, size_t Capacity>
+auto SpscQueue<T, Capacity>::push(const T &item) noexcept -> bool {
+	const auto position = tail.load(std::memory_order_relaxed);
+	if (position - head.load(std::memory_order_acquire) == Capacity)
+		return false;
+
+	items[position % Capacity] = item;
+	tail.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+template <class T, size_t Capacity>
+auto SpscQueue<T, Capacity>::pop() noexcept -> std::optional<T> {
+	const auto position = head.load(std::memory_order_relaxed);
+	if (position == tail.load(std::memory_order_acquire))
+		return std::nullopt;
+
+	auto item = items[position % Capacity];
+	head.store(position + 1, std::memory_order_release);
+	return item;
+}
+
+} // namespace microlator
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "cpu.hpp"
+
+namespace microlator {
+
+// Taint policy used by CPU::step(), whose labels carry no information so that
+// all propagation compiles away
+struct NoTaint {
+	struct Label {
+		constexpr auto operator|(Label) const noexcept -> Label {
+			return {};
+		}
+	};
+
+	Label accumulator;
+	Label indexX;
+	Label indexY;
+
+	[[nodiscard]] constexpr auto of(const ValueStore &) const noexcept
+	    -> Label {
+		return {};
+	}
+	constexpr void set(const ValueStore &, Label) noexcept {}
+	[[nodiscard]] constexpr auto load(uint16_t) const noexcept -> Label {
+		return {};
+	}
+	constexpr void store(uint16_t, Label) noexcept {}
+	[[nodiscard]] constexpr auto flag(Flags::Index) const noexcept
+	    -> Label {
+		return {};
+	}
+	[[nodiscard]] constexpr auto allFlags() const noexcept -> Label {
+		return {};
+	}
+	template <class... Args>
+	constexpr void setFlags(Label, Args...) noexcept {}
+};
+
+// Shadow state for CPU::step(TaintState &), which gives every register and
+// memory byte a label. Each bit of a label stands for one input source, so
+// labels combine with bitwise or.
+// Only data flow is tracked: addresses, the stack pointer and the program
+// counter carry no label, and branches do not taint what they guard
+struct TaintState {
+	using Label = uint8_t;
+
+	Label accumulator{0};
+	Label indexX{0};
+	Label indexY{0};
+
+	// Each flag is labelled separately, so that e.g. the carry out of a
+	// multi-byte addition keeps its label across the loads in between
+	std::array<Label, 8> flags{};
+
+	std::array<Label, CPU::memorySize> memory{};
+
+	// Label of the value a ValueStore refers to. Immediate values are part
+	// of the program, so are not labelled
+	[[nodiscard]] constexpr auto of(const ValueStore &store) const noexcept
+	    -> Label;
+	constexpr void set(const ValueStore &store, Label label) noexcept;
+	[[nodiscard]] constexpr auto load(uint16_t address) const noexcept
+	    -> Label;
+	constexpr void store(uint16_t address, Label label) noexcept;
+	[[nodiscard]] constexpr auto flag(Flags::Index i) const noexcept
+	    -> Label;
+	// Union of the labels of all flags, e.g. when pushed to the stack
+	[[nodiscard]] constexpr auto allFlags() const noexcept -> Label;
+	template <class... Args>
+	constexpr void setFlags(Label label, Args... indices) noexcept;
+};
+
+constexpr auto TaintState::of(const ValueStore &store) const noexcept
+    -> Label {
+	switch (store.getType()) {
+	case ValueStore::Type::Accumulator:
+		return accumulator;
+	case ValueStore::Type::Memory:
+		return memory[store.get()];
+	case ValueStore::Type::Implicit:
+	case ValueStore::Type::Value:
+		break;
+	}
+
+	return 0;
+}
+
+constexpr void TaintState::set(const ValueStore &store, Label label) noexcept {
+	switch (store.getType()) {
+	case ValueStore::Type::Accumulator:
+		accumulator = label;
+		return;
+	case ValueStore::Type::Memory:
+		memory[store.get()] = label;
+		return;
+	case ValueStore::Type::Implicit:
+	case ValueStore::Type::Value:
+		break;
+	}
+}
+
+constexpr auto TaintState::load(uint16_t address) const noexcept -> Label {
+	return memory[address];
+}
+
+constexpr void TaintState::store(uint16_t address, Label label) noexcept {
+	memory[address] = label;
+}
+
+constexpr auto TaintState::flag(Flags::Index i) const noexcept -> Label {
+	return flags[static_cast<uint8_t>(i)];
+}
+
+constexpr auto TaintState::allFlags() const noexcept -> Label {
+	Label result = 0;
+	for (const auto label : flags)
+		result |= label;
+
+	return result;
+}
+
+template <class... Args>
+constexpr void TaintState::setFlags(Label label, Args... indices) noexcept {
+	((flags[static_cast<uint8_t>(indices)] = label), ...);
+}
+
+} // namespace microlator
@@ -0,0 +1,337 @@
+#include <algorithm>
+
+#include "analysis.hpp"
+#include "tiered.hpp"
+
+namespace {
+
+using microlator::Mnemonic;
+
+// Cycles taken by the slowest instruction, BRK or a read-modify-write with
+// an index
+constexpr auto maxInstructionCycles = 7U;
+
+constexpr auto endsBlock(Mnemonic mnemonic) -> bool {
+	using M = Mnemonic;
+
+	switch (mnemonic) {
+	case M::BCC:
+	case M::BCS:
+	case M::BEQ:
+	case M::BMI:
+	case M::BNE:
+	case M::BPL:
+	case M::BVC:
+	case M::BVS:
+	case M::BRK:
+	case M::JMP:
+	case M::JSR:
+	case M::RTI:
+	case M::RTS:
+	case M::None:
+		return true;
+	default:
+		return false;
+	}
+}
+
+} // namespace
+
+namespace microlator {
+
+TieredEngine::TieredEngine(CPU &cpu, uint32_t blockThreshold,
+			   uint32_t optimizeThreshold)
+    : cpu{cpu}, blockThreshold{blockThreshold},
+      optimizeThreshold{optimizeThreshold}, counts(CPU::memorySize),
+      invalidations(CPU::memorySize) {}
+
+TieredEngine::~TieredEngine() {
+	for (auto page = 0U; page < CPU::pageCount; page++) {
+		if (!pageBlocks.at(page).empty())
+			cpu.unwatch(page, page);
+	}
+}
+
+auto TieredEngine::run(uint64_t untilCycle, uint64_t instructions) -> bool {
+	Block *next = nullptr;
+	remaining = instructions;
+	while (cpu.cycle < untilCycle && remaining > 0) {
+		auto *block = next ? next : find(cpu.pc);
+		next = nullptr;
+		if (block) {
+			// A block stopped early is resumed by the interpreter
+			atBlockStart = execute(*block, untilCycle);
+			if (atBlockStart && !currentInvalidated)
+				next = follow(*block);
+
+			retired.clear();
+			continue;
+		}
+
+		if (atBlockStart && invalidations[cpu.pc] < maxInvalidations &&
+		    ++counts[cpu.pc] >= blockThreshold && translate(cpu.pc))
+			continue;
+
+		const auto mnemonic = cpu.decode(cpu.pc).mnemonic;
+		if (!cpu.step())
+			return false;
+
+		stats.interpreted++;
+		remaining--;
+		atBlockStart = endsBlock(mnemonic);
+	}
+
+	return true;
+}
+
+void TieredEngine::flush() {
+	while (!blocks.empty())
+		invalidate(blocks.begin()->first);
+
+	std::fill(counts.begin(), counts.end(), 0);
+	std::fill(invalidations.begin(), invalidations.end(), 0);
+	atBlockStart = true;
+}
+
+auto TieredEngine::tier(uint16_t address) const -> Tier {
+	const auto it = blocks.find(address);
+	return (it != blocks.end()) ? it->second->tier : Tier::Interpreter;
+}
+
+auto TieredEngine::statistics() const noexcept -> const Statistics & {
+	return stats;
+}
+
+void TieredEngine::written(const CPU &writer, uint16_t address) {
+	if (&writer != &cpu)
+		return;
+
+	std::vector<uint16_t> stale;
+	for (const auto start : pageBlocks.at(address / CPU::pageSize)) {
+		const auto &block = *blocks.at(start);
+		if (address >= block.start &&
+		    address < block.start + block.size)
+			stale.push_back(start);
+	}
+
+	for (const auto start : stale)
+		invalidate(start);
+}
+
+// Whether an instruction accesses a known address in a page mapped to a
+// device, which may change memory or the mapping, e.g. by switching banks
+auto TieredEngine::accessesDevice(const DecodedInstruction &instruction) const
+    -> bool {
+	using Mode = AddressMode;
+
+	switch (instruction.addressMode) {
+	case Mode::Absolute:
+		return cpu.mapped(instruction.operand);
+	case Mode::AbsoluteX:
+	case Mode::AbsoluteY:
+		return cpu.mapped(instruction.operand) ||
+		       cpu.mapped(static_cast<uint16_t>(instruction.operand +
+							 CPU::pageSize - 1));
+	default:
+		return false;
+	}
+}
+
+// Decode the block starting at start, if it contains any instructions
+auto TieredEngine::translate(uint16_t start) -> bool {
+	auto block = std::make_unique<Block>();
+	block->start = start;
+
+	auto address = uint32_t{start};
+	while (block->operations.size() < maxBlockLength) {
+		const auto instruction = cpu.decode(address);
+		const auto end = address + instruction.length;
+		if (instruction.mnemonic == Mnemonic::None ||
+		    end > CPU::memorySize || cpu.mapped(address) ||
+		    cpu.mapped(end - 1))
+			break;
+
+		block->operations.push_back(
+		    {instruction, CPU::allFlags, mayStopAfter(instruction)});
+		address = end;
+		if (endsBlock(instruction.mnemonic) ||
+		    accessesDevice(instruction))
+			break;
+	}
+
+	if (block->operations.empty()) {
+		// Leave it to the interpreter until it is modified
+		invalidations[start] = maxInvalidations;
+		return false;
+	}
+
+	block->size = static_cast<uint16_t>(address - start);
+	block->maxCycles = block->operations.size() * maxInstructionCycles;
+
+	const auto firstPage = start / CPU::pageSize;
+	const auto lastPage = (address - 1) / CPU::pageSize;
+	for (auto page = firstPage; page <= lastPage; page++) {
+		auto &starts = pageBlocks.at(page);
+		if (starts.empty())
+			cpu.watch(*this, page, page);
+
+		starts.push_back(start);
+	}
+
+	blocks.emplace(start, std::move(block));
+	stats.blocksTranslated++;
+	return true;
+}
+
+// Skip computing flags which are overwritten before being read, and fold
+// constant indexes into addresses
+void TieredEngine::optimize(Block &block) {
+	std::vector<DecodedInstruction> instructions;
+	instructions.reserve(block.operations.size());
+	for (const auto &operation : block.operations)
+		instructions.push_back(operation.instruction);
+
+	const auto analysis = analyse(instructions);
+	for (auto i = size_t{0}; i < block.operations.size(); i++) {
+		auto &operation = block.operations[i];
+		operation.instruction =
+		    specialise(operation.instruction, analysis.known[i]);
+		operation.liveFlags = analysis.liveFlags[i];
+	}
+
+	block.tier = Tier::Optimized;
+	stats.blocksOptimized++;
+}
+
+auto TieredEngine::execute(Block &block, uint64_t untilCycle) -> bool {
+	if (block.tier == Tier::Block && ++block.entries >= optimizeThreshold)
+		optimize(block);
+
+	// Flags may only be left stale where the block could not stop
+	// otherwise, so it must be sure to run to its end
+	const auto optimized = block.tier == Tier::Optimized &&
+			       cpu.cycle + block.maxCycles <= untilCycle &&
+			       block.operations.size() <= remaining;
+
+	current = &block;
+	currentInvalidated = false;
+	auto executed = size_t{0};
+	for (const auto &operation : block.operations) {
+		executed++;
+		remaining--;
+		if (optimized) {
+			cpu.execute(operation.instruction, operation.liveFlags);
+			if (!operation.mayStop)
+				continue;
+		} else {
+			cpu.execute(operation.instruction);
+		}
+
+		if (currentInvalidated || cpu.cycle >= untilCycle ||
+		    remaining == 0)
+			break;
+	}
+
+	(optimized ? stats.optimized : stats.predecoded) += executed;
+	current = nullptr;
+	return executed == block.operations.size();
+}
+
+auto TieredEngine::follow(Block &block) -> Block * {
+	using M = Mnemonic;
+
+	const auto mnemonic = block.operations.back().instruction.mnemonic;
+	if (mnemonic == M::RTS || mnemonic == M::RTI) {
+		auto *&cached = returns.at(cpu.pc % returnCacheSize);
+		if (cached && cached->start == cpu.pc) {
+			stats.chained++;
+			return cached;
+		}
+
+		cached = find(cpu.pc);
+		return cached;
+	}
+
+	auto *&successor = (cpu.pc == block.start + block.size)
+			       ? block.fallThrough
+			       : block.taken;
+	// Indirect jumps may lead somewhere else each time
+	if (successor && successor->start == cpu.pc) {
+		stats.chained++;
+		return successor;
+	}
+
+	auto *target = find(cpu.pc);
+	if (target)
+		link(block, successor, *target);
+
+	return target;
+}
+
+auto TieredEngine::find(uint16_t address) -> Block * {
+	const auto it = blocks.find(address);
+	if (it == blocks.end())
+		return nullptr;
+
+	stats.lookups++;
+	return it->second.get();
+}
+
+void TieredEngine::link(Block &from, Block *&successor, Block &to) {
+	if (successor) {
+		auto &predecessors = successor->predecessors;
+		predecessors.erase(std::ranges::find(predecessors, &from));
+	}
+
+	successor = &to;
+	to.predecessors.push_back(&from);
+}
+
+// Discard a block, restarting the count towards translating it
+void TieredEngine::invalidate(uint16_t start) {
+	const auto it = blocks.find(start);
+	if (it == blocks.end())
+		return;
+
+	auto &block = *it->second;
+	const auto firstPage = block.start / CPU::pageSize;
+	const auto lastPage = (block.start + block.size - 1) / CPU::pageSize;
+	for (auto page = firstPage; page <= lastPage; page++) {
+		auto &starts = pageBlocks.at(page);
+		std::erase(starts, start);
+		if (starts.empty())
+			cpu.unwatch(page, page);
+	}
+
+	// Unlink the block from its neighbours
+	for (auto *successor : {block.taken, block.fallThrough}) {
+		if (!successor)
+			continue;
+
+		auto &predecessors = successor->predecessors;
+		predecessors.erase(std::ranges::find(predecessors, &block));
+	}
+
+	for (auto *predecessor : block.predecessors) {
+		if (predecessor->taken == &block)
+			predecessor->taken = nullptr;
+		if (predecessor->fallThrough == &block)
+			predecessor->fallThrough = nullptr;
+	}
+
+	std::ranges::replace(returns, &block, nullptr);
+
+	if (it->second.get() == current) {
+		currentInvalidated = true;
+		retired.push_back(std::move(it->second));
+	}
+
+	blocks.erase(it);
+	counts[start] = 0;
+	if (invalidations[start] < maxInvalidations)
+		invalidations[start]++;
+
+	stats.blocksInvalidated++;
+}
+
+} // namespace microlator
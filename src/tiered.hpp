@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "cpu.hpp"
+#include "device.hpp"
+
+namespace microlator {
+
+// Runs a CPU, promoting code which runs often from the plain interpreter to
+// predecoded blocks, and then to optimized blocks which skip computing flags
+// that are overwritten before being read and fold constant indexes into
+// addresses.
+// Blocks start where control was transferred and end at the next branch,
+// jump, call, return or interrupt, or after an absolute access to a device.
+// A block is translated once its start has been reached blockThreshold
+// times, and optimized once it has been run optimizeThreshold times. Writes
+// by the CPU to a block discard it, and code which keeps being modified is
+// left to the interpreter.
+// Each block links to the blocks it was last left for, by falling through or
+// by a branch or jump being taken, so loops run from block to block without
+// looking them up. Returns are looked up in a small cache instead.
+// Memory changed without notifying watchers, e.g. by the host writing to
+// CPU::memory directly, must be followed by a call to flush(). Writes by
+// copies of the CPU are not watched.
+// The CPU stops where CPU::run() would, or after exactly the number of
+// instructions requested. Devices may only change the cycle count when
+// written, as optimized blocks only check it after writes
+class TieredEngine : public WriteWatcher {
+public:
+	enum class Tier : uint8_t { Interpreter, Block, Optimized };
+
+	struct Statistics {
+		// Instructions run by each tier
+		uint64_t interpreted{0};
+		uint64_t predecoded{0};
+		uint64_t optimized{0};
+		// Blocks translated, optimized and discarded
+		uint64_t blocksTranslated{0};
+		uint64_t blocksOptimized{0};
+		uint64_t blocksInvalidated{0};
+		// Blocks entered through a link from the block before, and
+		// through a lookup by address
+		uint64_t chained{0};
+		uint64_t lookups{0};
+	};
+
+	explicit TieredEngine(CPU &cpu, uint32_t blockThreshold = 8,
+			      uint32_t optimizeThreshold = 256);
+	TieredEngine(const TieredEngine &) = delete;
+	TieredEngine(TieredEngine &&) = delete;
+	auto operator=(const TieredEngine &) -> TieredEngine & = delete;
+	auto operator=(TieredEngine &&) -> TieredEngine & = delete;
+	~TieredEngine() override;
+
+	// Execute instructions until the CPU's cycle reaches untilCycle, or
+	// the given number of instructions have been executed. Returns false
+	// if an unimplemented instruction was reached first
+	auto run(uint64_t untilCycle,
+		 uint64_t instructions = std::numeric_limits<uint64_t>::max())
+	    -> bool;
+	// Discard all blocks and execution counts
+	void flush();
+
+	// Tier which runs code starting at address
+	[[nodiscard]] auto tier(uint16_t address) const -> Tier;
+	[[nodiscard]] auto statistics() const noexcept -> const Statistics &;
+
+	void written(const CPU &cpu, uint16_t address) override;
+
+	constexpr static auto maxBlockLength = 64U;
+	// Times a block may be discarded before its code is left to the
+	// interpreter
+	constexpr static auto maxInvalidations = 4U;
+
+private:
+	constexpr static auto returnCacheSize = 16U;
+
+	struct Operation {
+		DecodedInstruction instruction;
+		// Flags read before being overwritten after this instruction
+		uint8_t liveFlags{CPU::allFlags};
+		// Whether the block may have to stop after this instruction
+		bool mayStop{false};
+	};
+
+	struct Block {
+		uint16_t start{0};
+		// Length in bytes
+		uint16_t size{0};
+		std::vector<Operation> operations;
+		// Upper bound on the cycles taken to run the whole block
+		uint64_t maxCycles{0};
+		uint32_t entries{0};
+		Tier tier{Tier::Block};
+		// Successors, linked once they have been run after this block
+		Block *taken{nullptr};
+		Block *fallThrough{nullptr};
+		// Blocks linked to this one, once for each link
+		std::vector<Block *> predecessors;
+	};
+
+	auto translate(uint16_t start) -> bool;
+	[[nodiscard]] auto
+	accessesDevice(const DecodedInstruction &instruction) const -> bool;
+	void optimize(Block &block);
+	// Returns whether the whole block was run
+	auto execute(Block &block, uint64_t untilCycle) -> bool;
+	// Find the block to run after a block ran to its end
+	auto follow(Block &block) -> Block *;
+	auto find(uint16_t address) -> Block *;
+	void link(Block &from, Block *&successor, Block &to);
+	void invalidate(uint16_t start);
+
+	CPU &cpu;
+	uint32_t blockThreshold;
+	uint32_t optimizeThreshold;
+
+	std::unordered_map<uint16_t, std::unique_ptr<Block>> blocks;
+	// Starts of the blocks overlapping each page
+	std::array<std::vector<uint16_t>, CPU::pageCount> pageBlocks;
+	// Blocks discarded while running, freed once the block has exited
+	std::vector<std::unique_ptr<Block>> retired;
+	// Blocks returned to, indexed by the low bits of their address
+	std::array<Block *, returnCacheSize> returns{};
+	std::vector<uint32_t> counts;
+	std::vector<uint8_t> invalidations;
+
+	// Instructions left to execute in the current run
+	uint64_t remaining{0};
+	Block *current{nullptr};
+	bool currentInvalidated{false};
+	bool atBlockStart{true};
+	Statistics stats;
+};
+
+} // namespace microlator
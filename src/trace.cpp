@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "trace.hpp"
+
+namespace {
+
+// Aim for several segments per thread, so that a slow segment does not leave
+// the others idle
+constexpr auto segmentsPerThread = 16U;
+constexpr auto minimumInterval = uint64_t{4096};
+
+auto threadCount(unsigned threads) -> unsigned {
+	if (threads != 0)
+		return threads;
+
+	return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+} // namespace
+
+namespace microlator {
+
+auto takeCheckpoints(CPU cpu, uint64_t instructions, uint64_t interval)
+    -> Checkpoints {
+	if (interval == 0)
+		throw std::invalid_argument{"Checkpoint interval can't be 0"};
+
+	auto result = Checkpoints{interval, {}};
+	result.states.reserve(instructions / interval + 1);
+	result.states.push_back(cpu);
+
+	for (uint64_t i = 1; i <= instructions; i++) {
+		if (!cpu.step()) {
+			result.halted = true;
+			break;
+		}
+
+		if (i % interval == 0)
+			result.states.push_back(cpu);
+	}
+
+	return result;
+}
+
+auto validateTrace(const Checkpoints &checkpoints,
+		   std::span<const TraceState> trace, unsigned threads)
+    -> std::optional<Divergence> {
+	const auto interval = checkpoints.interval;
+	const auto segments = checkpoints.states.size();
+	if (interval == 0)
+		throw std::invalid_argument{"Checkpoint interval can't be 0"};
+	if (!checkpoints.halted && !trace.empty() &&
+	    (trace.size() - 1) / interval >= segments)
+		throw std::invalid_argument{"Checkpoints end before the trace"};
+
+	std::mutex mutex;
+	std::optional<Divergence> earliest;
+	std::atomic<size_t> earliestIndex{std::numeric_limits<size_t>::max()};
+	std::atomic<size_t> nextSegment{0};
+
+	const auto report = [&](Divergence divergence) {
+		const std::lock_guard lock{mutex};
+		if (!earliest || divergence.index < earliest->index) {
+			earliest = divergence;
+			earliestIndex = divergence.index;
+		}
+	};
+
+	// Segments are handed out in order, and a segment starting after a
+	// known divergence can't contain an earlier one
+	const auto verify = [&] {
+		for (auto segment = nextSegment++; segment < segments;
+		     segment = nextSegment++) {
+			const auto begin = segment * interval;
+			const auto end =
+			    std::min<size_t>(begin + interval, trace.size());
+			auto cpu = checkpoints.states[segment];
+
+			for (auto i = begin; i < end; i++) {
+				if (i >= earliestIndex)
+					break;
+
+				const auto actual = TraceState{cpu};
+				if (actual != trace[i]) {
+					report({i, trace[i], actual});
+					break;
+				}
+
+				if (i + 1 < trace.size() && !cpu.step()) {
+					report({i + 1, trace[i + 1],
+						TraceState{cpu}, true});
+					break;
+				}
+			}
+		}
+	};
+
+	{
+		std::vector<std::jthread> workers;
+		const auto count = std::min<size_t>(threadCount(threads),
+						    segments);
+		for (size_t i = 1; i < count; i++)
+			workers.emplace_back(verify);
+
+		verify();
+	}
+
+	return earliest;
+}
+
+auto validateTrace(const CPU &initial, std::span<const TraceState> trace,
+		   unsigned threads) -> std::optional<Divergence> {
+	if (trace.empty())
+		return {};
+
+	const auto segments = threadCount(threads) * segmentsPerThread;
+	const auto interval =
+	    std::max<uint64_t>(trace.size() / segments, minimumInterval);
+
+	return validateTrace(
+	    takeCheckpoints(initial, trace.size() - 1, interval), trace,
+	    threads);
+}
+
+} // namespace microlator
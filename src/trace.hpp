@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "cpu.hpp"
+
+namespace microlator {
+
+// The registers of a CPU before an instruction is executed, as recorded in a
+// reference trace such as nestest.log
+struct TraceState {
+	uint16_t pc{0};
+	uint8_t accumulator{0};
+	uint8_t indexX{0};
+	uint8_t indexY{0};
+	Flags flags;
+	uint8_t stack{0};
+	uint64_t cycle{0};
+
+	constexpr TraceState() = default;
+	constexpr TraceState(uint16_t pc, uint8_t accumulator, uint8_t indexX,
+			     uint8_t indexY, Flags flags, uint8_t stack,
+			     uint64_t cycle);
+	constexpr explicit TraceState(const CPU &cpu);
+
+	constexpr auto operator==(const TraceState &rhs) const noexcept
+	    -> bool = default;
+};
+
+// The first state of a trace which the CPU did not reproduce
+struct Divergence {
+	size_t index{0};
+	TraceState expected;
+	TraceState actual;
+	// The CPU stopped on an unimplemented instruction before this state
+	bool halted{false};
+};
+
+// Copies of a CPU taken every interval instructions of a run, starting with
+// the initial state
+struct Checkpoints {
+	uint64_t interval{0};
+	std::vector<CPU> states;
+	// The run stopped on an unimplemented instruction after the last state
+	bool halted{false};
+};
+
+// Run cpu for up to instructions instructions without comparing against a
+// trace, keeping a copy of it every interval instructions
+auto takeCheckpoints(CPU cpu, uint64_t instructions, uint64_t interval)
+    -> Checkpoints;
+
+// Compare the states of trace with those reached by the CPU, verifying the
+// segment following each checkpoint on a separate thread. Returns the
+// earliest divergence, or nothing if the whole trace was reproduced. Throws
+// std::invalid_argument if the checkpoints end before the trace, other than
+// by the CPU halting
+auto validateTrace(const Checkpoints &checkpoints,
+		   std::span<const TraceState> trace, unsigned threads = 0)
+    -> std::optional<Divergence>;
+
+// Take checkpoints from initial and validate trace against them
+auto validateTrace(const CPU &initial, std::span<const TraceState> trace,
+		   unsigned threads = 0) -> std::optional<Divergence>;
+
+constexpr TraceState::TraceState(uint16_t pc, uint8_t accumulator,
+				 uint8_t indexX, uint8_t indexY, Flags flags,
+				 uint8_t stack, uint64_t cycle)
+    : pc{pc}, accumulator{accumulator}, indexX{indexX}, indexY{indexY},
+      flags{flags}, stack{stack}, cycle{cycle} {}
+
+constexpr TraceState::TraceState(const CPU &cpu)
+    : TraceState{cpu.pc,    cpu.accumulator, cpu.indexX, cpu.indexY,
+		 cpu.flags, cpu.stack,       cpu.cycle} {}
+
+} // namespace microlator
@@ -0,0 +1,245 @@
+#include "via.hpp"
+
+namespace {
+
+constexpr auto registerMask = 0x0fU;
+constexpr auto freeRunBit = 0x40U;
+constexpr auto timerFlags = 0x7fU;
+
+constexpr auto toU8(auto value) { return static_cast<uint8_t>(value); }
+constexpr auto toU16(auto value) { return static_cast<uint16_t>(value); }
+
+constexpr auto low(uint16_t value) { return toU8(value); }
+constexpr auto high(uint16_t value) { return toU8(value >> 8U); }
+constexpr auto withLow(uint16_t value, uint8_t byte) {
+	return toU16((value & 0xff00U) | byte);
+}
+constexpr auto withHigh(uint16_t value, uint8_t byte) {
+	return toU16((value & 0xffU) | (byte << 8U));
+}
+
+} // namespace
+
+namespace microlator {
+
+Via::Via(Scheduler &scheduler, unsigned irqSource)
+    : scheduler{scheduler}, irqSource{irqSource} {
+	updateIrq();
+}
+
+Via::~Via() {
+	for (const auto *timer : {&timer1, &timer2}) {
+		if (timer->event)
+			scheduler.cancel(*timer->event);
+	}
+}
+
+void Via::reset() {
+	schedule(timer1, Scheduler::never);
+	schedule(timer2, Scheduler::never);
+
+	ora = orb = ddra = ddrb = sr = acr = pcr = ifr = ier = 0;
+	timer1 = Timer{};
+	timer2 = Timer{};
+	updateIrq();
+}
+
+auto Via::read(const CPU &cpu, uint16_t address) -> uint8_t {
+	update(cpu.cycle);
+
+	switch (address & registerMask) {
+	case ORB:
+		return outputB() | toU8(inputB & ~ddrb);
+	case ORA:
+	case ORANoHandshake:
+		return outputA() | toU8(inputA & ~ddra);
+	case DDRB:
+		return ddrb;
+	case DDRA:
+		return ddra;
+	case T1CL:
+		clearFlags(Timer1);
+		return low(timer1Value(cpu.cycle));
+	case T1CH:
+		return high(timer1Value(cpu.cycle));
+	case T1LL:
+		return low(timer1.latch);
+	case T1LH:
+		return high(timer1.latch);
+	case T2CL:
+		clearFlags(Timer2);
+		return low(timer2Value(cpu.cycle));
+	case T2CH:
+		return high(timer2Value(cpu.cycle));
+	case SR:
+		return sr;
+	case ACR:
+		return acr;
+	case PCR:
+		return pcr;
+	case IFR:
+		return toU8(ifr | ((ifr & ier) ? Any : 0));
+	case IER:
+		return toU8(ier | Any);
+	default:
+		return 0;
+	}
+}
+
+void Via::write(CPU &cpu, uint16_t address, uint8_t value) {
+	update(cpu.cycle);
+
+	switch (address & registerMask) {
+	case ORB:
+		orb = value;
+		break;
+	case ORA:
+	case ORANoHandshake:
+		ora = value;
+		break;
+	case DDRB:
+		ddrb = value;
+		break;
+	case DDRA:
+		ddra = value;
+		break;
+	case T1CL:
+	case T1LL:
+		timer1.latch = withLow(timer1.latch, value);
+		break;
+	case T1CH:
+		timer1.latch = withHigh(timer1.latch, value);
+		clearFlags(Timer1);
+		loadTimer1(cpu.cycle, timer1.latch);
+		break;
+	case T1LH: {
+		// The new latch is only used from the next reload, so the
+		// counter is restarted from its current value
+		const auto current = timer1Value(cpu.cycle);
+		timer1.latch = withHigh(timer1.latch, value);
+		clearFlags(Timer1);
+		if (freeRunning())
+			loadTimer1(cpu.cycle, current);
+		break;
+	}
+	case T2CL:
+		timer2.latch = withLow(timer2.latch, value);
+		break;
+	case T2CH:
+		clearFlags(Timer2);
+		loadTimer2(cpu.cycle, withHigh(timer2.latch, value));
+		break;
+	case SR:
+		sr = value;
+		break;
+	case ACR: {
+		// Changing mode continues from the current count
+		const auto current = timer1Value(cpu.cycle);
+		const auto armed = timer1.underflow != Scheduler::never;
+		acr = value;
+		timer1.start = cpu.cycle;
+		timer1.counter = current;
+		if (armed || freeRunning())
+			loadTimer1(cpu.cycle, current);
+		break;
+	}
+	case PCR:
+		pcr = value;
+		break;
+	case IFR:
+		clearFlags(value & timerFlags);
+		break;
+	case IER:
+		if (value & Any)
+			ier |= value & timerFlags;
+		else
+			ier &= toU8(~value);
+		updateIrq();
+		break;
+	default:
+		break;
+	}
+}
+
+auto Via::outputA() const -> uint8_t { return ora & ddra; }
+
+auto Via::outputB() const -> uint8_t { return orb & ddrb; }
+
+auto Via::freeRunning() const -> bool { return (acr & freeRunBit) != 0; }
+
+// Timer 1 counts down from the value it was loaded with and underflows one
+// cycle after reaching zero. In free running mode it is then reloaded from
+// the latch, so underflows every latch + 2 cycles
+auto Via::timer1Value(uint64_t cycle) const -> uint16_t {
+	const auto elapsed = cycle - timer1.start;
+	if (elapsed <= timer1.counter || !freeRunning())
+		return toU16(timer1.counter - elapsed);
+
+	const auto period = uint64_t{timer1.latch} + 2;
+	const auto phase = (elapsed - timer1.counter - 1) % period;
+	return phase == 0 ? 0xffff : toU16(timer1.latch - (phase - 1));
+}
+
+auto Via::timer2Value(uint64_t cycle) const -> uint16_t {
+	return toU16(timer2.counter - (cycle - timer2.start));
+}
+
+void Via::loadTimer1(uint64_t cycle, uint16_t value) {
+	timer1.start = cycle;
+	timer1.counter = value;
+	schedule(timer1, cycle + value + 1);
+}
+
+void Via::loadTimer2(uint64_t cycle, uint16_t value) {
+	timer2.start = cycle;
+	timer2.counter = value;
+	schedule(timer2, cycle + value + 1);
+}
+
+void Via::schedule(Timer &timer, uint64_t underflow) {
+	if (timer.event)
+		scheduler.cancel(*timer.event);
+
+	timer.underflow = underflow;
+	timer.event.reset();
+	if (underflow == Scheduler::never)
+		return;
+
+	timer.event = scheduler.schedule(underflow, [this, &timer, underflow] {
+		timer.event.reset();
+		update(underflow);
+	});
+}
+
+void Via::update(uint64_t cycle) {
+	if (timer1.underflow <= cycle) {
+		ifr |= Timer1;
+
+		auto next = Scheduler::never;
+		if (freeRunning()) {
+			const auto period = uint64_t{timer1.latch} + 2;
+			const auto missed =
+			    (cycle - timer1.underflow) / period;
+			next = timer1.underflow + (missed + 1) * period;
+		}
+		schedule(timer1, next);
+	}
+
+	if (timer2.underflow <= cycle) {
+		ifr |= Timer2;
+		schedule(timer2, Scheduler::never);
+	}
+
+	updateIrq();
+}
+
+void Via::clearFlags(uint8_t flags) {
+	ifr &= toU8(~flags);
+	updateIrq();
+}
+
+void Via::updateIrq() {
+	scheduler.setIrq(irqSource, (ifr & ier & timerFlags) != 0);
+}
+
+} // namespace microlator
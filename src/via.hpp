@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "device.hpp"
+#include "scheduler.hpp"
+
+namespace microlator {
+
+// Model of the 6522 Versatile Interface Adapter, whose 16 registers are
+// mirrored through every page it is mapped to.
+// The timers are not decremented while running: reads derive their value from
+// the CPU's cycle, and an event is scheduled for the cycle each next
+// underflows. Timer 2 only counts cycles, not pulses on PB6, and the shift
+// register and handshake lines only hold the values written to them
+class Via : public Device {
+public:
+	enum Register : uint8_t {
+		ORB = 0x0,
+		ORA = 0x1,
+		DDRB = 0x2,
+		DDRA = 0x3,
+		T1CL = 0x4,
+		T1CH = 0x5,
+		T1LL = 0x6,
+		T1LH = 0x7,
+		T2CL = 0x8,
+		T2CH = 0x9,
+		SR = 0xa,
+		ACR = 0xb,
+		PCR = 0xc,
+		IFR = 0xd,
+		IER = 0xe,
+		ORANoHandshake = 0xf,
+	};
+
+	enum Interrupt : uint8_t {
+		Timer2 = 0x20,
+		Timer1 = 0x40,
+		Any = 0x80,
+	};
+
+	// Interrupts are raised through the scheduler's IRQ line for irqSource
+	Via(Scheduler &scheduler, unsigned irqSource);
+	~Via() override;
+
+	void reset();
+
+	auto read(const CPU &cpu, uint16_t address) -> uint8_t override;
+	void write(CPU &cpu, uint16_t address, uint8_t value) override;
+
+	// Values driven onto the pins of each port which are set as inputs
+	uint8_t inputA{0xff};
+	uint8_t inputB{0xff};
+
+	// Values driven by the VIA onto the pins of each port set as outputs
+	[[nodiscard]] auto outputA() const -> uint8_t;
+	[[nodiscard]] auto outputB() const -> uint8_t;
+
+private:
+	struct Timer {
+		// Cycle the counter was loaded, and the value loaded
+		uint64_t start{0};
+		uint16_t counter{0xffff};
+		uint16_t latch{0xffff};
+		// Cycle of the next underflow which raises an interrupt, if any
+		uint64_t underflow{Scheduler::never};
+		std::optional<Scheduler::Id> event;
+	};
+
+	[[nodiscard]] auto freeRunning() const -> bool;
+	[[nodiscard]] auto timer1Value(uint64_t cycle) const -> uint16_t;
+	[[nodiscard]] auto timer2Value(uint64_t cycle) const -> uint16_t;
+	void loadTimer1(uint64_t cycle, uint16_t value);
+	void loadTimer2(uint64_t cycle, uint16_t value);
+	void schedule(Timer &timer, uint64_t underflow);
+	// Raise the interrupts of underflows which have happened by cycle
+	void update(uint64_t cycle);
+	void clearFlags(uint8_t flags);
+	void updateIrq();
+
+	Scheduler &scheduler;
+	unsigned irqSource;
+
+	uint8_t ora{0};
+	uint8_t orb{0};
+	uint8_t ddra{0};
+	uint8_t ddrb{0};
+	uint8_t sr{0};
+	uint8_t acr{0};
+	uint8_t pcr{0};
+	uint8_t ifr{0};
+	uint8_t ier{0};
+	Timer timer1;
+	Timer timer2;
+};
+
+} // namespace microlator
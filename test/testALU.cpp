@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "cpu.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+using F = emu::Flags::Index;
+
+// Registers and flags an operation reads and writes. operand is either the
+// immediate value or the value at zeropage $10
+struct State {
+	uint8_t accumulator{0};
+	uint8_t indexX{0};
+	uint8_t indexY{0};
+	uint8_t operand{0};
+	uint8_t flags{0};
+
+	auto operator==(const State &) const -> bool = default;
+};
+
+enum class Input { Accumulator, IndexX, IndexY, Operand };
+
+enum class Mode { Implied, Immediate, Zeropage };
+
+// An instruction, and a model of it written independently of CPU
+struct Operation {
+	std::string_view name;
+	uint8_t opcode;
+	Mode mode;
+	// Where the first input is placed. Any second input is the operand
+	Input input;
+	void (*model)(State &);
+};
+
+constexpr auto operandAddress = uint8_t{0x10};
+
+void setFlag(State &state, F flag, bool set) {
+	const auto mask = emu::Flags::bitmask(flag);
+	state.flags = static_cast<uint8_t>(set ? state.flags | mask
+					       : state.flags & ~mask);
+}
+
+auto carry(const State &state) -> int {
+	return (state.flags & emu::Flags::bitmask(F::Carry)) != 0 ? 1 : 0;
+}
+
+auto setResult(State &state, int value) -> uint8_t {
+	const auto result = static_cast<uint8_t>(value);
+	setFlag(state, F::Zero, result == 0);
+	setFlag(state, F::Negative, result >= 0x80);
+	return result;
+}
+
+void compare(State &state, uint8_t value, uint8_t operand) {
+	setFlag(state, F::Carry, value >= operand);
+	setResult(state, value - operand);
+}
+
+// Decimal mode is not implemented, so like the NES's 2A03 the result of ADC
+// and SBC is binary whether or not the decimal flag is set
+void add(State &state) {
+	const auto a = int{state.accumulator};
+	const auto b = int{state.operand};
+	const auto sum = a + b + carry(state);
+	const auto signedSum = static_cast<int8_t>(a) +
+			       static_cast<int8_t>(b) + carry(state);
+	setFlag(state, F::Carry, sum > 0xff);
+	setFlag(state, F::Overflow, signedSum < -128 || signedSum > 127);
+	state.accumulator = setResult(state, sum);
+}
+
+void subtract(State &state) {
+	const auto a = int{state.accumulator};
+	const auto b = int{state.operand};
+	const auto borrow = 1 - carry(state);
+	const auto difference = a - b - borrow;
+	const auto signedDifference = static_cast<int8_t>(a) -
+				      static_cast<int8_t>(b) - borrow;
+	setFlag(state, F::Carry, difference >= 0);
+	setFlag(state, F::Overflow,
+		signedDifference < -128 || signedDifference > 127);
+	state.accumulator = setResult(state, difference);
+}
+
+void bitTest(State &state) {
+	setFlag(state, F::Zero, (state.accumulator & state.operand) == 0);
+	setFlag(state, F::Overflow, (state.operand & 0x40) != 0);
+	setFlag(state, F::Negative, (state.operand & 0x80) != 0);
+}
+
+auto shiftLeft(State &state, uint8_t value, int in) -> uint8_t {
+	setFlag(state, F::Carry, value >= 0x80);
+	return setResult(state, value * 2 + in);
+}
+
+auto shiftRight(State &state, uint8_t value, int in) -> uint8_t {
+	setFlag(state, F::Carry, value % 2 == 1);
+	return setResult(state, value / 2 + in * 0x80);
+}
+
+// clang-format off
+constexpr auto operations = std::to_array<Operation>({
+    {"ADC #", 0x69, Mode::Immediate, Input::Accumulator, add},
+    {"SBC #", 0xe9, Mode::Immediate, Input::Accumulator, subtract},
+    {"CMP #", 0xc9, Mode::Immediate, Input::Accumulator,
+     [](State &s) { compare(s, s.accumulator, s.operand); }},
+    {"CPX #", 0xe0, Mode::Immediate, Input::IndexX,
+     [](State &s) { compare(s, s.indexX, s.operand); }},
+    {"CPY #", 0xc0, Mode::Immediate, Input::IndexY,
+     [](State &s) { compare(s, s.indexY, s.operand); }},
+    {"BIT", 0x24, Mode::Zeropage, Input::Accumulator, bitTest},
+    {"ASL A", 0x0a, Mode::Implied, Input::Accumulator,
+     [](State &s) { s.accumulator = shiftLeft(s, s.accumulator, 0); }},
+    {"LSR A", 0x4a, Mode::Implied, Input::Accumulator,
+     [](State &s) { s.accumulator = shiftRight(s, s.accumulator, 0); }},
+    {"ROL A", 0x2a, Mode::Implied, Input::Accumulator,
+     [](State &s) {
+	     s.accumulator = shiftLeft(s, s.accumulator, carry(s));
+     }},
+    {"ROR A", 0x6a, Mode::Implied, Input::Accumulator,
+     [](State &s) {
+	     s.accumulator = shiftRight(s, s.accumulator, carry(s));
+     }},
+    {"ASL", 0x06, Mode::Zeropage, Input::Operand,
+     [](State &s) { s.operand = shiftLeft(s, s.operand, 0); }},
+    {"LSR", 0x46, Mode::Zeropage, Input::Operand,
+     [](State &s) { s.operand = shiftRight(s, s.operand, 0); }},
+    {"ROL", 0x26, Mode::Zeropage, Input::Operand,
+     [](State &s) { s.operand = shiftLeft(s, s.operand, carry(s)); }},
+    {"ROR", 0x66, Mode::Zeropage, Input::Operand,
+     [](State &s) { s.operand = shiftRight(s, s.operand, carry(s)); }},
+    {"INC", 0xe6, Mode::Zeropage, Input::Operand,
+     [](State &s) { s.operand = setResult(s, s.operand + 1); }},
+    {"DEC", 0xc6, Mode::Zeropage, Input::Operand,
+     [](State &s) { s.operand = setResult(s, s.operand - 1); }},
+    {"INX", 0xe8, Mode::Implied, Input::IndexX,
+     [](State &s) { s.indexX = setResult(s, s.indexX + 1); }},
+    {"DEX", 0xca, Mode::Implied, Input::IndexX,
+     [](State &s) { s.indexX = setResult(s, s.indexX - 1); }},
+    {"INY", 0xc8, Mode::Implied, Input::IndexY,
+     [](State &s) { s.indexY = setResult(s, s.indexY + 1); }},
+    {"DEY", 0x88, Mode::Implied, Input::IndexY,
+     [](State &s) { s.indexY = setResult(s, s.indexY - 1); }},
+});
+// clang-format on
+
+// Every combination of the carry, decimal and overflow flags, with the
+// flags set by reset
+auto initialFlags() -> std::vector<uint8_t> {
+	std::vector<uint8_t> result;
+	for (auto i = 0U; i < 8; i++) {
+		auto state = State{};
+		state.flags = emu::Flags{}.get();
+		setFlag(state, F::Carry, (i & 1U) != 0);
+		setFlag(state, F::Decimal, (i & 2U) != 0);
+		setFlag(state, F::Overflow, (i & 4U) != 0);
+		result.push_back(state.flags);
+	}
+
+	return result;
+}
+
+auto execute(emu::CPU &cpu, const Operation &operation, const State &state)
+    -> State {
+	cpu.pc = 0x600;
+	cpu.memory[0x600] = operation.opcode;
+	cpu.memory[0x601] = operation.mode == Mode::Immediate ? state.operand
+							    : operandAddress;
+	cpu.memory[operandAddress] = state.operand;
+	cpu.accumulator = state.accumulator;
+	cpu.indexX = state.indexX;
+	cpu.indexY = state.indexY;
+	cpu.flags = emu::Flags{state.flags};
+
+	if (!cpu.step())
+		return {};
+
+	return {cpu.accumulator, cpu.indexX, cpu.indexY,
+		cpu.memory[operandAddress], cpu.flags.get()};
+}
+
+auto describe(const Operation &operation, const State &state)
+    -> std::string {
+	return std::string{operation.name} +
+	       " A=" + std::to_string(state.accumulator) +
+	       " X=" + std::to_string(state.indexX) +
+	       " Y=" + std::to_string(state.indexY) +
+	       " M=" + std::to_string(state.operand) +
+	       " P=" + std::to_string(state.flags);
+}
+
+// Run every operation with each first input congruent to first modulo
+// stride, and every operand and initial flags. Returns the inputs which did
+// not match the model
+auto check(uint32_t first, uint32_t stride) -> std::vector<std::string> {
+	constexpr auto maxFailures = 16U;
+
+	const auto flags = initialFlags();
+	std::vector<std::string> failures;
+	auto cpu = emu::CPU{};
+
+	for (const auto &operation : operations) {
+		const auto binary = operation.mode != Mode::Implied &&
+				    operation.input != Input::Operand;
+		const auto operands = binary ? 256U : 1U;
+		for (auto value = first; value < 256; value += stride) {
+			for (auto operand = 0U; operand < operands; operand++) {
+				for (const auto initial : flags) {
+					auto state = State{0x5a, 0xa5, 0x3c,
+							   uint8_t(operand),
+							   initial};
+					const auto input = uint8_t(value);
+					switch (operation.input) {
+					case Input::Accumulator:
+						state.accumulator = input;
+						break;
+					case Input::IndexX:
+						state.indexX = input;
+						break;
+					case Input::IndexY:
+						state.indexY = input;
+						break;
+					case Input::Operand:
+						state.operand = input;
+						break;
+					}
+
+					auto expected = state;
+					operation.model(expected);
+					if (execute(cpu, operation, state) ==
+						expected ||
+					    failures.size() >= maxFailures)
+						continue;
+
+					failures.push_back(
+					    describe(operation, state));
+				}
+			}
+		}
+	}
+
+	return failures;
+}
+
+} // namespace
+
+TEST_CASE("CPU arithmetic matches a model for every input", "[cpu]") {
+	const auto threads = std::max(std::thread::hardware_concurrency(), 1U);
+	std::vector<std::vector<std::string>> failures(threads);
+	{
+		std::vector<std::jthread> workers;
+		for (auto i = 0U; i < threads; i++) {
+			workers.emplace_back(
+			    [&, i] { failures[i] = check(i, threads); });
+		}
+	}
+
+	for (const auto &thread : failures) {
+		for (const auto &failure : thread)
+			FAIL_CHECK(failure);
+	}
+}
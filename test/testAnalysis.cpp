@@ -0,0 +1,89 @@
+#include <catch2/catch.hpp>
+
+#include "analysis.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+constexpr auto program = std::to_array<uint8_t>({
+    0xa2, 0x03,       // LDX #3
+    0xb5, 0x10,       // LDA $10,X
+    0xe8,             // INX
+    0x9d, 0xff, 0x02, // STA $02FF,X
+    0x8a,             // TXA
+    0x18,             // CLC
+    0x69, 0x01,       // ADC #1
+    0xd0, 0xf2,       // BNE $0600
+});
+
+auto decodeBlock(const emu::CPU &cpu, uint16_t address, size_t count)
+    -> std::vector<emu::DecodedInstruction> {
+	std::vector<emu::DecodedInstruction> block;
+	for (auto i = size_t{0}; i < count; i++) {
+		block.push_back(cpu.decode(address));
+		address += block.back().length;
+	}
+
+	return block;
+}
+
+} // namespace
+
+TEST_CASE("Analysis finds live flags and constants", "[analysis]") {
+	auto cpu = emu::CPU{};
+	cpu.loadProgram(program);
+	const auto block = decodeBlock(cpu, 0x600, 8);
+	const auto analysis = emu::analyse(block);
+
+	// The flags set by LDX, LDA, TXA and CLC are overwritten before
+	// being read, except where the STA may have to stop
+	REQUIRE(analysis.liveFlags ==
+		std::vector<uint8_t>{0x7d, 0x7d, 0xff, 0xff, 0x3c, 0x3d, 0xff,
+				     0xff});
+
+	REQUIRE(analysis.known[0] == emu::KnownRegisters{});
+	REQUIRE(analysis.known[1].indexX == 3);
+	REQUIRE(analysis.known[3].indexX == 4);
+	REQUIRE(!analysis.known[4].accumulator);
+	REQUIRE(analysis.known[5].accumulator == 4);
+	// The carry is not tracked, so neither is the result of ADC
+	REQUIRE(!analysis.known[7].accumulator);
+	REQUIRE(analysis.known[7].indexX == 4);
+}
+
+TEST_CASE("Analysis folds constant indexes into addresses", "[analysis]") {
+	using Mode = emu::AddressMode;
+
+	auto cpu = emu::CPU{};
+	cpu.loadProgram(program);
+	const auto block = decodeBlock(cpu, 0x600, 8);
+	const auto analysis = emu::analyse(block);
+
+	const auto load = emu::specialise(block[1], analysis.known[1]);
+	REQUIRE(load.addressMode == Mode::Zeropage);
+	REQUIRE(load.operand == 0x13);
+	REQUIRE(load.extraCycles == 1);
+
+	// Writes always take the cycle to fix the high byte
+	const auto store = emu::specialise(block[3], analysis.known[3]);
+	REQUIRE(store.addressMode == Mode::Absolute);
+	REQUIRE(store.operand == 0x303);
+	REQUIRE(store.extraCycles == 1);
+
+	// Reads only take it when crossing a page
+	// LDA $02F0,X
+	cpu.loadProgram(std::to_array<uint8_t>({0xbd, 0xf0, 0x02}));
+	const auto indexed = cpu.decode(0x600);
+	auto known = emu::KnownRegisters{};
+	known.indexX = 0x0f;
+	REQUIRE(emu::specialise(indexed, known).extraCycles == 0);
+	known.indexX = 0x10;
+	REQUIRE(emu::specialise(indexed, known).extraCycles == 1);
+	REQUIRE(emu::specialise(indexed, known).operand == 0x300);
+
+	// Unknown indexes are left alone
+	const auto unchanged = emu::specialise(indexed, {});
+	REQUIRE(unchanged.addressMode == Mode::AbsoluteX);
+	REQUIRE(unchanged.operand == 0x2f0);
+}
@@ -0,0 +1,144 @@
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include "assembler.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+constexpr auto program = emu::assemble<R"(
+	value = $10
+	LDX #0
+loop:	JSR add         ; forward reference
+	DEX
+	BNE loop
+	JMP ($0600)
+add:	CLC
+	ADC value
+	STA value,X
+	LDA (value),Y
+	STA (value,X)
+	ROL
+	LSR A
+	RTS
+)">();
+
+static_assert(program == std::to_array<uint8_t>({
+			     0xa2, 0x00,       // LDX #0
+			     0x20, 0x0b, 0x06, // loop: JSR add
+			     0xca,             // DEX
+			     0xd0, 0xfa,       // BNE loop
+			     0x6c, 0x00, 0x06, // JMP ($0600)
+			     0x18,             // add: CLC
+			     0x65, 0x10,       // ADC $10
+			     0x95, 0x10,       // STA $10,X
+			     0xb1, 0x10,       // LDA ($10),Y
+			     0x81, 0x10,       // STA ($10,X)
+			     0x2a,             // ROL A
+			     0x4a,             // LSR A
+			     0x60,             // RTS
+			 }));
+
+// An operand written in each addressing mode
+auto operand(emu::AddressMode mode) -> std::string {
+	using Mode = emu::AddressMode;
+
+	switch (mode) {
+	case Mode::Implicit:
+		return "";
+	case Mode::Accumulator:
+		return "A";
+	case Mode::Immediate:
+		return "#$12";
+	case Mode::Absolute:
+		return "$1234";
+	case Mode::AbsoluteX:
+		return "$1234,X";
+	case Mode::AbsoluteY:
+		return "$1234,Y";
+	case Mode::Indirect:
+		return "($1234)";
+	case Mode::IndirectX:
+		return "($12,X)";
+	case Mode::IndirectY:
+		return "($12),Y";
+	case Mode::Relative:
+		return "$0600";
+	case Mode::Zeropage:
+		return "$12";
+	case Mode::ZeropageX:
+		return "$12,X";
+	case Mode::ZeropageY:
+		return "$12,Y";
+	}
+
+	return "";
+}
+
+} // namespace
+
+TEST_CASE("Assembler encodes every opcode", "[assembler]") {
+	for (auto i = 0U; i < emu::opcodes.size(); i++) {
+		const auto [mnemonic, mode] = emu::opcodes.at(i);
+		if (mnemonic == emu::Mnemonic::None)
+			continue;
+
+		const auto name = emu::mnemonicNames.at(
+		    static_cast<size_t>(mnemonic));
+		const auto source = std::string{name} + " " + operand(mode);
+		const auto bytes = emu::Assembler{source}.bytes();
+		INFO(source);
+		REQUIRE(bytes.size() == 1U + emu::operandLength(mode));
+		REQUIRE(bytes[0] == i);
+
+		auto cpu = emu::CPU{};
+		cpu.loadProgram(bytes);
+		const auto decoded = cpu.decode(cpu.pc);
+		REQUIRE(decoded.mnemonic == mnemonic);
+		REQUIRE(decoded.addressMode == mode);
+	}
+}
+
+TEST_CASE("Assembler handles directives and expressions", "[assembler]") {
+	const auto assembler = emu::Assembler{R"(
+		.org $8000
+	start:	LDA data+1      ; later labels take the absolute form
+		LDX #<start
+		LDY #>start
+		.byte 1, %101, $ff
+		.org $8010
+	data:	.word start, 258
+	)"};
+
+	REQUIRE(assembler.origin() == 0x8000);
+	REQUIRE(assembler.bytes() == std::vector<uint8_t>{
+					 0xad, 0x11, 0x80, // LDA data+1
+					 0xa2, 0x00,       // LDX #<start
+					 0xa0, 0x80,       // LDY #>start
+					 1, 5, 0xff,       // .byte
+					 0, 0, 0, 0, 0, 0, // .org $8010
+					 0x00, 0x80,       // .word start
+					 0x02, 0x01,       // .word 258
+				     });
+}
+
+TEST_CASE("Assembler rejects invalid source", "[assembler]") {
+	for (const auto *const source : {
+		 "FOO",
+		 "LDA",
+		 "JMP $12,Y",
+		 "LDA #$100",
+		 "LDA missing",
+		 "loop: NOP\nloop: NOP",
+		 "BNE far\n.org $0700\nfar: NOP",
+		 ".org $0700\nNOP\n.org $0600",
+		 ".fill 1",
+		 "LDA $12g",
+	     }) {
+		INFO(source);
+		REQUIRE_THROWS_AS(emu::Assembler{source},
+				  std::invalid_argument);
+	}
+}
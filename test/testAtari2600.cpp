@@ -0,0 +1,186 @@
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "atari2600.hpp"
+#include "tiered.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+// Draws frames of 262 scanlines, counting them in RAM
+constexpr auto frameProgram = std::to_array<uint8_t>({
+    0x78,             // SEI
+    0xd8,             // CLD
+    0xa2, 0xff,       // LDX #$FF
+    0x9a,             // TXS
+    0xa9, 0x02,       // frame: LDA #$02
+    0x85, 0x00,       // STA VSYNC
+    0x85, 0x02,       // STA WSYNC
+    0x85, 0x02,       // STA WSYNC
+    0x85, 0x02,       // STA WSYNC
+    0xa9, 0x00,       // LDA #$00
+    0x85, 0x00,       // STA VSYNC
+    0xa2, 0x00,       // LDX #$00
+    0x85, 0x02,       // line: STA WSYNC
+    0xca,             // DEX
+    0xd0, 0xfb,       // BNE line
+    0x85, 0x02,       // STA WSYNC
+    0x85, 0x02,       // STA WSYNC
+    0x85, 0x02,       // STA WSYNC
+    0x20, 0x26, 0xf0, // JSR count
+    0x4c, 0x05, 0xf0, // JMP frame
+    0xe6, 0x80,       // count: INC $80
+    0x60,             // RTS
+});
+
+// Counts passes in RAM, switching to the other bank of an F8 cartridge
+// after each one
+constexpr auto firstBankProgram = std::to_array<uint8_t>({
+    0xe6, 0x81,       // loop: INC $81
+    0xad, 0xf9, 0xff, // LDA $FFF9
+    0x4c, 0x00, 0xf0, // JMP loop
+});
+
+constexpr auto secondBankProgram = std::to_array<uint8_t>({
+    0xe6, 0x80,       // loop: INC $80
+    0xad, 0xf8, 0xff, // LDA $FFF8
+    0x4c, 0x00, 0xf0, // JMP loop
+});
+
+// Switches to the first bank of an F8 cartridge, which counts passes in RAM
+constexpr auto switchBankProgram = std::to_array<uint8_t>({
+    0xad, 0xf8, 0xff, // LDA $FFF8
+});
+
+constexpr auto countBankProgram = std::to_array<uint8_t>({
+    0x00, 0x00, 0x00, //
+    0xe6, 0x80,       // loop: INC $80
+    0x4c, 0x03, 0xf0, // JMP loop
+});
+
+auto cartridge(std::span<const uint8_t> program, size_t size = 0x1000)
+    -> std::vector<uint8_t> {
+	auto rom = std::vector<uint8_t>(size);
+	std::copy(program.begin(), program.end(), rom.end() - 0x1000);
+	// Reset vector
+	rom[size - 4] = 0x00;
+	rom[size - 3] = 0xf0;
+	return rom;
+}
+
+} // namespace
+
+TEST_CASE("Atari 2600 runs frames", "[atari2600]") {
+	const auto rom = cartridge(frameProgram);
+	auto atari = emu::Atari2600(rom);
+
+	REQUIRE(atari.cpu.pc == 0xf000);
+	// The first frame starts part way through a scanline
+	REQUIRE(atari.runFrames(2, 1'000'000));
+	const auto start = atari.cpu.cycle;
+
+	REQUIRE(atari.runFrames(3, 1'000'000));
+	REQUIRE(atari.tia.frame == 5);
+	REQUIRE(atari.tia.frameLines == 262);
+	REQUIRE(atari.cpu.cycle - start == 3 * 262 * emu::Tia::cyclesPerLine);
+	// Counted through RAM, by a subroutine using the stack mirror
+	REQUIRE(atari.cpu.memory[0x80] == 4);
+	REQUIRE(atari.cpu.stack == 0xff);
+}
+
+TEST_CASE("Atari 2600 stops runs at a cycle limit", "[atari2600]") {
+	const auto rom = cartridge(frameProgram);
+	auto atari = emu::Atari2600(rom);
+
+	REQUIRE(atari.runFrames(100, 1000));
+	REQUIRE(atari.tia.frame == 1);
+	REQUIRE(atari.cpu.cycle >= 1000);
+}
+
+TEST_CASE("Atari 2600 RIOT timer derives its value from cycles",
+	  "[atari2600]") {
+	const auto rom = cartridge(frameProgram);
+	auto atari = emu::Atari2600(rom);
+	auto &cpu = atari.cpu;
+
+	cpu.cycle = 1000;
+	atari.write(cpu, 0x296, 10); // TIM64T
+	cpu.cycle = 1000 + 64 * 3 + 5;
+	REQUIRE(atari.read(cpu, 0x284) == 7);
+	REQUIRE(atari.read(cpu, 0x285) == 0);
+
+	cpu.cycle = 1000 + 64 * 11 + 2;
+	REQUIRE(atari.read(cpu, 0x284) == 0xfd);
+	REQUIRE(atari.read(cpu, 0x285) == 0x80);
+}
+
+TEST_CASE("Atari 2600 reads inputs", "[atari2600]") {
+	const auto rom = cartridge(frameProgram);
+	auto atari = emu::Atari2600(rom);
+
+	REQUIRE(atari.read(atari.cpu, 0x0c) == 0x80);
+	atari.tia.buttons[0] = true;
+	REQUIRE(atari.read(atari.cpu, 0x3c) == 0);
+
+	atari.riot.swcha = 0x7f;
+	REQUIRE(atari.read(atari.cpu, 0x280) == 0x7f);
+}
+
+TEST_CASE("Atari 2600 switches banks", "[atari2600]") {
+	auto rom = cartridge(frameProgram, 0x2000);
+	rom[0x0100] = 0x11;
+	rom[0x1100] = 0x22;
+	auto atari = emu::Atari2600(rom);
+
+	REQUIRE(atari.read(atari.cpu, 0xf100) == 0x22);
+	REQUIRE_FALSE(atari.cpu.mapped(0xf100));
+	atari.read(atari.cpu, 0xfff8);
+	// Pages holding the previous bank are loaded when next accessed
+	REQUIRE(atari.cpu.mapped(0xf100));
+	REQUIRE(atari.read(atari.cpu, 0xf100) == 0x11);
+	REQUIRE(atari.cpu.memory[0xf100] == 0x11);
+	REQUIRE(atari.read(atari.cpu, 0x1100) == 0x11);
+	atari.write(atari.cpu, 0x1ff9, 0);
+	REQUIRE(atari.read(atari.cpu, 0xf100) == 0x22);
+
+	REQUIRE_THROWS_AS(emu::Atari2600(std::vector<uint8_t>(0x1800)),
+			  std::invalid_argument);
+}
+
+TEST_CASE("Atari 2600 runs copies of its CPU", "[atari2600]") {
+	auto rom = cartridge(switchBankProgram, 0x2000);
+	std::ranges::copy(countBankProgram, rom.begin());
+	auto atari = emu::Atari2600(rom);
+
+	REQUIRE(atari.cpu.step());
+	auto copy = atari.cpu;
+	const auto memory = atari.cpu.memory;
+	REQUIRE(copy.run(800));
+
+	// The copy read the first bank, without loading it into the original
+	REQUIRE(atari.cpu.memory == memory);
+	REQUIRE(atari.cpu.run(800));
+	REQUIRE(copy.memory[0x80] > 90);
+	REQUIRE(copy.memory[0x80] == atari.cpu.memory[0x80]);
+}
+
+TEST_CASE("Atari 2600 bank switches discard translated code",
+	  "[atari2600][tiered]") {
+	auto rom = cartridge(secondBankProgram, 0x2000);
+	std::ranges::copy(firstBankProgram, rom.begin());
+	auto atari = emu::Atari2600(rom);
+
+	auto engine = emu::TieredEngine{atari.cpu, 4, 16};
+	REQUIRE(engine.run(2400));
+	REQUIRE(engine.statistics().blocksTranslated > 0);
+	REQUIRE(engine.statistics().blocksInvalidated > 0);
+
+	// Each bank ran on alternate passes
+	const auto first = atari.cpu.memory[0x81];
+	const auto second = atari.cpu.memory[0x80];
+	REQUIRE(second > 90);
+	REQUIRE((second == first || second == first + 1));
+}
@@ -0,0 +1,79 @@
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "batch.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+// Sums the number of bytes given by the first byte of the input
+constexpr auto sumProgram = std::to_array<uint8_t>({
+    0xa2, 0x00,       // LDX #$00
+    0xa9, 0x00,       // LDA #$00
+    0xec, 0x00, 0x02, // loop: CPX $0200
+    0xf0, 0x07,       // BEQ done
+    0x18,             // CLC
+    0x7d, 0x01, 0x02, // ADC $0201,X
+    0xe8,             // INX
+    0xd0, 0xf4,       // BNE loop
+    0x8d, 0x00, 0x03, // done: STA $0300
+    0x02,             // Halt
+});
+
+constexpr auto input = emu::MemoryRange{0x200, 32};
+constexpr auto output = emu::MemoryRange{0x300, 1};
+
+} // namespace
+
+TEST_CASE("Batch runs a program against each input", "[batch]") {
+	const auto batch = emu::Batch(sumProgram, 0x600, input, output, 10000);
+
+	std::vector<std::vector<uint8_t>> vectors;
+	for (uint8_t length = 0; length < 31; length++) {
+		auto &vector = vectors.emplace_back(length + 1U);
+		vector[0] = length;
+		std::iota(vector.begin() + 1, vector.end(), length);
+	}
+	std::vector<std::span<const uint8_t>> inputs(vectors.begin(),
+						     vectors.end());
+
+	const auto threads = GENERATE(1U, 3U);
+	const auto results = batch.run(inputs, threads);
+
+	REQUIRE(results.size() == vectors.size());
+	for (size_t i = 0; i < results.size(); i++) {
+		const auto &vector = vectors[i];
+		const auto sum = std::accumulate(vector.begin() + 1,
+						 vector.end(), uint8_t{0});
+
+		REQUIRE(results[i].finished);
+		REQUIRE(results[i].output == std::vector<uint8_t>{sum});
+		REQUIRE(results[i].cycles == 16U + 17U * vector[0]);
+	}
+}
+
+TEST_CASE("Batch stops programs which run out of cycles", "[batch]") {
+	const auto batch = emu::Batch(sumProgram, 0x600, input, output, 100);
+	const auto vector = std::to_array<uint8_t>({30});
+	const auto inputs = std::vector<std::span<const uint8_t>>{vector};
+
+	const auto results = batch.run(inputs);
+
+	REQUIRE_FALSE(results.at(0).finished);
+	REQUIRE(results.at(0).cycles >= 100);
+}
+
+TEST_CASE("Batch rejects inputs which don't fit", "[batch]") {
+	const auto batch = emu::Batch(sumProgram, 0x600, input, output, 100);
+	const auto vector = std::vector<uint8_t>(input.length + 1U);
+	const auto inputs = std::vector<std::span<const uint8_t>>{vector};
+
+	REQUIRE_THROWS_AS(batch.run(inputs), std::invalid_argument);
+	REQUIRE_THROWS_AS(emu::Batch(sumProgram, 0x600, {0xfff0, 32}, output,
+				     100),
+			  std::invalid_argument);
+}
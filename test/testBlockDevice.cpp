@@ -0,0 +1,150 @@
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include <catch2/catch.hpp>
+
+#include "blockdevice.hpp"
+#include "cpu.hpp"
+#include "tiered.hpp"
+
+namespace emu = microlator;
+using B = emu::BlockDevice;
+
+namespace {
+
+// Loads 512 bytes from sector 2 to $3000, with the device at $8000
+constexpr auto loadProgram = std::to_array<uint8_t>({
+    0xa9, 0x02,       // LDA #2
+    0x8d, 0x00, 0x80, // STA SectorLow
+    0xa9, 0x00,       // LDA #0
+    0x8d, 0x01, 0x80, // STA SectorHigh
+    0x8d, 0x02, 0x80, // STA DestinationLow
+    0xa9, 0x30,       // LDA #$30
+    0x8d, 0x03, 0x80, // STA DestinationHigh
+    0xa9, 0x00,       // LDA #0
+    0x8d, 0x04, 0x80, // STA LengthLow
+    0xa9, 0x02,       // LDA #2
+    0x8d, 0x05, 0x80, // STA LengthHigh
+    0xa9, 0x01,       // LDA #Read
+    0x8d, 0x06, 0x80, // STA Command
+    0xad, 0x07, 0x80, // LDA Status
+});
+
+// Calls a subroutine at $0700 100 times, loads a replacement for it from
+// sector 0, and calls it 100 times again
+constexpr auto reloadProgram = std::to_array<uint8_t>({
+    0xa2, 0x64,       // LDX #100
+    0x20, 0x00, 0x07, // before: JSR $0700
+    0xca,             // DEX
+    0xd0, 0xfa,       // BNE before
+    0xa9, 0x00,       // LDA #0
+    0x8d, 0x00, 0x80, // STA SectorLow
+    0x8d, 0x01, 0x80, // STA SectorHigh
+    0x8d, 0x02, 0x80, // STA DestinationLow
+    0x8d, 0x05, 0x80, // STA LengthHigh
+    0xa9, 0x07,       // LDA #$07
+    0x8d, 0x03, 0x80, // STA DestinationHigh
+    0xa9, 0x03,       // LDA #3
+    0x8d, 0x04, 0x80, // STA LengthLow
+    0xa9, 0x01,       // LDA #Read
+    0x8d, 0x06, 0x80, // STA Command
+    0xa2, 0x64,       // LDX #100
+    0x20, 0x00, 0x07, // after: JSR $0700
+    0xca,             // DEX
+    0xd0, 0xfa,       // BNE after
+    0x4c, 0x2d, 0x06, // done: JMP done
+});
+
+auto diskImage(const char *name) -> std::filesystem::path {
+	auto path = std::filesystem::temp_directory_path() / name;
+	auto file = std::ofstream{path, std::ios::binary};
+	for (auto i = 0U; i < 1024; i++)
+		file.put(static_cast<char>(i * 7));
+
+	return path;
+}
+
+} // namespace
+
+TEST_CASE("Block device copies sectors into memory", "[blockdevice]") {
+	const auto path = diskImage("microlator-test-copy.bin");
+	auto cpu = emu::CPU{};
+	auto disk = B{path};
+	disk.commandCycles = 100;
+	disk.cyclesPerByte = 2;
+
+	cpu.loadProgram(loadProgram);
+	cpu.map(disk, 0x80, 0x80);
+	REQUIRE(disk.size() == 1024);
+
+	while (cpu.pc != 0x600 + loadProgram.size())
+		REQUIRE(cpu.step());
+
+	REQUIRE(cpu.accumulator == B::Ok);
+	// 44 cycles of instructions, plus the transfer
+	REQUIRE(cpu.cycle == 44 + 100 + 2 * 512);
+	for (auto i = 0U; i < 512; i++)
+		REQUIRE(cpu.memory[0x3000 + i] ==
+			static_cast<uint8_t>((512 + i) * 7));
+	REQUIRE(cpu.memory[0x3200] == 0);
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Block device rejects transfers out of range", "[blockdevice]") {
+	const auto path = diskImage("microlator-test-range.bin");
+	auto cpu = emu::CPU{};
+	auto disk = B{path};
+
+	// Sector 3 only holds 256 bytes
+	disk.write(cpu, B::SectorLow, 3);
+	disk.write(cpu, B::LengthHigh, 2);
+	disk.write(cpu, B::Command, B::Read);
+	REQUIRE(disk.read(cpu, B::Status) == B::OutOfRange);
+	REQUIRE(cpu.memory[0] == 0);
+
+	disk.write(cpu, B::LengthHigh, 1);
+	disk.write(cpu, B::DestinationHigh, 0xff);
+	disk.write(cpu, B::DestinationLow, 1);
+	disk.write(cpu, B::Command, B::Read);
+	REQUIRE(disk.read(cpu, B::Status) == B::OutOfRange);
+
+	disk.write(cpu, B::DestinationLow, 0);
+	disk.write(cpu, B::Command, B::Read);
+	REQUIRE(disk.read(cpu, B::Status) == B::Ok);
+	REQUIRE(cpu.memory[0xffff] == static_cast<uint8_t>(1023 * 7));
+
+	disk.write(cpu, B::Command, 0xff);
+	REQUIRE(disk.read(cpu, B::Status) == B::UnknownCommand);
+
+	std::filesystem::remove(path);
+	REQUIRE_THROWS_AS(B{path}, std::system_error);
+}
+
+TEST_CASE("Block device transfers discard translated code",
+	  "[blockdevice][tiered]") {
+	const auto path = std::filesystem::temp_directory_path() /
+			  "microlator-test-reload.bin";
+	{
+		auto file = std::ofstream{path, std::ios::binary};
+		file.write("\xe6\x11\x60", 3); // INC $11; RTS
+	}
+
+	auto cpu = emu::CPU{};
+	auto disk = B{path};
+	cpu.loadProgram(reloadProgram);
+	cpu.map(disk, 0x80, 0x80);
+	cpu.memory[0x700] = 0xe6; // INC $10
+	cpu.memory[0x701] = 0x10;
+	cpu.memory[0x702] = 0x60; // RTS
+
+	auto engine = emu::TieredEngine{cpu, 4, 16};
+	REQUIRE(engine.run(20'000));
+	REQUIRE(cpu.pc == 0x62d);
+	REQUIRE(engine.statistics().blocksInvalidated > 0);
+	REQUIRE(cpu.memory[0x10] == 100);
+	REQUIRE(cpu.memory[0x11] == 100);
+
+	std::filesystem::remove(path);
+}
@@ -0,0 +1,50 @@
+// Built as C, to check that the interface can be used from C, through the
+// shared library, which should export nothing else
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <stdio.h>
+
+#include "microlator.h"
+
+// Counts X up from 0 into $10 until it wraps, then stops
+static const uint8_t countProgram[] = {
+    0xa2, 0x00, // LDX #0
+    0xe8,       // loop: INX
+    0x86, 0x10, // STX $10
+    0xd0, 0xfb, // BNE loop
+    0x02,       // Halt
+};
+
+static int check(int condition, const char *what) {
+	if (!condition)
+		fprintf(stderr, "Failed: %s\n", what);
+
+	return condition;
+}
+
+int main(void) {
+	microlator_cpu *cpu = microlator_create();
+	const microlator_cpu *const cpus[] = {cpu};
+	microlator_registers registers;
+	int passed = check(cpu != NULL, "CPU is created");
+
+	passed &= check(microlator_load_program(cpu, countProgram,
+						sizeof(countProgram),
+						0x600) == MICROLATOR_OK,
+			"Program is loaded");
+	passed &= check(!microlator_run(cpu, 10000), "Program halts");
+	passed &= check(microlator_memory(cpu)[0x10] == 0, "X wrapped");
+	passed &= check(microlator_get_registers(cpus, 1, &registers) ==
+			    MICROLATOR_OK,
+			"Registers are read");
+	passed &= check(registers.pc == 0x608, "Stopped after the halt");
+	microlator_destroy(cpu);
+
+	passed &= check(microlator_abi_version() == MICROLATOR_ABI_VERSION,
+			"ABI version matches");
+	passed &= check(dlsym(RTLD_DEFAULT, "_ZN10microlator3CPU4stepEv") ==
+			    NULL,
+			"C++ symbols are hidden");
+	return passed ? 0 : 1;
+}
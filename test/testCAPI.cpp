@@ -0,0 +1,150 @@
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "microlator.h"
+
+namespace {
+
+// Counts X up from 0 into $10 until it wraps, then stops
+constexpr auto countProgram = std::to_array<uint8_t>({
+    0xa2, 0x00, // LDX #0
+    0xe8,       // loop: INX
+    0x86, 0x10, // STX $10
+    0xd0, 0xfb, // BNE loop
+    0x02,       // Halt
+});
+
+struct Destroy {
+	void operator()(microlator_cpu *cpu) const { microlator_destroy(cpu); }
+};
+
+using Handle = std::unique_ptr<microlator_cpu, Destroy>;
+
+auto create() -> Handle {
+	auto cpu = Handle{microlator_create()};
+	REQUIRE(cpu != nullptr);
+	REQUIRE(microlator_load_program(cpu.get(), countProgram.data(),
+					countProgram.size(),
+					0x600) == MICROLATOR_OK);
+	return cpu;
+}
+
+} // namespace
+
+TEST_CASE("C API runs CPUs", "[capi]") {
+	REQUIRE(microlator_abi_version() == MICROLATOR_ABI_VERSION);
+
+	auto cpu = create();
+	REQUIRE(microlator_run(cpu.get(), 100) == 1);
+	REQUIRE(microlator_run(cpu.get(), 100'000) == 0);
+
+	auto memory = std::array<uint8_t, 2>{};
+	REQUIRE(microlator_read_memory(cpu.get(), 0x10, memory.data(),
+				       memory.size()) == MICROLATOR_OK);
+	REQUIRE(memory[0] == 0);
+
+	memory = {0x12, 0x34};
+	REQUIRE(microlator_write_memory(cpu.get(), 0x10, memory.data(),
+					memory.size()) == MICROLATOR_OK);
+	memory = {};
+	REQUIRE(microlator_read_memory(cpu.get(), 0x10, memory.data(),
+				       memory.size()) == MICROLATOR_OK);
+	REQUIRE(memory == std::array<uint8_t, 2>{0x12, 0x34});
+
+	microlator_reset(cpu.get());
+	REQUIRE(microlator_read_memory(cpu.get(), 0x10, memory.data(),
+				       memory.size()) == MICROLATOR_OK);
+	REQUIRE(memory == std::array<uint8_t, 2>{});
+
+	REQUIRE(microlator_read_memory(cpu.get(), 0xffff, memory.data(),
+				       memory.size()) ==
+		MICROLATOR_INVALID_ARGUMENT);
+	// Lengths which would wrap around the address space
+	REQUIRE(microlator_read_memory(cpu.get(), 0x10, memory.data(),
+				       SIZE_MAX - 8) ==
+		MICROLATOR_INVALID_ARGUMENT);
+	REQUIRE(microlator_write_memory(cpu.get(), 0x10, memory.data(),
+					SIZE_MAX) ==
+		MICROLATOR_INVALID_ARGUMENT);
+	REQUIRE(microlator_load_program(nullptr, countProgram.data(),
+					countProgram.size(),
+					0x600) == MICROLATOR_INVALID_ARGUMENT);
+
+	microlator_reset(nullptr);
+	REQUIRE(microlator_run(nullptr, 100) == 0);
+	REQUIRE(microlator_memory(nullptr) == nullptr);
+}
+
+TEST_CASE("C API operates on many CPUs at once", "[capi]") {
+	std::vector<Handle> handles;
+	std::vector<microlator_cpu *> cpus;
+	for (auto i = 0; i < 4; i++) {
+		handles.push_back(create());
+		cpus.push_back(handles.back().get());
+	}
+
+	auto registers = std::vector<microlator_registers>(cpus.size());
+	REQUIRE(microlator_get_registers(cpus.data(), cpus.size(),
+					 registers.data()) == MICROLATOR_OK);
+	for (size_t i = 0; i < registers.size(); i++) {
+		REQUIRE(registers[i].pc == 0x600);
+		// Start each CPU in the loop, with a different count left
+		registers[i].pc = 0x602;
+		registers[i].index_x = static_cast<uint8_t>(0xff - i);
+	}
+	REQUIRE(microlator_set_registers(cpus.data(), cpus.size(),
+					 registers.data()) == MICROLATOR_OK);
+
+	auto running = std::vector<int>(cpus.size());
+	REQUIRE(microlator_run_many(cpus.data(), cpus.size(), 30,
+				    running.data()) == MICROLATOR_OK);
+	REQUIRE(running == std::vector<int>{0, 0, 0, 1});
+
+	REQUIRE(microlator_get_registers(cpus.data(), cpus.size(),
+					 registers.data()) == MICROLATOR_OK);
+	REQUIRE(registers[0].pc == 0x608);
+	REQUIRE(registers[0].index_x == 0);
+	REQUIRE(registers[3].cycle >= 30);
+
+	cpus.push_back(nullptr);
+	REQUIRE(microlator_run_many(cpus.data(), cpus.size(), 30, nullptr) ==
+		MICROLATOR_INVALID_ARGUMENT);
+}
+
+TEST_CASE("C API saves and restores snapshots", "[capi]") {
+	auto cpu = create();
+	REQUIRE(microlator_run(cpu.get(), 200) == 1);
+
+	auto snapshot = std::vector<uint8_t>(MICROLATOR_SNAPSHOT_SIZE);
+	REQUIRE(microlator_save(cpu.get(), snapshot.data(),
+				snapshot.size() - 1) ==
+		MICROLATOR_INVALID_ARGUMENT);
+	REQUIRE(microlator_save(cpu.get(), snapshot.data(), snapshot.size()) ==
+		MICROLATOR_OK);
+
+	// Restoring into a new CPU continues from the same state
+	auto copy = Handle{microlator_create()};
+	REQUIRE(microlator_restore(copy.get(), snapshot.data(),
+				   snapshot.size()) == MICROLATOR_OK);
+	REQUIRE(microlator_run(cpu.get(), 1000) == 1);
+	REQUIRE(microlator_run(copy.get(), 1000) == 1);
+
+	auto registers = std::array<microlator_registers, 2>{};
+	const auto cpus = std::to_array<const microlator_cpu *>(
+	    {cpu.get(), copy.get()});
+	REQUIRE(microlator_get_registers(cpus.data(), cpus.size(),
+					 registers.data()) == MICROLATOR_OK);
+	REQUIRE(registers[0].cycle == registers[1].cycle);
+	REQUIRE(registers[0].pc == registers[1].pc);
+	REQUIRE(registers[0].index_x == registers[1].index_x);
+	REQUIRE(registers[0].flags == registers[1].flags);
+
+	snapshot[0] ^= 0xffU;
+	REQUIRE(microlator_restore(copy.get(), snapshot.data(),
+				   snapshot.size()) ==
+		MICROLATOR_INVALID_SNAPSHOT);
+}
@@ -36,6 +36,98 @@ TEST_CASE("CPU can execute", "[cpu]") {
 	REQUIRE(cpu.pc == 0x602);
 }
 
+TEST_CASE("CPU branches backwards", "[cpu]") {
+	constexpr auto program = std::to_array<uint8_t>({
+	    0xa2, 0x03, // LDX #$03
+	    0xca,       // loop: DEX
+	    0xd0, 0xfd, // BNE loop
+	});
+
+	auto cpu = emu::CPU();
+	cpu.loadProgram(program);
+	for (auto i = 0; i < 7; i++)
+		cpu.step();
+
+	REQUIRE(cpu.indexX == 0);
+	REQUIRE(cpu.pc == 0x605);
+}
+
+TEST_CASE("CPU carries out of ADC with carry in", "[cpu]") {
+	constexpr auto program = std::to_array<uint8_t>({
+	    0xa9, 0x10, // LDA #$10
+	    0x38,       // SEC
+	    0x69, 0xff, // ADC #$FF
+	});
+
+	auto cpu = emu::CPU();
+	cpu.loadProgram(program);
+	for (auto i = 0; i < 3; i++)
+		cpu.step();
+
+	REQUIRE(cpu.accumulator == 0x10);
+	REQUIRE(cpu.flags.test(emu::Flags::Index::Carry));
+}
+
+TEST_CASE("CPU reads indirect jumps within a page", "[cpu]") {
+	constexpr auto program = std::to_array<uint8_t>({
+	    0x6c, 0x10, 0x00, // JMP ($0010)
+	});
+
+	auto cpu = emu::CPU();
+	cpu.loadProgram(program);
+	cpu.memory[0x10] = 0x34;
+	cpu.memory[0x11] = 0x12;
+	cpu.step();
+
+	REQUIRE(cpu.pc == 0x1234);
+}
+
+TEST_CASE("CPU ignores writes to read-only pages", "[cpu]") {
+	constexpr auto program = std::to_array<uint8_t>({
+	    0xa9, 0x42,       // LDA #$42
+	    0x8d, 0x00, 0x80, // STA $8000
+	    0x8d, 0x00, 0x81, // STA $8100
+	});
+
+	auto cpu = emu::CPU();
+	cpu.loadProgram(program);
+	cpu.protect(0x80, 0x80);
+	REQUIRE(cpu.readOnly(0x80ff));
+	REQUIRE_FALSE(cpu.readOnly(0x8100));
+	REQUIRE(cpu.run(10));
+
+	REQUIRE(cpu.cycle == 10);
+	REQUIRE(cpu.memory[0x8000] == 0);
+	REQUIRE(cpu.memory[0x8100] == 0x42);
+
+	cpu.unprotect(0x80, 0x80);
+	REQUIRE_FALSE(cpu.readOnly(0x8000));
+}
+
+#ifdef MICROLATOR_LAST_WRITER
+TEST_CASE("CPU records the last writer of each address", "[cpu]") {
+	constexpr auto program = std::to_array<uint8_t>({
+	    0xa9, 0x42,       // LDA #$42
+	    0x85, 0x10,       // STA $10
+	    0xe6, 0x10,       // INC $10
+	    0x20, 0x0b, 0x06, // JSR $060b
+	    0xea,             // NOP
+	    0xea,             // NOP
+	    0x60,             // RTS
+	});
+
+	auto cpu = emu::CPU();
+	cpu.loadProgram(program);
+	for (auto i = 0; i < 4; i++)
+		cpu.step();
+
+	REQUIRE(cpu.lastWriters.at(0x10) == emu::LastWriter{0x604, 5});
+	REQUIRE(cpu.lastWriters.at(0x1fd) == emu::LastWriter{0x606, 10});
+	REQUIRE(cpu.lastWriters.at(0x1fc) == emu::LastWriter{0x606, 10});
+	REQUIRE(cpu.lastWriters.at(0x11) == emu::LastWriter{});
+}
+#endif
+
 TEST_CASE("CPU passes nestest", "[cpu]") {
 	auto cpu = emu::CPU();
 	cpu.loadProgram(nestestProgram, 0x8000);
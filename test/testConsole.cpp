@@ -0,0 +1,94 @@
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+#include "console.hpp"
+#include "cpu.hpp"
+
+namespace emu = microlator;
+using C = emu::Console;
+
+namespace {
+
+// Echoes input to output until there is none left, with the console at $8000
+constexpr auto echoProgram = std::to_array<uint8_t>({
+    0xad, 0x02, 0x80, // loop: LDA Status
+    0x29, 0x01,       // AND #InputReady
+    0xf0, 0x09,       // BEQ done
+    0xad, 0x01, 0x80, // LDA Input
+    0x8d, 0x00, 0x80, // STA Output
+    0x4c, 0x00, 0x06, // JMP loop
+    0x02,             // done: halt
+});
+
+// A pipe whose read end doesn't block
+struct Pipe {
+	Pipe() {
+		REQUIRE(::pipe(fds.data()) == 0);
+		REQUIRE(::fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0);
+	}
+	~Pipe() {
+		::close(fds[0]);
+		::close(fds[1]);
+	}
+	Pipe(const Pipe &) = delete;
+	Pipe(Pipe &&) = delete;
+	auto operator=(const Pipe &) -> Pipe & = delete;
+	auto operator=(Pipe &&) -> Pipe & = delete;
+
+	auto drain() -> std::string {
+		auto result = std::string(256, '\0');
+		const auto length =
+		    ::read(fds[0], result.data(), result.size());
+		result.resize(length < 0 ? 0 : static_cast<size_t>(length));
+		return result;
+	}
+
+	std::array<int, 2> fds{};
+};
+
+} // namespace
+
+TEST_CASE("Console flushes output by line", "[console]") {
+	auto pipe = Pipe{};
+	auto cpu = emu::CPU{};
+	auto console = C{pipe.fds[1]};
+
+	constexpr auto text = std::string_view{"Hi\nthere"};
+	console.provideInput({reinterpret_cast<const uint8_t *>(text.data()),
+			      text.size()});
+	cpu.loadProgram(echoProgram);
+	cpu.map(console, 0x80, 0x80);
+
+	REQUIRE_FALSE(cpu.run(10'000));
+	REQUIRE(cpu.pc == 0x0611);
+	REQUIRE(console.read(cpu, C::Input) == 0);
+
+	REQUIRE(pipe.drain() == "Hi\n");
+	REQUIRE(console.writes == 1);
+
+	REQUIRE(console.flush());
+	REQUIRE(pipe.drain() == "there");
+	REQUIRE(console.writes == 2);
+}
+
+TEST_CASE("Console flushes output when full", "[console]") {
+	auto pipe = Pipe{};
+	auto cpu = emu::CPU{};
+	auto console = C{pipe.fds[1], 4};
+	console.lineBuffered = false;
+
+	for (const auto c : std::string_view{"abc\ndefghi"})
+		console.write(cpu, C::Output, static_cast<uint8_t>(c));
+
+	REQUIRE(console.writes == 2);
+	REQUIRE(pipe.drain() == "abc\ndefg");
+
+	REQUIRE(console.flush());
+	REQUIRE(pipe.drain() == "hi");
+	REQUIRE(console.dropped == 0);
+}
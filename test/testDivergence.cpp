@@ -0,0 +1,111 @@
+#include <sstream>
+
+#include <catch2/catch.hpp>
+
+#include "cpu.hpp"
+#include "divergence.hpp"
+#include "nestest.hpp"
+#include "taint.hpp"
+
+namespace {
+
+// Nestest moves on to undocumented instructions after this many
+constexpr auto documentedInstructions = uint64_t{5003};
+constexpr auto unusedAddress = 0x7ff;
+
+auto nestestCPU() -> emu::CPU {
+	auto cpu = emu::CPU();
+	cpu.loadProgram(nestestProgram, 0x8000);
+	cpu.loadProgram(nestestProgram, 0xC000);
+	return cpu;
+}
+
+// An engine which corrupts an unused byte of memory after executing the
+// instruction from the given nestest state
+auto faultyEngine(size_t faultyState) -> emu::Engine {
+	const auto &state = nestestStates.at(faultyState);
+	const auto cycle = state.cycle - nestestStates[0].cycle;
+	return [&state, cycle](emu::CPU &cpu, uint64_t instructions) {
+		for (uint64_t i = 0; i < instructions; i++) {
+			const auto faulty =
+			    cpu.pc == state.pc && cpu.cycle == cycle;
+			if (!cpu.step())
+				return false;
+
+			if (faulty)
+				cpu.memory[unusedAddress] ^= 0x40U;
+		}
+
+		return true;
+	};
+}
+
+} // namespace
+
+TEST_CASE("Tainted execution does not diverge", "[divergence]") {
+	// Engines are called concurrently, so each call tracks taint of its
+	// own
+	const auto tainted = [](emu::CPU &cpu, uint64_t instructions) {
+		auto taint = emu::TaintState();
+		for (uint64_t i = 0; i < instructions; i++) {
+			if (!cpu.step(taint))
+				return false;
+		}
+
+		return true;
+	};
+
+	REQUIRE_FALSE(emu::findDivergence(nestestCPU(), emu::stepEngine,
+					  tainted, documentedInstructions + 10,
+					  1000, 1));
+}
+
+TEST_CASE("Tiered execution does not diverge", "[divergence][tiered]") {
+	const auto interval =
+	    GENERATE(uint64_t{1}, uint64_t{97}, uint64_t{1000});
+
+	REQUIRE_FALSE(emu::findDivergence(
+	    nestestCPU(), emu::stepEngine, emu::tieredEngine(2, 4),
+	    documentedInstructions + 10, interval, 2));
+}
+
+TEST_CASE("Divergence bisection finds the diverging instruction",
+	  "[divergence]") {
+	const auto threads = GENERATE(1U, 2U, 5U);
+	const auto interval =
+	    GENERATE(uint64_t{1}, uint64_t{97}, uint64_t{700});
+	const auto faultyState = size_t{3210};
+
+	const auto divergence = emu::findDivergence(
+	    nestestCPU(), emu::stepEngine, faultyEngine(faultyState),
+	    documentedInstructions, interval, threads);
+
+	REQUIRE(divergence);
+	REQUIRE(divergence->instruction == faultyState);
+	REQUIRE(divergence->before.pc == nestestStates.at(faultyState).pc);
+	REQUIRE(divergence->reference.pc ==
+		nestestStates.at(faultyState + 1).pc);
+	REQUIRE((divergence->reference.memory[unusedAddress] ^
+		 divergence->candidate.memory[unusedAddress]) == 0x40U);
+
+	std::ostringstream os;
+	os << *divergence;
+	REQUIRE(os.str().find("diverge at instruction 3210") !=
+		std::string::npos);
+}
+
+TEST_CASE("Divergence bisection finds an engine halting early",
+	  "[divergence]") {
+	const auto halting = [](emu::CPU &cpu, uint64_t instructions) {
+		return cpu.cycle < 1000 && emu::stepEngine(cpu, instructions);
+	};
+
+	const auto divergence =
+	    emu::findDivergence(nestestCPU(), emu::stepEngine, halting,
+				documentedInstructions, 256, 3);
+
+	REQUIRE(divergence);
+	REQUIRE(divergence->before.cycle >= 1000);
+	REQUIRE(divergence->candidateHalted);
+	REQUIRE_FALSE(divergence->referenceHalted);
+}
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "fairshare.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+// Loops forever
+constexpr auto loopProgram = std::to_array<uint8_t>({
+    0xe8,             // loop: INX
+    0x4c, 0x00, 0x06, // JMP loop
+});
+
+auto loopingCPUs(size_t count) -> std::vector<emu::CPU> {
+	std::vector<emu::CPU> cpus(count);
+	for (auto &cpu : cpus)
+		cpu.loadProgram(loopProgram);
+
+	return cpus;
+}
+
+auto ratio(uint64_t a, uint64_t b) -> double {
+	return static_cast<double>(a) / static_cast<double>(b);
+}
+
+} // namespace
+
+TEST_CASE("FairShareScheduler shares cycles by weight", "[fairshare]") {
+	auto cpus = loopingCPUs(3);
+	auto scheduler = emu::FairShareScheduler{2};
+	const auto light = scheduler.add(cpus[0]);
+	const auto heavy = scheduler.add(cpus[1], {.weight = 3});
+	const auto other = scheduler.add(cpus[2]);
+
+	for (auto i = 0; i < 20; i++)
+		REQUIRE(scheduler.runRound());
+
+	const auto &lightAccount = scheduler.account(light);
+	REQUIRE(lightAccount.slices == 20);
+	REQUIRE(lightAccount.cycles == cpus[0].cycle);
+	REQUIRE(ratio(scheduler.account(heavy).cycles, lightAccount.cycles) ==
+		Approx(3).epsilon(0.01));
+	REQUIRE(ratio(scheduler.account(other).cycles, lightAccount.cycles) ==
+		Approx(1).epsilon(0.01));
+
+	scheduler.remove(other);
+	REQUIRE_THROWS_AS(scheduler.account(other), std::invalid_argument);
+	REQUIRE(scheduler.runRound());
+	REQUIRE(scheduler.account(light).slices == 21);
+}
+
+TEST_CASE("FairShareScheduler enforces quotas", "[fairshare]") {
+	auto cpus = loopingCPUs(2);
+	auto scheduler = emu::FairShareScheduler{1};
+	const auto limited = scheduler.add(cpus[0], {.quota = 1000});
+	const auto unlimited = scheduler.add(cpus[1]);
+
+	for (auto i = 0; i < 5; i++)
+		REQUIRE(scheduler.runRound());
+
+	const auto &account = scheduler.account(limited);
+	// Runs may overshoot by the instruction they end in
+	REQUIRE(account.periodCycles >= 1000);
+	REQUIRE(account.periodCycles < 1010);
+	REQUIRE(account.throttled == 4);
+	REQUIRE(scheduler.account(unlimited).slices == 5);
+
+	scheduler.startPeriod();
+	REQUIRE(scheduler.runRound());
+	REQUIRE(account.periodCycles > 0);
+	REQUIRE(account.cycles > 1000);
+}
+
+TEST_CASE("FairShareScheduler sizes slices to the target latency",
+	  "[fairshare]") {
+	using namespace std::chrono_literals;
+
+	auto cpus = loopingCPUs(8);
+	auto scheduler = emu::FairShareScheduler{1, 2ms};
+	for (auto &cpu : cpus)
+		scheduler.add(cpu);
+
+	for (auto i = 0; i < 20; i++)
+		REQUIRE(scheduler.runRound());
+
+	// Within a wide margin, as the measured rate is noisy
+	const auto start = emu::FairShareScheduler::Clock::now();
+	for (auto i = 0; i < 10; i++)
+		REQUIRE(scheduler.runRound());
+	const auto round = (emu::FairShareScheduler::Clock::now() - start) / 10;
+	REQUIRE(round > 500us);
+	REQUIRE(round < 20ms);
+}
+
+TEST_CASE("FairShareScheduler runs tenants to their deadlines",
+	  "[fairshare]") {
+	using namespace std::chrono_literals;
+
+	auto cpus = loopingCPUs(2);
+	auto scheduler = emu::FairShareScheduler{1};
+	const auto now = emu::FairShareScheduler::Clock::now();
+	const auto urgent = scheduler.add(
+	    cpus[0], {.deadlineCycle = 1'000'000, .deadline = now + 1h});
+	const auto late = scheduler.add(
+	    cpus[1], {.deadlineCycle = 1'000'000, .deadline = now - 1s});
+
+	// With no round to estimate from, the whole remainder is run at once
+	REQUIRE(scheduler.runRound());
+	REQUIRE(cpus[0].cycle >= 1'000'000);
+	REQUIRE(cpus[1].cycle >= 1'000'000);
+	REQUIRE_FALSE(scheduler.account(urgent).deadlineMissed);
+	REQUIRE(scheduler.account(late).deadlineMissed);
+}
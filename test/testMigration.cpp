@@ -0,0 +1,181 @@
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+#include "migration.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+// Counts into $10 and $11
+constexpr auto countProgram = std::to_array<uint8_t>({
+    0xe6, 0x10,       // loop: INC $10
+    0xd0, 0x02,       // BNE same
+    0xe6, 0x11,       // INC $11
+    0xa6, 0x10,       // same: LDX $10
+    0xa4, 0x10,       // LDY $10
+    0x4c, 0x00, 0x06, // JMP loop
+});
+
+auto uniquePath(const char *test) -> std::string {
+	return std::string{"/tmp/microlator-"} + test + "-" +
+	       std::to_string(::getpid());
+}
+
+auto counter() -> emu::CPU {
+	auto cpu = emu::CPU{};
+	cpu.loadProgram(countProgram);
+	// Memory outside the pages the program writes, which is only sent once
+	cpu.memory[0x8000] = 0x42;
+	cpu.memory[0xfffc] = 0x24;
+	REQUIRE(cpu.run(5'000));
+	return cpu;
+}
+
+void requireSameState(const emu::CPU &a, const emu::CPU &b) {
+	REQUIRE(a.cycle == b.cycle);
+	REQUIRE(a.pc == b.pc);
+	REQUIRE(a.accumulator == b.accumulator);
+	REQUIRE(a.indexX == b.indexX);
+	REQUIRE(a.indexY == b.indexY);
+	REQUIRE(a.stack == b.stack);
+	REQUIRE(a.flags.get() == b.flags.get());
+	REQUIRE(a.memory == b.memory);
+}
+
+} // namespace
+
+TEST_CASE("Migration pre-copies memory while the CPU runs", "[migration]") {
+	const auto path = uniquePath("precopy");
+	auto listener = emu::MigrationListener{path};
+	auto source = counter();
+	auto destination = emu::CPU{};
+
+	auto result = emu::MigrationResult{};
+	{
+		auto sender = std::jthread{[&] {
+			result = emu::migrate(source, path, {10'000, 8, 4});
+		}};
+		listener.accept(destination);
+	}
+
+	// Every page was sent while the CPU ran, after which only the zero
+	// page it counts in was dirty
+	REQUIRE(result.rounds == 1);
+	REQUIRE(result.finalPages == 1);
+	REQUIRE(result.pagesSent == emu::CPU::pageCount + 1);
+	REQUIRE_FALSE(result.stopped);
+	REQUIRE(source.cycle >= 15'000 + result.waitCycles);
+	requireSameState(source, destination);
+
+	// And both carry on identically
+	auto copy = source;
+	REQUIRE(copy.run(50'000));
+	REQUIRE(destination.run(50'000));
+	requireSameState(copy, destination);
+}
+
+TEST_CASE("Migration stops the CPU after the last round", "[migration]") {
+	const auto path = uniquePath("rounds");
+	auto listener = emu::MigrationListener{path};
+	auto source = counter();
+	auto destination = emu::CPU{};
+
+	SECTION("Rounds are limited while pages are still dirtied") {
+		auto result = emu::MigrationResult{};
+		{
+			auto sender = std::jthread{[&] {
+				result = emu::migrate(source, path,
+						      {1'000, 3, 0});
+			}};
+			listener.accept(destination);
+		}
+
+		REQUIRE(result.rounds == 3);
+		REQUIRE(result.finalPages == 1);
+		requireSameState(source, destination);
+	}
+
+	SECTION("A stopped CPU is copied without more rounds") {
+		source.memory[0x600] = 0x02;
+		auto result = emu::MigrationResult{};
+		{
+			auto sender = std::jthread{[&] {
+				result = emu::migrate(source, path,
+						      {1'000, 3, 0});
+			}};
+			listener.accept(destination);
+		}
+
+		REQUIRE(result.stopped);
+		REQUIRE(result.rounds == 1);
+		requireSameState(source, destination);
+	}
+}
+
+TEST_CASE("Migration moves a CPU between processes", "[migration]") {
+	const auto path = uniquePath("process");
+	auto listener = emu::MigrationListener{path};
+	const auto expected = counter();
+
+	const auto child = ::fork();
+	REQUIRE(child >= 0);
+	if (child == 0) {
+		auto source = counter();
+		try {
+			emu::migrate(source, path);
+		} catch (...) {
+			::_exit(1);
+		}
+		::_exit(0);
+	}
+
+	auto destination = emu::CPU{};
+	listener.accept(destination);
+	auto status = 0;
+	REQUIRE(::waitpid(child, &status, 0) == child);
+	REQUIRE(WIFEXITED(status));
+	REQUIRE(WEXITSTATUS(status) == 0);
+
+	// The child ran on past where the parent's copy stopped
+	REQUIRE(destination.cycle > expected.cycle);
+	REQUIRE(destination.memory[0x8000] == 0x42);
+	auto copy = expected;
+	REQUIRE(copy.run(destination.cycle));
+	REQUIRE(copy.memory[0x10] == destination.memory[0x10]);
+}
+
+TEST_CASE("Migration rejects invalid streams", "[migration]") {
+	const auto path = uniquePath("invalid");
+	auto source = emu::CPU{};
+	REQUIRE_THROWS_AS(emu::migrate(source, path), std::system_error);
+	REQUIRE_THROWS_AS(emu::MigrationListener{std::string(200, 'x')},
+			  std::invalid_argument);
+
+	auto listener = emu::MigrationListener{path};
+	auto sender = std::jthread{[&] {
+		const auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		auto address = sockaddr_un{};
+		address.sun_family = AF_UNIX;
+		path.copy(address.sun_path, path.size());
+		if (::connect(fd, reinterpret_cast<const sockaddr *>(&address),
+			      sizeof(address)) == 0)
+			::write(fd, "MLTR", 4);
+		::close(fd);
+	}};
+
+	auto destination = emu::CPU{};
+	destination.memory[0x10] = 0x42;
+	REQUIRE_THROWS_AS(listener.accept(destination), std::invalid_argument);
+	REQUIRE(destination.memory[0x10] == 0x42);
+}
@@ -0,0 +1,103 @@
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+#include "monitor.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+// Counts into $10 and $11
+constexpr auto countProgram = std::to_array<uint8_t>({
+    0xe6, 0x10,       // loop: INC $10
+    0xd0, 0x02,       // BNE same
+    0xe6, 0x11,       // INC $11
+    0xa6, 0x10,       // same: LDX $10
+    0xa4, 0x10,       // LDY $10
+    0x4c, 0x00, 0x06, // JMP loop
+});
+
+auto uniqueName(const char *test) -> std::string {
+	return std::string{"/microlator-"} + test + "-" +
+	       std::to_string(::getpid());
+}
+
+} // namespace
+
+TEST_CASE("CPUMonitor reads a running CPU", "[monitor]") {
+	const auto name = uniqueName("read");
+	auto monitored = emu::MonitoredCPU{name};
+	auto &cpu = monitored.cpu();
+	cpu.loadProgram(countProgram);
+	monitored.publish();
+
+	const auto monitor = emu::CPUMonitor{name};
+	REQUIRE(monitor.registers().pc == 0x600);
+	REQUIRE_FALSE(monitor.registers().stopped);
+
+	REQUIRE(monitored.run(10'000, 1000));
+	const auto registers = monitor.registers();
+	REQUIRE(registers.cycle == cpu.cycle);
+	REQUIRE(registers.pc == cpu.pc);
+	REQUIRE(registers.indexX == cpu.indexX);
+	REQUIRE(registers.flags == cpu.flags.get());
+
+	// Memory is read in place, without being published
+	REQUIRE(monitor.memory()[0x10] == cpu.memory[0x10]);
+	cpu.memory[0x10] = 0x42;
+	REQUIRE(monitor.memory()[0x10] == 0x42);
+
+	REQUIRE_THROWS_AS(emu::MonitoredCPU{name}, std::system_error);
+	REQUIRE_THROWS_AS(emu::CPUMonitor{uniqueName("missing")},
+			  std::system_error);
+}
+
+TEST_CASE("CPUMonitor reads consistent registers", "[monitor]") {
+	const auto name = uniqueName("consistent");
+	auto monitored = emu::MonitoredCPU{name};
+	auto &cpu = monitored.cpu();
+
+	std::atomic<bool> done{false};
+	auto consistent = true;
+	std::atomic<unsigned> reads{0};
+	auto reader = std::jthread{[&] {
+		const auto monitor = emu::CPUMonitor{name};
+		auto last = uint64_t{0};
+		while (!done) {
+			const auto registers = monitor.registers();
+			const auto expected =
+			    static_cast<uint8_t>(registers.cycle);
+			consistent = consistent &&
+				     registers.accumulator == expected &&
+				     registers.indexX == expected &&
+				     registers.indexY == expected &&
+				     registers.cycle >= last;
+			last = registers.cycle;
+			reads++;
+		}
+	}};
+
+	// Every register published together matches the cycle. Keep publishing
+	// until the reader has overlapped with plenty of publishes, however
+	// late it starts
+	constexpr auto minimumReads = 10'000U;
+	for (auto cycle = uint64_t{1}; cycle <= 200'000 || reads < minimumReads;
+	     cycle++) {
+		const auto value = static_cast<uint8_t>(cycle);
+		cpu.cycle = cycle;
+		cpu.accumulator = value;
+		cpu.indexX = value;
+		cpu.indexY = value;
+		monitored.publish();
+	}
+	done = true;
+	reader.join();
+	REQUIRE(consistent);
+	REQUIRE(reads >= minimumReads);
+}
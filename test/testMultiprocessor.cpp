@@ -0,0 +1,83 @@
+#include <catch2/catch.hpp>
+
+#include "multiprocessor.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+// Increments the shared counter at $8000 each time the other CPU has echoed
+// it to $8001, then spends a while on its own
+constexpr auto pingProgram = std::to_array<uint8_t>({
+    0xad, 0x01, 0x80, // loop: LDA $8001
+    0xcd, 0x00, 0x80, // CMP $8000
+    0xd0, 0xf8,       // BNE loop
+    0xee, 0x00, 0x80, // INC $8000
+    0xa2, 0x00,       // LDX #0
+    0xca,             // delay: DEX
+    0xd0, 0xfd,       // BNE delay
+    0x4c, 0x00, 0x06, // JMP loop
+});
+
+// Echoes the shared counter, then spends a while on its own
+constexpr auto pongProgram = std::to_array<uint8_t>({
+    0xad, 0x00, 0x80, // loop: LDA $8000
+    0x8d, 0x01, 0x80, // STA $8001
+    0xa2, 0x80,       // LDX #$80
+    0xca,             // delay: DEX
+    0xd0, 0xfd,       // BNE delay
+    0x4c, 0x00, 0x06, // JMP loop
+});
+
+constexpr auto cycles = 200'000;
+
+struct Result {
+	uint8_t rounds;
+	uint64_t quanta;
+	std::array<uint64_t, 2> cycles;
+};
+
+auto pingPong(uint64_t maxQuantum) -> Result {
+	auto system = emu::Multiprocessor{2, 1, maxQuantum};
+	const auto &shared = system.share(0x80, 0x80);
+	system.cpus[0].loadProgram(pingProgram);
+	system.cpus[1].loadProgram(pongProgram);
+
+	REQUIRE(system.run(cycles));
+	return {shared.memory[0], system.quanta(),
+		{system.cpus[0].cycle, system.cpus[1].cycle}};
+}
+
+} // namespace
+
+TEST_CASE("Multiprocessor grows quanta for independent CPUs",
+	  "[multiprocessor]") {
+	auto system = emu::Multiprocessor{2, 1, 1024};
+	// An infinite loop of JMP $0600
+	for (auto &cpu : system.cpus)
+		cpu.loadProgram(std::to_array<uint8_t>({0x4c, 0x00, 0x06}));
+
+	REQUIRE(system.run(100'000));
+	REQUIRE(system.quantum() == 1024);
+	// 1 + 2 + ... + 512 = 1023 cycles, then the rest 1024 at a time
+	REQUIRE(system.quanta() == 10 + (100'000 - 1023 + 1024 - 1) / 1024);
+	for (const auto &cpu : system.cpus)
+		REQUIRE(cpu.cycle >= 100'000);
+}
+
+TEST_CASE("Multiprocessor shrinks quanta around shared accesses",
+	  "[multiprocessor]") {
+	const auto lockstep = pingPong(1);
+	const auto adaptive = pingPong(4096);
+
+	REQUIRE(lockstep.quanta == cycles);
+	REQUIRE(adaptive.quanta < cycles / 10);
+	// Each round trip takes about 1300 cycles, mostly in the delay loop
+	REQUIRE(lockstep.rounds == 154);
+	REQUIRE(adaptive.rounds == lockstep.rounds);
+
+	// Runs are deterministic
+	const auto again = pingPong(4096);
+	REQUIRE(again.quanta == adaptive.quanta);
+	REQUIRE(again.cycles == adaptive.cycles);
+}
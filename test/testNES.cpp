@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "nes.hpp"
+#include "nestest.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+// Counts NMIs in RAM
+constexpr auto nmiProgram = std::to_array<uint8_t>({
+    0x78,             // SEI
+    0xa9, 0x80,       // LDA #$80
+    0x8d, 0x00, 0x20, // STA PPUCTRL
+    0x4c, 0x06, 0xc0, // loop: JMP loop
+    0xe6, 0x10,       // nmi: INC $10
+    0x40,             // RTI
+});
+
+// Counts vertical blanks seen in PPUSTATUS in RAM
+constexpr auto statusProgram = std::to_array<uint8_t>({
+    0xad, 0x02, 0x20, // wait: LDA PPUSTATUS
+    0x10, 0xfb,       // BPL wait
+    0xe6, 0x10,       // INC $10
+    0x4c, 0x00, 0xc0, // JMP wait
+});
+
+constexpr auto dmaProgram = std::to_array<uint8_t>({
+    0xa9, 0x02,       // LDA #$02
+    0x8d, 0x14, 0x40, // STA OAMDMA
+    0x4c, 0x05, 0xc0, // loop: JMP loop
+});
+
+// Stores nine reads of the first controller in RAM
+constexpr auto controllerProgram = std::to_array<uint8_t>({
+    0xa9, 0x01,       // LDA #$01
+    0x8d, 0x16, 0x40, // STA JOY1
+    0xa9, 0x00,       // LDA #$00
+    0x8d, 0x16, 0x40, // STA JOY1
+    0xa2, 0x00,       // LDX #$00
+    0xad, 0x16, 0x40, // read: LDA JOY1
+    0x95, 0x10,       // STA $10,X
+    0xe8,             // INX
+    0xe0, 0x09,       // CPX #$09
+    0xd0, 0xf6,       // BNE read
+    0x4c, 0x16, 0xc0, // loop: JMP loop
+});
+
+// Stores to the start of PRG ROM, then reads it back into RAM
+constexpr auto romWriteProgram = std::to_array<uint8_t>({
+    0xa9, 0x55,       // LDA #$55
+    0x8d, 0x00, 0x80, // STA $8000
+    0xad, 0x00, 0x80, // LDA $8000
+    0x85, 0x10,       // STA $10
+    0x4c, 0x0a, 0xc0, // loop: JMP loop
+});
+
+// An iNES image with one bank of PRG ROM, holding program at $C000
+auto image(std::span<const uint8_t> program, uint16_t nmi = 0xc000)
+    -> std::vector<uint8_t> {
+	auto result = std::vector<uint8_t>{'N', 'E', 'S', 0x1a, 1};
+	result.resize(16 + 0x4000);
+
+	auto prg = result.begin() + 16;
+	std::ranges::copy(program, prg);
+	prg[0x3ffa] = static_cast<uint8_t>(nmi);
+	prg[0x3ffb] = static_cast<uint8_t>(nmi >> 8U);
+	prg[0x3ffc] = 0x00;
+	prg[0x3ffd] = 0xc0;
+	return result;
+}
+
+} // namespace
+
+TEST_CASE("NES raises NMIs at vertical blank", "[nes]") {
+	const auto rom = image(nmiProgram, 0xc009);
+	auto nes = emu::Nes(rom);
+
+	REQUIRE(nes.cpu.pc == 0xc000);
+	REQUIRE(nes.runFrames(4));
+	REQUIRE(nes.ppu.frame == 4);
+	REQUIRE(nes.cpu.cycle >= emu::Nes::vblankCycle(3));
+	// The fourth NMI has been taken, but its handler has not yet run
+	REQUIRE(nes.cpu.pc == 0xc009);
+	REQUIRE(nes.cpu.memory[0x10] == 3);
+}
+
+TEST_CASE("NES reports vertical blank in PPU status", "[nes]") {
+	const auto rom = image(statusProgram);
+	auto nes = emu::Nes(rom);
+
+	REQUIRE(nes.scheduler.run(nes.cpu, emu::Nes::vblankCycle(3)));
+	REQUIRE(nes.cpu.memory[0x10] == 3);
+	REQUIRE(nes.ppu.vblank);
+
+	// Reading the status clears the flag, through any mirror
+	REQUIRE(nes.read(nes.cpu, 0x3ffa) == 0x80);
+	REQUIRE(nes.read(nes.cpu, 0x2002) == 0x00);
+}
+
+TEST_CASE("NES OAM DMA stalls the CPU in one step", "[nes]") {
+	const auto rom = image(dmaProgram);
+
+	for (const auto &[start, stall] : {std::pair{0U, 513U}, {1U, 514U}}) {
+		auto nes = emu::Nes(rom);
+		for (auto i = 0U; i < 0x100; i++)
+			nes.cpu.memory[0x200 + i] = static_cast<uint8_t>(i);
+
+		nes.ppu.oamAddress = 0x10;
+		nes.cpu.cycle = start;
+		REQUIRE(nes.cpu.step());
+		REQUIRE(nes.cpu.step());
+		REQUIRE(nes.cpu.cycle == start + 6 + stall);
+
+		// The copy starts at the OAM address, wrapping around
+		REQUIRE(nes.ppu.oam[0x10] == 0x00);
+		REQUIRE(nes.ppu.oam[0x0f] == 0xff);
+	}
+}
+
+TEST_CASE("NES controllers shift out buttons", "[nes]") {
+	const auto rom = image(controllerProgram);
+	auto nes = emu::Nes(rom);
+
+	nes.buttons[0] = emu::Nes::A | emu::Nes::Start | emu::Nes::Right;
+	REQUIRE(nes.runFrames(1));
+
+	const auto expected =
+	    std::to_array<uint8_t>({1, 0, 0, 1, 0, 0, 0, 1, 1});
+	for (auto i = 0U; i < expected.size(); i++)
+		REQUIRE(nes.cpu.memory[0x10 + i] == (0x40 | expected[i]));
+}
+
+TEST_CASE("NES ignores writes to PRG ROM", "[nes]") {
+	const auto rom = image(romWriteProgram);
+	auto nes = emu::Nes(rom);
+
+	REQUIRE(nes.runFrames(1));
+	REQUIRE(nes.cpu.memory[0x8000] == romWriteProgram[0]);
+	REQUIRE(nes.cpu.memory[0x10] == romWriteProgram[0]);
+}
+
+TEST_CASE("NES boots nestest", "[nes]") {
+	auto rom = std::vector<uint8_t>{'N', 'E', 'S', 0x1a, 1};
+	rom.resize(16);
+	rom.insert(rom.end(), nestestProgram.begin(), nestestProgram.end());
+	auto nes = emu::Nes(rom);
+
+	REQUIRE(nes.cpu.pc == 0xc004);
+	REQUIRE(nes.runFrames(30));
+
+	// The menu has been written to the first name table
+	const auto *names = nes.ppu.vram.data() + 0x2000;
+	REQUIRE(std::any_of(names, names + 0x400, [](auto c) { return c; }));
+
+	REQUIRE_THROWS_AS(emu::Nes(nestestProgram), std::invalid_argument);
+}
+
+TEST_CASE("NES rejects unsupported images", "[nes]") {
+	// Mapper 0 has at most one bank of CHR ROM
+	auto rom = image(nmiProgram);
+	rom[5] = 3;
+	rom.resize(rom.size() + 3 * 0x2000);
+	REQUIRE_THROWS_AS(emu::Nes(rom), std::invalid_argument);
+
+	rom = image(nmiProgram);
+	rom[6] = 0x10;
+	REQUIRE_THROWS_AS(emu::Nes(rom), std::invalid_argument);
+}
@@ -0,0 +1,159 @@
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "network.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+// Passes a token around a ring, adding one to it at each CPU. $01 holds the
+// next CPU, and $02 whether this CPU starts the token
+constexpr auto ringProgram = std::to_array<uint8_t>({
+    0xa5, 0x02,       // LDA $02
+    0xf0, 0x08,       // BEQ wait
+    0xa5, 0x01,       // LDA $01
+    0x8d, 0x00, 0x80, // STA Destination
+    0x8d, 0x01, 0x80, // STA Send
+    0xad, 0x03, 0x80, // wait: LDA Status
+    0xf0, 0xfb,       // BEQ wait
+    0xad, 0x02, 0x80, // LDA Receive
+    0x18,             // CLC
+    0x69, 0x01,       // ADC #1
+    0x85, 0x10,       // STA $10
+    0xa6, 0x01,       // LDX $01
+    0x8e, 0x00, 0x80, // STX Destination
+    0x8d, 0x01, 0x80, // STA Send
+    0xe6, 0x11,       // INC $11
+    0x4c, 0x0c, 0x06, // JMP wait
+});
+
+// Sends a count to the CPU in $01 as often as it polls for a message, after a
+// delay of $02 each time, summing what it receives with the count it was
+// received at into $10. As delays differ, polls drift across the ends of
+// windows. Polling through a pointer which crosses a page makes the read late
+// enough in its instruction to see a message sent in the same window
+constexpr auto chatterProgram = std::to_array<uint8_t>({
+    0xa5, 0x01,       // LDA $01
+    0x8d, 0x00, 0x80, // STA Destination
+    0xa0, 0x07,       // LDY #7
+    0xa6, 0x02,       // loop: LDX $02
+    0xca,             // delay: DEX
+    0xd0, 0xfd,       // BNE delay
+    0xb1, 0x20,       // LDA ($20),Y (Receive)
+    0x45, 0x11,       // EOR $11
+    0x18,             // CLC
+    0x65, 0x10,       // ADC $10
+    0x85, 0x10,       // STA $10
+    0xe6, 0x11,       // INC $11
+    0xa5, 0x11,       // LDA $11
+    0x8d, 0x01, 0x80, // STA Send
+    0x4c, 0x07, 0x06, // JMP loop
+});
+
+constexpr auto ringSize = size_t{4};
+// Short enough that no CPU's hop count overflows
+constexpr auto cycles = 40'000;
+
+auto ring(unsigned threads) -> std::vector<emu::CPU> {
+	auto links = std::vector<emu::Link>{};
+	for (auto i = size_t{0}; i < ringSize; i++)
+		links.push_back({i, (i + 1) % ringSize, 50});
+
+	auto network = emu::Network{ringSize, links, 0x80};
+	for (auto i = size_t{0}; i < ringSize; i++) {
+		auto &cpu = network.cpus[i];
+		cpu.loadProgram(ringProgram);
+		cpu.memory[0x01] = static_cast<uint8_t>((i + 1) % ringSize);
+		cpu.memory[0x02] = i == 0 ? 1 : 0;
+	}
+
+	REQUIRE(network.run(cycles, threads));
+	REQUIRE(network.dropped() == 0);
+	return network.cpus;
+}
+
+} // namespace
+
+TEST_CASE("Network results don't depend on threads", "[network]") {
+	const auto single = ring(1);
+	const auto parallel = ring(ringSize);
+
+	// Each hop takes at least the 50 cycle latency
+	auto hops = 0U;
+	for (const auto &cpu : single)
+		hops += cpu.memory[0x11];
+	REQUIRE(hops > cycles / 100);
+	REQUIRE(hops < cycles / 50);
+
+	for (auto i = size_t{0}; i < ringSize; i++) {
+		REQUIRE(single[i].cycle == parallel[i].cycle);
+		REQUIRE(single[i].memory == parallel[i].memory);
+	}
+}
+
+TEST_CASE("Network results don't depend on threads at window ends",
+	  "[network]") {
+	constexpr auto nodes = size_t{8};
+	const auto chatter = [](unsigned threads) {
+		auto links = std::vector<emu::Link>{};
+		for (auto i = size_t{0}; i < nodes; i++)
+			links.push_back({i, (i + 1) % nodes, 7});
+
+		auto network = emu::Network{nodes, links, 0x80};
+		for (auto i = size_t{0}; i < nodes; i++) {
+			auto &cpu = network.cpus[i];
+			cpu.loadProgram(chatterProgram);
+			cpu.memory[0x01] =
+			    static_cast<uint8_t>((i + 1) % nodes);
+			cpu.memory[0x02] = static_cast<uint8_t>(nodes - i);
+			// Seven bytes before Receive, on the page below
+			cpu.memory[0x20] = 0xfb;
+			cpu.memory[0x21] = 0x7f;
+		}
+
+		REQUIRE(network.run(20'000, threads));
+		return network.cpus;
+	};
+
+	const auto single = chatter(1);
+	for (const auto threads : {2U, 3U, unsigned{nodes}}) {
+		const auto parallel = chatter(threads);
+		for (auto i = size_t{0}; i < nodes; i++) {
+			REQUIRE(single[i].cycle == parallel[i].cycle);
+			REQUIRE(single[i].memory == parallel[i].memory);
+		}
+	}
+}
+
+TEST_CASE("Network delivers messages after their latency", "[network]") {
+	const auto links = std::to_array<emu::Link>({{0, 1, 100}});
+	auto network = emu::Network{2, links, 0x80};
+
+	// Sends 1 from CPU 0 on cycle 10, then CPU 1 receives it into $10.
+	// CPU 0 also sends to itself, for which there is no link
+	network.cpus[0].loadProgram(std::to_array<uint8_t>({
+	    0xa9, 0x01,       // LDA #1
+	    0x8d, 0x00, 0x80, // STA Destination
+	    0x8d, 0x01, 0x80, // STA Send
+	    0x8c, 0x00, 0x80, // STY Destination
+	    0x8d, 0x01, 0x80, // STA Send
+	    0x4c, 0x0e, 0x06, // loop: JMP loop
+	}));
+	network.cpus[1].loadProgram(std::to_array<uint8_t>({
+	    0xad, 0x02, 0x80, // loop: LDA Receive
+	    0xf0, 0xfb,       // BEQ loop
+	    0x85, 0x10,       // STA $10
+	    0x4c, 0x07, 0x06, // spin: JMP spin
+	}));
+
+	REQUIRE(network.run(105));
+	REQUIRE(network.cpus[1].memory[0x10] == 0);
+	REQUIRE(network.run(200));
+	REQUIRE(network.cpus[1].memory[0x10] == 1);
+	REQUIRE(network.dropped() == 1);
+
+	REQUIRE_THROWS_AS(emu::Network(1, links, 0x80), std::invalid_argument);
+}
@@ -0,0 +1,132 @@
+import sys
+import threading
+import unittest
+
+import microlator
+
+# Counts X up from 0 into $10 until it wraps, then stops
+COUNT_PROGRAM = bytes([
+    0xa2, 0x00,  # LDX #0
+    0xe8,        # loop: INX
+    0x86, 0x10,  # STX $10
+    0xd0, 0xfb,  # BNE loop
+    0x02,        # Halt
+])
+
+# Loops forever
+LOOP_PROGRAM = bytes([
+    0x4c, 0x00, 0x06,  # JMP $0600
+])
+
+
+class TestCPU(unittest.TestCase):
+    def test_run(self):
+        cpu = microlator.CPU()
+        cpu.load_program(COUNT_PROGRAM)
+        self.assertEqual(cpu.pc, 0x600)
+        self.assertTrue(cpu.run(100))
+        self.assertFalse(cpu.run(100_000))
+        self.assertEqual(cpu.pc, 0x608)
+        self.assertEqual(cpu.index_x, 0)
+
+        cpu.index_x = 0x42
+        self.assertEqual(cpu.index_x, 0x42)
+        with self.assertRaises(OverflowError):
+            cpu.accumulator = 0x100
+        with self.assertRaises(ValueError):
+            cpu.load_program(COUNT_PROGRAM, 0xfffc)
+
+    def test_memory_is_aliased(self):
+        cpu = microlator.CPU()
+        memory = cpu.memory
+        self.assertEqual(len(memory), 65536)
+        self.assertFalse(memory.readonly)
+
+        memory[0x600:0x600 + len(COUNT_PROGRAM)] = COUNT_PROGRAM
+        memory[0x10] = 0x55
+        self.assertFalse(cpu.run(100_000))
+        self.assertEqual(memory[0x10], 0)
+
+        # Views keep the CPU alive
+        del cpu
+        memory[0] = 1
+        self.assertEqual(memory[0], 1)
+
+    def test_snapshots(self):
+        cpu = microlator.CPU()
+        cpu.load_program(COUNT_PROGRAM)
+        cpu.run(200)
+        snapshot = cpu.save()
+        self.assertEqual(len(snapshot), microlator.SNAPSHOT_SIZE)
+
+        copy = microlator.CPU()
+        copy.restore(snapshot)
+        cpu.run(1000)
+        copy.run(1000)
+        self.assertEqual(copy.cycle, cpu.cycle)
+        self.assertEqual(copy.index_x, cpu.index_x)
+        self.assertEqual(bytes(copy.memory), bytes(cpu.memory))
+
+        with self.assertRaises(ValueError):
+            copy.restore(b"\0" * microlator.SNAPSHOT_SIZE)
+
+    def test_run_many(self):
+        cpus = [microlator.CPU() for _ in range(4)]
+        for cpu in cpus:
+            cpu.load_program(COUNT_PROGRAM)
+        cpus[0].load_program(LOOP_PROGRAM)
+
+        self.assertEqual(microlator.run_many(cpus, 10_000),
+                         [True, False, False, False])
+        with self.assertRaises(TypeError):
+            microlator.run_many([cpus[0], 1], 10)
+        with self.assertRaises(ValueError):
+            microlator.run_many([cpus[0], cpus[1], cpus[0]], 10)
+
+    def test_threads(self):
+        cpus = [microlator.CPU() for _ in range(4)]
+        for cpu in cpus:
+            cpu.load_program(LOOP_PROGRAM)
+
+        threads = [threading.Thread(target=cpu.run, args=(1_000_000,))
+                   for cpu in cpus]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        for cpu in cpus:
+            self.assertGreaterEqual(cpu.cycle, 1_000_000)
+
+    def test_running_cpu_is_busy(self):
+        cpu = microlator.CPU()
+        cpu.load_program(LOOP_PROGRAM)
+        other = microlator.CPU()
+
+        # Holding on to the GIL, so the thread starts running and then can't
+        # finish until the thread is joined
+        interval = sys.getswitchinterval()
+        sys.setswitchinterval(1000)
+        try:
+            thread = threading.Thread(target=cpu.run, args=(1_000_000,))
+            thread.start()
+            with self.assertRaises(RuntimeError):
+                cpu.pc
+            with self.assertRaises(RuntimeError):
+                cpu.run(10)
+            with self.assertRaises(RuntimeError):
+                cpu.reset()
+            with self.assertRaises(RuntimeError):
+                cpu.restore(other.save())
+            with self.assertRaises(RuntimeError):
+                microlator.run_many([other, cpu], 10)
+            thread.join()
+        finally:
+            sys.setswitchinterval(interval)
+
+        self.assertGreaterEqual(cpu.cycle, 1_000_000)
+        self.assertTrue(cpu.run(cpu.cycle + 10))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,78 @@
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "scheduler.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+// Takes IRQs into a handler which counts them then spins
+constexpr auto irqProgram = std::to_array<uint8_t>({
+    0x58,             // CLI
+    0x4c, 0x01, 0x06, // loop: JMP loop
+    0xe6, 0x10,       // irq: INC $10
+    0x4c, 0x06, 0x06, // spin: JMP spin
+});
+
+} // namespace
+
+TEST_CASE("Scheduler dispatches events in order", "[scheduler]") {
+	auto cpu = emu::CPU{};
+	// An infinite loop of JMP $0000
+	cpu.memory[0x00] = 0x4c;
+	cpu.pc = 0x00;
+
+	auto scheduler = emu::Scheduler{};
+	auto order = std::vector<int>{};
+	auto cycles = std::vector<uint64_t>{};
+	const auto event = [&](int i) {
+		return [&, i] {
+			order.push_back(i);
+			cycles.push_back(cpu.cycle);
+		};
+	};
+
+	scheduler.schedule(50, event(0));
+	scheduler.schedule(10, event(1));
+	const auto cancelled = scheduler.schedule(20, event(2));
+	scheduler.schedule(10, event(3));
+
+	REQUIRE(scheduler.cancel(cancelled));
+	REQUIRE_FALSE(scheduler.cancel(cancelled));
+	REQUIRE(scheduler.nextEvent() == 10);
+
+	REQUIRE(scheduler.run(cpu, 100));
+	REQUIRE(order == std::vector{1, 3, 0});
+	// Events are dispatched at the first instruction boundary after their
+	// cycle
+	REQUIRE(cycles == std::vector<uint64_t>{12, 12, 51});
+	REQUIRE(scheduler.nextEvent() == emu::Scheduler::never);
+}
+
+TEST_CASE("Scheduler delivers IRQs", "[scheduler]") {
+	auto cpu = emu::CPU{};
+	cpu.loadProgram(irqProgram);
+	cpu.memory[0xfffe] = 0x04;
+	cpu.memory[0xffff] = 0x06;
+
+	auto scheduler = emu::Scheduler{};
+	scheduler.schedule(100, [&] { scheduler.setIrq(3, true); });
+
+	REQUIRE(scheduler.run(cpu, 99));
+	REQUIRE(cpu.memory[0x10] == 0);
+
+	REQUIRE(scheduler.run(cpu, 200));
+	REQUIRE(scheduler.irqAsserted());
+	// The handler runs with interrupts disabled, so is not re-entered
+	REQUIRE(cpu.memory[0x10] == 1);
+	REQUIRE(cpu.flags.test(emu::Flags::Index::InterruptOff));
+	REQUIRE(cpu.stack == 0xfa);
+
+	scheduler.setIrq(3, false);
+	REQUIRE_FALSE(scheduler.irqAsserted());
+	REQUIRE_THROWS_AS(scheduler.setIrq(emu::Scheduler::irqSources, true),
+			  std::out_of_range);
+}
@@ -0,0 +1,76 @@
+#include <catch2/catch.hpp>
+
+#include "cpu.hpp"
+#include "nestest.hpp"
+#include "taint.hpp"
+
+TEST_CASE("Taint propagates through arithmetic", "[taint]") {
+	constexpr auto program = std::to_array<uint8_t>({
+	    0xa5, 0x10, // LDA $10
+	    0x18,       // CLC
+	    0x65, 0x11, // ADC $11
+	    0x85, 0x12, // STA $12
+	    0xaa,       // TAX
+	    0xa0, 0x00, // LDY #$00
+	    0x84, 0x11, // STY $11
+	});
+
+	auto cpu = emu::CPU();
+	auto taint = emu::TaintState();
+	cpu.loadProgram(program);
+	taint.memory.at(0x10) = 0b01;
+	taint.memory.at(0x11) = 0b10;
+
+	for (auto i = 0; i < 7; i++)
+		cpu.step(taint);
+
+	REQUIRE(taint.memory.at(0x12) == 0b11);
+	REQUIRE(taint.indexX == 0b11);
+	REQUIRE(taint.indexY == 0);
+	REQUIRE(taint.memory.at(0x11) == 0);
+	REQUIRE(taint.flag(emu::Flags::Index::Zero) == 0);
+}
+
+TEST_CASE("Taint of the carry survives loads", "[taint]") {
+	constexpr auto program = std::to_array<uint8_t>({
+	    0xa5, 0x10, // LDA $10
+	    0x18,       // CLC
+	    0x69, 0x01, // ADC #$01
+	    0xa9, 0x00, // LDA #$00
+	    0x69, 0x00, // ADC #$00
+	    0x85, 0x11, // STA $11
+	});
+
+	auto cpu = emu::CPU();
+	auto taint = emu::TaintState();
+	cpu.loadProgram(program);
+	cpu.memory.at(0x10) = 0xff;
+	taint.memory.at(0x10) = 0b100;
+
+	for (auto i = 0; i < 6; i++)
+		cpu.step(taint);
+
+	REQUIRE(cpu.memory.at(0x11) == 1);
+	REQUIRE(taint.memory.at(0x11) == 0b100);
+}
+
+TEST_CASE("Taint tracking does not change execution", "[taint]") {
+	auto plain = emu::CPU();
+	plain.loadProgram(nestestProgram, 0x8000);
+	plain.loadProgram(nestestProgram, 0xC000);
+	auto tainted = plain;
+	auto taint = emu::TaintState();
+	taint.memory.fill(1);
+
+	for (size_t i = 1; i < nestestStates.size(); i++)
+		REQUIRE(plain.step() == tainted.step(taint));
+
+	REQUIRE(plain.pc == tainted.pc);
+	REQUIRE(plain.accumulator == tainted.accumulator);
+	REQUIRE(plain.indexX == tainted.indexX);
+	REQUIRE(plain.indexY == tainted.indexY);
+	REQUIRE(plain.stack == tainted.stack);
+	REQUIRE(plain.flags == tainted.flags);
+	REQUIRE(plain.cycle == tainted.cycle);
+	REQUIRE(plain.memory == tainted.memory);
+}
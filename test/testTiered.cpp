@@ -0,0 +1,215 @@
+#include <cstdint>
+#include <optional>
+
+#include <catch2/catch.hpp>
+
+#include "tiered.hpp"
+
+namespace emu = microlator;
+
+namespace {
+
+// Sums X into $10 in an inner loop whose transfer and increment set flags
+// which are overwritten before being read
+constexpr auto sumProgram = std::to_array<uint8_t>({
+    0xa9, 0x00,       // LDA #0
+    0x85, 0x10,       // STA $10
+    0xa2, 0x00,       // outer: LDX #0
+    0x8a,             // loop: TXA
+    0x18,             // CLC
+    0x65, 0x10,       // ADC $10
+    0x85, 0x10,       // STA $10
+    0xc8,             // INY
+    0xca,             // DEX
+    0xd0, 0xf6,       // BNE loop
+    0xe6, 0x11,       // INC $11
+    0x4c, 0x04, 0x06, // JMP outer
+});
+
+// Increments the operand of its own LDA each iteration
+constexpr auto selfModifyingProgram = std::to_array<uint8_t>({
+    0xa2, 0x00,       // LDX #0
+    0xa9, 0x00,       // loop: LDA #0
+    0x18,             // CLC
+    0x69, 0x01,       // ADC #1
+    0x8d, 0x03, 0x06, // STA $0603
+    0xca,             // DEX
+    0xd0, 0xf5,       // BNE loop
+    0xe6, 0x10,       // INC $10
+    0x4c, 0x02, 0x06, // JMP loop
+});
+
+// Indexes memory with constant X, both within and across pages
+constexpr auto indexedProgram = std::to_array<uint8_t>({
+    0xa2, 0x03,       // loop: LDX #3
+    0xb5, 0x10,       // LDA $10,X
+    0x69, 0x01,       // ADC #1
+    0x95, 0x10,       // STA $10,X
+    0xa2, 0xff,       // LDX #$FF
+    0xbd, 0x01, 0x02, // LDA $0201,X
+    0xe8,             // INX
+    0xfe, 0x00, 0x03, // INC $0300,X
+    0x4c, 0x00, 0x06, // JMP loop
+});
+
+// Adds to $10 in a subroutine
+constexpr auto subroutineProgram = std::to_array<uint8_t>({
+    0xa2, 0x00,       // LDX #0
+    0x20, 0x0b, 0x06, // loop: JSR add
+    0xca,             // DEX
+    0xd0, 0xfa,       // BNE loop
+    0x4c, 0x00, 0x06, // JMP $0600
+    0x18,             // add: CLC
+    0x65, 0x10,       // ADC $10
+    0x85, 0x10,       // STA $10
+    0x60,             // RTS
+});
+
+void requireSameState(const emu::CPU &actual, const emu::CPU &expected) {
+	REQUIRE(actual.cycle == expected.cycle);
+	REQUIRE(actual.pc == expected.pc);
+	REQUIRE(actual.accumulator == expected.accumulator);
+	REQUIRE(actual.indexX == expected.indexX);
+	REQUIRE(actual.indexY == expected.indexY);
+	REQUIRE(actual.stack == expected.stack);
+	REQUIRE(actual.flags == expected.flags);
+	REQUIRE(actual.memory == expected.memory);
+}
+
+// Run a program both on its own and with a TieredEngine, stopping every
+// interval cycles to compare them
+auto compare(std::span<const uint8_t> program, uint64_t interval,
+	     uint64_t cycles) -> emu::TieredEngine::Statistics {
+	auto expected = emu::CPU{};
+	auto actual = emu::CPU{};
+	expected.loadProgram(program);
+	actual.loadProgram(program);
+
+	auto engine = emu::TieredEngine{actual, 8, 32};
+	for (auto cycle = interval; cycle < cycles; cycle += interval) {
+		REQUIRE(expected.run(cycle));
+		REQUIRE(engine.run(cycle));
+		requireSameState(actual, expected);
+	}
+
+	return engine.statistics();
+}
+
+} // namespace
+
+TEST_CASE("TieredEngine promotes hot blocks", "[tiered]") {
+	auto cpu = emu::CPU{};
+	cpu.loadProgram(sumProgram);
+	auto engine = emu::TieredEngine{cpu, 8, 32};
+
+	REQUIRE(engine.run(100));
+	REQUIRE(engine.tier(0x606) == emu::TieredEngine::Tier::Interpreter);
+	REQUIRE(engine.run(400));
+	REQUIRE(engine.tier(0x606) == emu::TieredEngine::Tier::Block);
+	REQUIRE(engine.run(100'000));
+	REQUIRE(engine.tier(0x606) == emu::TieredEngine::Tier::Optimized);
+
+	const auto &stats = engine.statistics();
+	REQUIRE(stats.optimized > stats.interpreted * 100);
+	REQUIRE(stats.blocksInvalidated == 0);
+
+	// Host edits take effect once the engine is flushed
+	cpu.memory[0x60c] = 0xea; // NOP in place of INY
+	engine.flush();
+	REQUIRE(engine.tier(0x606) == emu::TieredEngine::Tier::Interpreter);
+	const auto indexY = cpu.indexY;
+	REQUIRE(engine.run(200'000));
+	REQUIRE(cpu.indexY == indexY);
+}
+
+TEST_CASE("TieredEngine matches the interpreter", "[tiered]") {
+	for (const auto interval : {1, 3, 37, 1000}) {
+		const auto stats = compare(sumProgram, interval, 60'000);
+		REQUIRE(stats.predecoded + stats.optimized > 0);
+	}
+}
+
+TEST_CASE("TieredEngine folds constant indexes", "[tiered]") {
+	for (const auto interval : {1, 7, 1000}) {
+		const auto stats = compare(indexedProgram, interval, 30'000);
+		REQUIRE(stats.blocksOptimized == 1);
+	}
+}
+
+TEST_CASE("TieredEngine chains blocks", "[tiered]") {
+	for (const auto interval : {1, 13, 1000}) {
+		const auto stats = compare(subroutineProgram, interval, 30'000);
+		REQUIRE(stats.chained > 0);
+	}
+
+	auto cpu = emu::CPU{};
+	cpu.loadProgram(subroutineProgram);
+	auto engine = emu::TieredEngine{cpu};
+	REQUIRE(engine.run(100'000));
+
+	// Once every block has been linked, only the block after the one the
+	// last run stopped in is looked up
+	const auto before = engine.statistics();
+	REQUIRE(engine.run(200'000));
+	const auto &after = engine.statistics();
+	REQUIRE(after.lookups - before.lookups == 1);
+	REQUIRE(after.chained - before.chained > 10'000);
+	REQUIRE(after.interpreted - before.interpreted <= 1);
+}
+
+TEST_CASE("TieredEngine discards modified blocks", "[tiered]") {
+	for (const auto interval : {1, 29, 1000}) {
+		const auto stats =
+		    compare(selfModifyingProgram, interval, 60'000);
+		REQUIRE(stats.blocksInvalidated >=
+			emu::TieredEngine::maxInvalidations);
+	}
+
+	auto cpu = emu::CPU{};
+	cpu.loadProgram(selfModifyingProgram);
+	auto engine = emu::TieredEngine{cpu};
+	REQUIRE(engine.run(100'000));
+	// The loop keeps being modified, so is left to the interpreter
+	REQUIRE(engine.tier(0x602) == emu::TieredEngine::Tier::Interpreter);
+	REQUIRE(engine.statistics().blocksInvalidated ==
+		emu::TieredEngine::maxInvalidations);
+}
+
+TEST_CASE("TieredEngine runs a number of instructions", "[tiered]") {
+	auto expected = emu::CPU{};
+	auto actual = emu::CPU{};
+	expected.loadProgram(sumProgram);
+	actual.loadProgram(sumProgram);
+
+	auto engine = emu::TieredEngine{actual, 8, 32};
+	for (const auto instructions : {1, 5, 37, 1000, 1, 20'000}) {
+		for (auto i = 0; i < instructions; i++)
+			REQUIRE(expected.step());
+
+		REQUIRE(engine.run(UINT64_MAX, instructions));
+		requireSameState(actual, expected);
+	}
+
+	REQUIRE(engine.statistics().optimized > 0);
+}
+
+TEST_CASE("TieredEngine only watches its own CPU", "[tiered]") {
+	auto cpu = emu::CPU{};
+	cpu.loadProgram(selfModifyingProgram);
+	std::optional<emu::CPU> copy;
+	using Tier = emu::TieredEngine::Tier;
+	{
+		auto engine = emu::TieredEngine{cpu, 1, 1};
+		REQUIRE(engine.run(50));
+		REQUIRE(engine.tier(0x602) != Tier::Interpreter);
+
+		// Writes by a copy don't discard the engine's blocks
+		copy = cpu;
+		REQUIRE(copy->run(copy->cycle + 1000));
+		REQUIRE(engine.tier(0x602) != Tier::Interpreter);
+	}
+
+	// Nor do they reach the engine once it has been destroyed
+	REQUIRE(copy->run(copy->cycle + 1000));
+	REQUIRE(cpu.run(cpu.cycle + 1000));
+}
@@ -0,0 +1,90 @@
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "cpu.hpp"
+#include "nestest.hpp"
+#include "trace.hpp"
+
+namespace {
+
+auto nestestCPU() -> emu::CPU {
+	auto cpu = emu::CPU();
+	cpu.loadProgram(nestestProgram, 0x8000);
+	cpu.loadProgram(nestestProgram, 0xC000);
+	cpu.cycle = nestestStates[0].cycle;
+	return cpu;
+}
+
+// Nestest moves on to undocumented instructions after this many states
+constexpr auto documentedStates = size_t{5004};
+
+auto nestestTrace(size_t size = documentedStates)
+    -> std::vector<emu::TraceState> {
+	std::vector<emu::TraceState> trace;
+	for (size_t i = 0; i < size; i++) {
+		const auto &state = nestestStates.at(i);
+		trace.emplace_back(state.pc, state.a, state.x, state.y, state.p,
+				   state.sp, state.cycle);
+	}
+
+	return trace;
+}
+
+} // namespace
+
+TEST_CASE("Trace validation accepts nestest", "[trace]") {
+	const auto trace = nestestTrace();
+	const auto checkpoints = emu::takeCheckpoints(nestestCPU(),
+						      trace.size() - 1, 500);
+
+	REQUIRE(checkpoints.states.size() == trace.size() / 500 + 1);
+	REQUIRE_FALSE(emu::validateTrace(checkpoints, trace, 4));
+	REQUIRE_FALSE(emu::validateTrace(nestestCPU(), trace));
+}
+
+TEST_CASE("Trace validation reports the earliest divergence", "[trace]") {
+	auto trace = nestestTrace();
+	trace.at(4000).accumulator ^= 1U;
+	trace.at(2345).cycle++;
+	trace.at(2346).cycle++;
+
+	const auto checkpoints = emu::takeCheckpoints(nestestCPU(),
+						      trace.size() - 1, 500);
+	const auto divergence = emu::validateTrace(checkpoints, trace, 4);
+
+	REQUIRE(divergence);
+	REQUIRE(divergence->index == 2345);
+	REQUIRE_FALSE(divergence->halted);
+	REQUIRE(divergence->expected == trace.at(2345));
+	REQUIRE(divergence->actual.cycle + 1 == trace.at(2345).cycle);
+}
+
+TEST_CASE("Trace validation reports a CPU halting early", "[trace]") {
+	const auto trace = nestestTrace(nestestStates.size());
+	const auto divergence = emu::validateTrace(nestestCPU(), trace, 3);
+
+	REQUIRE(divergence);
+	REQUIRE(divergence->index == documentedStates);
+	REQUIRE(divergence->halted);
+}
+
+TEST_CASE("Trace validation rejects checkpoints not covering the trace",
+	  "[trace]") {
+	const auto trace = nestestTrace();
+	auto checkpoints =
+	    emu::takeCheckpoints(nestestCPU(), trace.size() - 1, 500);
+	checkpoints.states.pop_back();
+	REQUIRE_THROWS_AS(emu::validateTrace(checkpoints, trace, 2),
+			  std::invalid_argument);
+
+	checkpoints =
+	    emu::takeCheckpoints(nestestCPU(), trace.size() / 2, 500);
+	REQUIRE_THROWS_AS(emu::validateTrace(checkpoints, trace, 2),
+			  std::invalid_argument);
+
+	checkpoints.interval = 0;
+	REQUIRE_THROWS_AS(emu::validateTrace(checkpoints, trace, 2),
+			  std::invalid_argument);
+}
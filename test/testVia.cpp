@@ -0,0 +1,100 @@
+#include <catch2/catch.hpp>
+
+#include "via.hpp"
+
+namespace emu = microlator;
+using V = emu::Via;
+
+namespace {
+
+// Counts timer 1 interrupts in free running mode, with the VIA at $8000
+constexpr auto irqProgram = std::to_array<uint8_t>({
+    0xa9, 0xc0,       // LDA #$C0
+    0x8d, 0x0e, 0x80, // STA IER
+    0xa9, 0x40,       // LDA #$40
+    0x8d, 0x0b, 0x80, // STA ACR
+    0xa9, 0x64,       // LDA #100
+    0x8d, 0x04, 0x80, // STA T1CL
+    0xa9, 0x00,       // LDA #0
+    0x8d, 0x05, 0x80, // STA T1CH
+    0x58,             // CLI
+    0x4c, 0x15, 0x06, // loop: JMP loop
+    0xe6, 0x10,       // irq: INC $10
+    0xad, 0x04, 0x80, // LDA T1CL
+    0x40,             // RTI
+});
+
+} // namespace
+
+TEST_CASE("VIA timers derive their value from cycles", "[via]") {
+	auto cpu = emu::CPU{};
+	auto scheduler = emu::Scheduler{};
+	auto via = emu::Via{scheduler, 0};
+
+	cpu.cycle = 1000;
+	via.write(cpu, V::T1CL, 0x34);
+	via.write(cpu, V::T1CH, 0x12);
+	via.write(cpu, V::T2CL, 0x10);
+	via.write(cpu, V::T2CH, 0x00);
+	REQUIRE(scheduler.nextEvent() == 1000 + 0x10 + 1);
+
+	cpu.cycle = 1010;
+	REQUIRE(via.read(cpu, V::T1CH) == 0x12);
+	REQUIRE(via.read(cpu, V::T1CL) == 0x2a);
+	REQUIRE(via.read(cpu, V::T2CL) == 0x06);
+
+	cpu.cycle = 1000 + 0x1234;
+	REQUIRE(via.read(cpu, V::T1CH) == 0x00);
+	REQUIRE(via.read(cpu, V::IFR) == V::Timer2);
+
+	// Once underflowed, a one shot timer keeps counting without raising
+	// another interrupt
+	cpu.cycle++;
+	REQUIRE(via.read(cpu, V::T1CH) == 0xff);
+	REQUIRE(via.read(cpu, V::IFR) == (V::Timer1 | V::Timer2));
+	REQUIRE(via.read(cpu, V::T1CL) == 0xff);
+	cpu.cycle += 0x10000;
+	REQUIRE(via.read(cpu, V::IFR) == V::Timer2);
+}
+
+TEST_CASE("VIA timer 1 reloads in free running mode", "[via]") {
+	auto cpu = emu::CPU{};
+	auto scheduler = emu::Scheduler{};
+	auto via = emu::Via{scheduler, 0};
+
+	via.write(cpu, V::ACR, 0x40);
+	via.write(cpu, V::T1CL, 10);
+	via.write(cpu, V::T1CH, 0);
+
+	const auto expected = std::to_array<uint8_t>({0, 0xff, 10, 9});
+	for (auto period = 0U; period < 3; period++) {
+		for (auto i = 0U; i < expected.size(); i++) {
+			cpu.cycle = 10 + period * 12 + i;
+			REQUIRE(via.read(cpu, V::T1CL) == expected[i]);
+		}
+	}
+
+	// Reading the low counter acknowledged each interrupt
+	REQUIRE(via.read(cpu, V::IFR) == 0);
+	cpu.cycle = 10 + 3 * 12 + 1;
+	REQUIRE(via.read(cpu, V::IFR) == V::Timer1);
+}
+
+TEST_CASE("VIA raises IRQs through the scheduler", "[via]") {
+	auto cpu = emu::CPU{};
+	auto scheduler = emu::Scheduler{};
+	auto via = emu::Via{scheduler, 2};
+
+	cpu.loadProgram(irqProgram);
+	cpu.memory[0xfffe] = 0x18;
+	cpu.memory[0xffff] = 0x06;
+	cpu.map(via, 0x80, 0x80);
+
+	REQUIRE(scheduler.run(cpu, 10'000));
+	// Timer 1 was started at cycle 24, and underflows every 102 cycles
+	REQUIRE(cpu.memory[0x10] == (10'000 - 24) / 102);
+	REQUIRE(via.read(cpu, V::IER) == 0xc0);
+
+	via.write(cpu, V::IER, V::Timer1);
+	REQUIRE_FALSE(scheduler.irqAsserted());
+}
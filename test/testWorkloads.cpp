@@ -0,0 +1,89 @@
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+
+#include "tiered.hpp"
+#include "workloads.hpp"
+
+namespace {
+
+auto read16(const emu::CPU &cpu, uint16_t address) -> uint16_t {
+	return static_cast<uint16_t>(cpu.memory.at(address) |
+				     cpu.memory.at(address + 1U) << 8U);
+}
+
+auto read32(const emu::CPU &cpu, uint16_t address) -> uint32_t {
+	return read16(cpu, address) |
+	       static_cast<uint32_t>(read16(cpu, address + 2U)) << 16U;
+}
+
+auto find(std::string_view name) -> const Workload & {
+	for (const auto &workload : workloads) {
+		if (workload.name == name)
+			return workload;
+	}
+
+	throw std::invalid_argument{"Unknown workload"};
+}
+
+} // namespace
+
+TEST_CASE("Workloads stop with the expected state", "[workloads]") {
+	for (const auto &workload : workloads) {
+		INFO(workload.name);
+		const auto cpu = runWorkload(workload);
+		REQUIRE(cpu.cycle == workload.cycles);
+		REQUIRE(checksum(cpu) == workload.checksum);
+	}
+}
+
+TEST_CASE("Workloads compute the right results", "[workloads]") {
+	// 1028 primes are below 8192
+	REQUIRE(read16(runWorkload(find("sieve")), 0x04) == 1028);
+
+	// Matches zlib's crc32()
+	REQUIRE(read32(runWorkload(find("crc32")), 0x00) == 0xa8337679);
+
+	auto products = uint32_t{0};
+	auto quotients = uint16_t{0};
+	auto remainders = uint16_t{0};
+	for (auto i = 0U; i < 256; i++) {
+		const auto x = (~i & 0xffU) << 8U | i;
+		const auto y = 0x100U + ((i + 0x35U) & 0xffU);
+		products += x * y;
+		quotients = static_cast<uint16_t>(quotients + x / y);
+		remainders = static_cast<uint16_t>(remainders + x % y);
+	}
+	const auto multiplied = runWorkload(find("multiplyDivide"));
+	REQUIRE(read32(multiplied, 0x10) == products);
+	REQUIRE(read16(multiplied, 0x14) == quotients);
+	REQUIRE(read16(multiplied, 0x16) == remainders);
+
+	const auto sorted = runWorkload(find("sort"));
+	for (auto i = 0U; i < 256; i++)
+		REQUIRE(sorted.memory.at(0x300 + i) == i);
+
+	const auto copied = runWorkload(find("memcpy"));
+	for (auto address = 0x2000U; address < 0xa000; address++) {
+		const auto page = 0x20U + ((address >> 8U) & 0xfU);
+		const auto expected = (address & 0xffU) ^ page;
+		REQUIRE(copied.memory.at(address) == expected);
+	}
+
+	REQUIRE(read32(runWorkload(find("bcd")), 0x00) == 0x00020000);
+
+	// 5050 ten times, in a byte
+	REQUIRE(runWorkload(find("bytecode")).memory.at(0) == 50500 % 256);
+}
+
+TEST_CASE("TieredEngine runs workloads like the interpreter", "[workloads]") {
+	for (const auto &workload : workloads) {
+		INFO(workload.name);
+		auto cpu = emu::CPU{};
+		cpu.loadProgram(workload.program);
+		auto engine = emu::TieredEngine{cpu};
+		REQUIRE_FALSE(engine.run(workload.cycles + 1));
+		REQUIRE(cpu.cycle == workload.cycles);
+		REQUIRE(checksum(cpu) == workload.checksum);
+	}
+}
@@ -0,0 +1,533 @@
+#pragma once
+
+// Guest programs representative of the code we run, for benchmarks. Each
+// stops at the unimplemented opcode $02
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "assembler.hpp"
+#include "cpu.hpp"
+
+namespace emu = microlator;
+
+// Sieve of Eratosthenes over 0 to 8191, counting the primes into $04
+constexpr auto sieveProgram = emu::assemble<R"(
+	ptr = $00
+	n = $02
+	count = $04
+	flags = $2000
+	LDA #2
+	STA n
+	LDA #0
+	STA n+1
+	STA count
+	STA count+1
+	LDY #0
+outer:	CLC
+	LDA n
+	ADC #<flags
+	STA ptr
+	LDA n+1
+	ADC #>flags
+	STA ptr+1
+	CMP #$40
+	BCS done
+	LDA (ptr),Y
+	BNE next
+	INC count
+	BNE mark
+	INC count+1
+mark:	CLC             ; Mark each multiple of n as composite
+	LDA ptr
+	ADC n
+	STA ptr
+	LDA ptr+1
+	ADC n+1
+	STA ptr+1
+	CMP #$40
+	BCS next
+	LDA #1
+	STA (ptr),Y
+	JMP mark
+next:	INC n
+	BNE outer
+	INC n+1
+	JMP outer
+done:	.byte $02
+)">();
+
+// CRC-32 of 4KiB at $8000, where each byte is its address's low byte xor
+// high byte, into $00
+constexpr auto crc32Program = emu::assemble<R"(
+	crc = $00
+	ptr = $04
+	data = $8000
+	end = $9000
+	LDA #<data
+	STA ptr
+	LDA #>data
+	STA ptr+1
+	LDY #0
+	LDX #$10
+fill:	TYA
+	EOR ptr+1
+	STA (ptr),Y
+	INY
+	BNE fill
+	INC ptr+1
+	DEX
+	BNE fill
+	LDA #>data
+	STA ptr+1
+	LDA #$ff
+	STA crc
+	STA crc+1
+	STA crc+2
+	STA crc+3
+byte:	LDA (ptr),Y
+	EOR crc
+	STA crc
+	LDX #8
+bit:	LSR crc+3
+	ROR crc+2
+	ROR crc+1
+	ROR crc
+	BCC next
+	LDA crc+3       ; Reflected polynomial $EDB88320
+	EOR #$ed
+	STA crc+3
+	LDA crc+2
+	EOR #$b8
+	STA crc+2
+	LDA crc+1
+	EOR #$83
+	STA crc+1
+	LDA crc
+	EOR #$20
+	STA crc
+next:	DEX
+	BNE bit
+	INY
+	BNE byte
+	INC ptr+1
+	LDA ptr+1
+	CMP #>end
+	BNE byte
+	LDX #3
+invert:	LDA crc,X
+	EOR #$ff
+	STA crc,X
+	DEX
+	BPL invert
+	.byte $02
+)">();
+
+// For i from 0 to 255, multiplies x = (~i << 8) | i by y = $100 + (i + $35
+// & $FF) and divides x by y. Sums the products into $10, and the quotients
+// and remainders into $14 and $16
+constexpr auto multiplyDivideProgram = emu::assemble<R"(
+	x = $00
+	y = $02
+	product = $04
+	quotient = $08
+	remainder = $0a
+	i = $0c
+	products = $10
+	quotients = $14
+	remainders = $16
+	LDA #0
+	STA i
+	LDX #7
+clear:	STA products,X
+	DEX
+	BPL clear
+loop:	JSR operands
+	JSR multiply
+	CLC
+	LDX #0
+	LDY #4
+sum:	LDA products,X
+	ADC product,X
+	STA products,X
+	INX
+	DEY
+	BNE sum
+	JSR operands
+	JSR divide
+	CLC
+	LDA quotients
+	ADC quotient
+	STA quotients
+	LDA quotients+1
+	ADC quotient+1
+	STA quotients+1
+	CLC
+	LDA remainders
+	ADC remainder
+	STA remainders
+	LDA remainders+1
+	ADC remainder+1
+	STA remainders+1
+	INC i
+	BNE loop
+	.byte $02
+
+operands:
+	LDA i
+	STA x
+	EOR #$ff
+	STA x+1
+	LDA i
+	CLC
+	ADC #$35
+	STA y
+	LDA #1
+	STA y+1
+	RTS
+
+; product = x * y, shifting y out
+multiply:
+	LDA #0
+	STA product+2
+	STA product+3
+	LDX #16
+mshift:	LSR y+1
+	ROR y
+	BCC mrotate
+	LDA product+2
+	CLC
+	ADC x
+	STA product+2
+	LDA product+3
+	ADC x+1
+mrotate:
+	ROR
+	STA product+3
+	ROR product+2
+	ROR product+1
+	ROR product
+	DEX
+	BNE mshift
+	RTS
+
+; quotient, remainder = x / y, x % y, shifting the dividend out of quotient
+; as the quotient is shifted in
+divide:
+	LDA x
+	STA quotient
+	LDA x+1
+	STA quotient+1
+	LDA #0
+	STA remainder
+	STA remainder+1
+	LDX #16
+dshift:	ASL quotient
+	ROL quotient+1
+	ROL remainder
+	ROL remainder+1
+	LDA remainder
+	SEC
+	SBC y
+	TAY
+	LDA remainder+1
+	SBC y+1
+	BCC dnext
+	STA remainder+1
+	STY remainder
+	INC quotient
+dnext:	DEX
+	BNE dshift
+	RTS
+)">();
+
+// Bubble sorts the 256 bytes at $0300, filled with x = 5x + 1 which visits
+// every value once
+constexpr auto sortProgram = emu::assemble<R"(
+	data = $0300
+	value = $00
+	LDA #0
+	LDX #0
+fill:	STA data,X
+	STA value
+	ASL
+	ASL
+	CLC
+	ADC value
+	CLC
+	ADC #1
+	INX
+	BNE fill
+pass:	LDY #0
+	LDX #0
+compare:
+	LDA data+1,X
+	CMP data,X
+	BCS ordered
+	PHA
+	LDA data,X
+	STA data+1,X
+	PLA
+	STA data,X
+	LDY #1
+ordered:
+	INX
+	CPX #$ff
+	BNE compare
+	DEY
+	BEQ pass
+	.byte $02
+)">();
+
+// Fills 4KiB at $2000, then copies it along to each following 4KiB up to
+// $A000
+constexpr auto memcpyProgram = emu::assemble<R"(
+	source = $00
+	destination = $02
+	LDA #0
+	STA source
+	STA destination
+	LDA #$20
+	STA source+1
+	LDY #0
+	LDX #$10
+fill:	TYA
+	EOR source+1
+	STA (source),Y
+	INY
+	BNE fill
+	INC source+1
+	DEX
+	BNE fill
+	LDA #$20
+	STA source+1
+copy:	LDA source+1
+	CLC
+	ADC #$10
+	STA destination+1
+	CMP #$a0
+	BEQ done
+	LDX #$10
+page:	LDA (source),Y
+	STA (destination),Y
+	INY
+	BNE page
+	INC source+1
+	INC destination+1
+	DEX
+	BNE page
+	JMP copy
+done:	.byte $02
+)">();
+
+// Counts to 20000 in 8 digit packed BCD at $00, without decimal mode
+constexpr auto bcdProgram = emu::assemble<R"(
+	counter = $00
+	n = $04
+	LDA #0
+	STA counter
+	STA counter+1
+	STA counter+2
+	STA counter+3
+	LDA #<20000
+	STA n
+	LDA #>20000
+	STA n+1
+loop:	JSR increment
+	LDA n
+	BNE low
+	DEC n+1
+low:	DEC n
+	LDA n
+	ORA n+1
+	BNE loop
+	.byte $02
+
+increment:
+	LDX #0
+digit:	LDA counter,X
+	CLC
+	ADC #1
+	STA counter,X
+	AND #$0f
+	CMP #$0a
+	BNE done
+	LDA counter,X   ; Carry into the high digit
+	CLC
+	ADC #6
+	STA counter,X
+	CMP #$a0
+	BNE done
+	LDA #0          ; Carry into the next byte
+	STA counter,X
+	INX
+	CPX #4
+	BNE digit
+done:	RTS
+)">();
+
+// Interprets byte code for a stack machine, dispatching through a jump
+// table. The byte code sums 100 down to 1 into variable 0, ten times.
+// Variables are at $00, the stack grows down from $7F and ip is at $80
+constexpr auto bytecodeProgram = emu::assemble<R"(
+	ip = $80
+	jump = $82
+	HALT = 0
+	PUSH = 1
+	ADD = 2
+	SUB = 3
+	DUP = 4
+	JNZ = 5
+	STORE = 6
+	LOAD = 7
+	LDA #<code
+	STA ip
+	LDA #>code
+	STA ip+1
+	LDA #10
+	STA 2
+	LDX #$7f
+
+dispatch:
+	LDY #0
+	LDA (ip),Y
+	ASL
+	TAY
+	LDA handlers,Y
+	STA jump
+	LDA handlers+1,Y
+	STA jump+1
+	JMP (jump)
+
+; Operand of the current instruction into A, moving ip past both
+operand:
+	LDY #1
+	LDA (ip),Y
+	PHA
+	LDA ip
+	CLC
+	ADC #2
+	STA ip
+	BCC operandDone
+	INC ip+1
+operandDone:
+	PLA
+	RTS
+
+next:	INC ip
+	BNE nextDone
+	INC ip+1
+nextDone:
+	JMP dispatch
+
+halt:	.byte $02
+
+push:	JSR operand
+	STA 0,X
+	DEX
+	JMP dispatch
+
+add:	INX
+	LDA 0,X
+	INX
+	CLC
+	ADC 0,X
+	STA 0,X
+	DEX
+	JMP next
+
+sub:	INX
+	LDA 0,X
+	STA jump
+	INX
+	LDA 0,X
+	SEC
+	SBC jump
+	STA 0,X
+	DEX
+	JMP next
+
+dup:	LDA 1,X
+	STA 0,X
+	DEX
+	JMP next
+
+jnz:	JSR operand
+	INX
+	LDY 0,X
+	BEQ jnzDone
+	CLC
+	ADC #<code
+	STA ip
+	LDA #>code
+	ADC #0
+	STA ip+1
+jnzDone:
+	JMP dispatch
+
+store:	JSR operand
+	TAY
+	INX
+	LDA 0,X
+	STA 0,Y
+	JMP dispatch
+
+load:	JSR operand
+	TAY
+	LDA 0,Y
+	STA 0,X
+	DEX
+	JMP dispatch
+
+handlers:
+	.word halt, push, add, sub, dup, jnz, store, load
+
+code:	.byte PUSH, 0, STORE, 0
+round:	.byte PUSH, 100, STORE, 1
+sum:	.byte LOAD, 0, LOAD, 1, ADD, STORE, 0
+	.byte LOAD, 1, PUSH, 1, SUB, DUP, STORE, 1, JNZ, sum-code
+	.byte LOAD, 2, PUSH, 1, SUB, DUP, STORE, 2, JNZ, round-code
+	.byte HALT
+)">();
+
+struct Workload {
+	std::string_view name;
+	std::span<const uint8_t> program;
+	// FNV-1a hash of memory, and cycles taken, once it has stopped
+	uint32_t checksum;
+	uint64_t cycles;
+};
+
+constexpr auto workloads = std::to_array<Workload>({
+    {"sieve", sieveProgram, 0x044e8516, 998'513},
+    {"crc32", crc32Program, 0x373dd5a6, 1'562'214},
+    {"multiplyDivide", multiplyDivideProgram, 0xebdbd213, 431'724},
+    {"sort", sortProgram, 0x26b73d81, 1'465'369},
+    {"memcpy", memcpyProgram, 0x849f5bfe, 526'163},
+    {"bcd", bcdProgram, 0x9db24be8, 1'098'918},
+    {"bytecode", bytecodeProgram, 0xb5417cd7, 788'348},
+});
+
+inline auto checksum(const emu::CPU &cpu) -> uint32_t {
+	constexpr auto offsetBasis = 2166136261U;
+	constexpr auto prime = 16777619U;
+
+	auto hash = offsetBasis;
+	for (const auto byte : cpu.memory)
+		hash = (hash ^ byte) * prime;
+
+	return hash;
+}
+
+// Run a workload until it stops, or for at most maxCycles
+inline auto runWorkload(const Workload &workload,
+			uint64_t maxCycles = 100'000'000) -> emu::CPU {
+	auto cpu = emu::CPU{};
+	cpu.loadProgram(workload.program);
+	while (cpu.cycle < maxCycles && cpu.step()) {
+	}
+
+	return cpu;
+}